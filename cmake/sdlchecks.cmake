@@ -1182,3 +1182,27 @@ macro(CheckKMSDRM)
     endif()
   endif()
 endmacro()
+
+# Requires:
+# - n/a
+# Optional:
+# - librt, for shm_open() on older systems
+macro(CheckShmVideo)
+  if(VIDEO_SHM)
+    check_library_exists(c shm_open "" HAVE_SHM_OPEN)
+    if(NOT HAVE_SHM_OPEN)
+      check_library_exists(rt shm_open "" HAVE_SHM_OPEN_RT)
+      if(HAVE_SHM_OPEN_RT)
+        list(APPEND EXTRA_LIBS rt)
+        set(HAVE_SHM_OPEN TRUE)
+      endif()
+    endif()
+    if(HAVE_SHM_OPEN)
+      set(SDL_VIDEO_DRIVER_SHM 1)
+      file(GLOB SHM_SOURCES ${SDL2_SOURCE_DIR}/src/video/shm/*.c)
+      set(SOURCE_FILES ${SOURCE_FILES} ${SHM_SOURCES})
+      set(HAVE_VIDEO_SHM TRUE)
+      set(HAVE_SDL_VIDEO TRUE)
+    endif()
+  endif()
+endmacro()
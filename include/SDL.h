@@ -32,6 +32,7 @@
 #include "SDL_main.h"
 #include "SDL_stdinc.h"
 #include "SDL_assert.h"
+#include "SDL_asyncio.h"
 #include "SDL_atomic.h"
 #include "SDL_audio.h"
 #include "SDL_clipboard.h"
@@ -0,0 +1,220 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/**
+ *  \file SDL_asyncio.h
+ *
+ *  This file provides an interface to read and write files without
+ *  blocking the calling thread.
+ *
+ *  Reads and writes are submitted as tasks, which run in the background
+ *  and report their outcome when they are done, either through an
+ *  SDL_AsyncIOQueue that the application checks or waits on, or as an
+ *  ::SDL_ASYNCIOCOMPLETE event.
+ *
+ *  On Linux the tasks are handed to the kernel with io_uring when it is
+ *  available, elsewhere they run on a pool of worker threads.
+ */
+
+#ifndef SDL_asyncio_h_
+#define SDL_asyncio_h_
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  \brief A file opened for asynchronous I/O.
+ */
+typedef struct SDL_AsyncIO SDL_AsyncIO;
+
+/**
+ *  \brief A queue that collects the outcome of finished tasks.
+ */
+typedef struct SDL_AsyncIOQueue SDL_AsyncIOQueue;
+
+/**
+ *  \brief The kind of task that finished.
+ */
+typedef enum
+{
+    SDL_ASYNCIO_TASK_READ,      /**< A read with SDL_ReadAsyncIO() */
+    SDL_ASYNCIO_TASK_WRITE,     /**< A write with SDL_WriteAsyncIO() */
+    SDL_ASYNCIO_TASK_CLOSE      /**< A close with SDL_CloseAsyncIO() */
+} SDL_AsyncIOTaskType;
+
+/**
+ *  \brief How a task finished.
+ */
+typedef enum
+{
+    SDL_ASYNCIO_COMPLETE,       /**< The task succeeded */
+    SDL_ASYNCIO_FAILURE         /**< The task failed */
+} SDL_AsyncIOResult;
+
+/**
+ *  \brief The outcome of a finished task.
+ */
+typedef struct SDL_AsyncIOOutcome
+{
+    SDL_AsyncIO *asyncio;       /**< The file the task ran on, already freed for a close */
+    SDL_AsyncIOTaskType type;   /**< The kind of task */
+    SDL_AsyncIOResult result;   /**< How the task finished */
+    void *buffer;               /**< The buffer the data was read into or written from */
+    Uint64 offset;              /**< The offset in the file the task started at */
+    Uint64 bytes_requested;     /**< The number of bytes the task was asked to transfer */
+    Uint64 bytes_transferred;   /**< The number of bytes actually transferred */
+    void *userdata;             /**< The pointer passed when the task was submitted */
+} SDL_AsyncIOOutcome;
+
+
+/**
+ *  Open a file for asynchronous I/O.
+ *
+ *  \param file the name of the file, in UTF-8.
+ *  \param mode the same modes as SDL_RWFromFile() takes, the "a" modes
+ *              aren't useful since every task says where it happens.
+ *
+ *  \return the opened file, or NULL on error.
+ */
+extern DECLSPEC SDL_AsyncIO *SDLCALL SDL_AsyncIOFromFile(const char *file,
+                                                        const char *mode);
+
+/**
+ *  Get the size of a file opened for asynchronous I/O.
+ *
+ *  This doesn't account for writes that are still in progress.
+ *
+ *  \return the size of the file, or -1 on error.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_AsyncIOSize(SDL_AsyncIO *asyncio);
+
+/**
+ *  Start reading from a file.
+ *
+ *  \param asyncio the file to read from.
+ *  \param ptr the buffer to read into, which must stay valid until the
+ *             task has finished.
+ *  \param offset the position in the file to start reading at.
+ *  \param size the number of bytes to read.  Fewer bytes are read if the
+ *              end of the file is reached, which still counts as success.
+ *  \param queue the queue the outcome is added to, or NULL to send an
+ *               ::SDL_ASYNCIOCOMPLETE event instead.
+ *  \param userdata a pointer that is passed back with the outcome.
+ *
+ *  \return 0 if the task was started, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadAsyncIO(SDL_AsyncIO *asyncio, void *ptr,
+                                            Uint64 offset, Uint64 size,
+                                            SDL_AsyncIOQueue *queue,
+                                            void *userdata);
+
+/**
+ *  Start writing to a file.
+ *
+ *  \param asyncio the file to write to.
+ *  \param ptr the data to write, which must stay valid until the task has
+ *             finished.
+ *  \param offset the position in the file to start writing at.
+ *  \param size the number of bytes to write.
+ *  \param queue the queue the outcome is added to, or NULL to send an
+ *               ::SDL_ASYNCIOCOMPLETE event instead.
+ *  \param userdata a pointer that is passed back with the outcome.
+ *
+ *  \return 0 if the task was started, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_WriteAsyncIO(SDL_AsyncIO *asyncio,
+                                             const void *ptr,
+                                             Uint64 offset, Uint64 size,
+                                             SDL_AsyncIOQueue *queue,
+                                             void *userdata);
+
+/**
+ *  Close a file once all the tasks started on it have finished.
+ *
+ *  No more tasks can be started on the file after this, and it is freed
+ *  before the outcome of the close is reported.
+ *
+ *  \param asyncio the file to close.
+ *  \param queue the queue the outcome is added to, or NULL to send an
+ *               ::SDL_ASYNCIOCOMPLETE event instead.
+ *  \param userdata a pointer that is passed back with the outcome.
+ *
+ *  \return 0 if the close was started, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_CloseAsyncIO(SDL_AsyncIO *asyncio,
+                                             SDL_AsyncIOQueue *queue,
+                                             void *userdata);
+
+/**
+ *  Create a queue to collect the outcome of finished tasks.
+ *
+ *  A queue can be shared by any number of files and threads.
+ *
+ *  \return the new queue, or NULL on error.
+ */
+extern DECLSPEC SDL_AsyncIOQueue *SDLCALL SDL_CreateAsyncIOQueue(void);
+
+/**
+ *  Destroy a queue.
+ *
+ *  This waits for every task that reports to the queue to finish, and
+ *  throws away any outcomes that weren't picked up.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyAsyncIOQueue(SDL_AsyncIOQueue *queue);
+
+/**
+ *  Get the outcome of a finished task, without waiting.
+ *
+ *  \return SDL_TRUE if \c outcome was filled in, or SDL_FALSE if no task
+ *          has finished.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_GetAsyncIOResult(SDL_AsyncIOQueue *queue,
+                                                      SDL_AsyncIOOutcome *outcome);
+
+/**
+ *  Wait for a task to finish and get its outcome.
+ *
+ *  \param timeout the maximum number of milliseconds to wait, or -1 to
+ *                 wait until a task finishes.
+ *
+ *  \return SDL_TRUE if \c outcome was filled in, or SDL_FALSE if the
+ *          timeout passed first.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_WaitAsyncIOResult(SDL_AsyncIOQueue *queue,
+                                                       SDL_AsyncIOOutcome *outcome,
+                                                       int timeout);
+
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_asyncio_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -150,6 +150,9 @@ typedef enum
     /* Sensor events */
     SDL_SENSORUPDATE = 0x1200,     /**< A sensor was updated */
 
+    /* Asynchronous I/O events */
+    SDL_ASYNCIOCOMPLETE = 0x1300,  /**< An asynchronous I/O task without a queue finished */
+
     /* Render events */
     SDL_RENDER_TARGETS_RESET = 0x2000, /**< The render targets have been reset and their contents need to be updated */
     SDL_RENDER_DEVICE_RESET, /**< The device has been reset and all textures need to be recreated */
@@ -503,6 +506,21 @@ typedef struct SDL_SensorEvent
     float data[6];      /**< Up to 6 values from the sensor - additional values can be queried using SDL_SensorGetData() */
 } SDL_SensorEvent;
 
+/**
+ *  \brief Asynchronous I/O event structure (event.asyncio.*)
+ */
+typedef struct SDL_AsyncIOEvent
+{
+    Uint32 type;        /**< ::SDL_ASYNCIOCOMPLETE */
+    Uint32 timestamp;   /**< In milliseconds, populated using SDL_GetTicks() */
+    Uint32 task;        /**< The ::SDL_AsyncIOTaskType of the task */
+    Uint32 result;      /**< The ::SDL_AsyncIOResult of the task */
+    struct SDL_AsyncIO *asyncio;    /**< The file the task ran on, already freed for a close */
+    void *buffer;       /**< The buffer the data was read into or written from */
+    Uint64 bytes_transferred;   /**< The number of bytes actually transferred */
+    void *userdata;     /**< The pointer passed when the task was submitted */
+} SDL_AsyncIOEvent;
+
 /**
  *  \brief The "quit requested" event
  */
@@ -576,6 +594,7 @@ typedef union SDL_Event
     SDL_ControllerDeviceEvent cdevice;  /**< Game Controller device event data */
     SDL_AudioDeviceEvent adevice;   /**< Audio device event data */
     SDL_SensorEvent sensor;         /**< Sensor event data */
+    SDL_AsyncIOEvent asyncio;       /**< Asynchronous I/O event data */
     SDL_QuitEvent quit;             /**< Quit request event data */
     SDL_UserEvent user;             /**< Custom event data */
     SDL_SysWMEvent syswm;           /**< System dependent window event data */
@@ -635,6 +654,29 @@ typedef enum
 extern DECLSPEC int SDLCALL SDL_PeepEvents(SDL_Event * events, int numevents,
                                            SDL_eventaction action,
                                            Uint32 minType, Uint32 maxType);
+
+/**
+ *  Like SDL_PeepEvents(), but also stores the timestamp of each event in
+ *  \c timestamps, which may be NULL.
+ *
+ *  The timestamps are in nanoseconds, on the same clock as
+ *  SDL_GetPerformanceCounter().  They're the time the hardware reported
+ *  the event where the platform provides it, like joystick and evdev input
+ *  on Linux, and the time the event was queued otherwise.
+ *
+ *  If \c action is ::SDL_ADDEVENT, the nonzero entries of \c timestamps are
+ *  used as the hardware time of the events.
+ *
+ *  \return The number of events actually stored, or -1 if there was an error.
+ *
+ *  \sa SDL_PeepEvents
+ *  \sa SDL_GetEventLatency
+ */
+extern DECLSPEC int SDLCALL SDL_PeepEventsTimestamped(SDL_Event * events,
+                                                      Uint64 * timestamps,
+                                                      int numevents,
+                                                      SDL_eventaction action,
+                                                      Uint32 minType, Uint32 maxType);
 /* @} */
 
 /**
@@ -643,6 +685,34 @@ extern DECLSPEC int SDLCALL SDL_PeepEvents(SDL_Event * events, int numevents,
 extern DECLSPEC SDL_bool SDLCALL SDL_HasEvent(Uint32 type);
 extern DECLSPEC SDL_bool SDLCALL SDL_HasEvents(Uint32 minType, Uint32 maxType);
 
+/**
+ *  \brief How long the events of one type took to be queued after the
+ *         hardware reported them.
+ *
+ *  \sa SDL_GetEventLatency
+ */
+typedef struct SDL_EventLatency
+{
+    Uint32 count;       /**< The number of events with a hardware timestamp */
+    Uint32 padding;
+    Uint64 last;        /**< The latency of the latest event, in nanoseconds */
+    Uint64 average;     /**< The average latency, in nanoseconds */
+    Uint64 max;         /**< The longest latency, in nanoseconds */
+} SDL_EventLatency;
+
+/**
+ *  \brief Get the latency of the events of a type since the event loop
+ *         started.
+ *
+ *  Only events with a hardware timestamp are counted, all the fields are 0
+ *  if there haven't been any.
+ *
+ *  \return 0 on success, or -1 if \c type isn't an event type.
+ *
+ *  \sa SDL_PeepEventsTimestamped
+ */
+extern DECLSPEC int SDLCALL SDL_GetEventLatency(Uint32 type, SDL_EventLatency * latency);
+
 /**
  *  This function clears events from the event queue
  *  This function only affects currently queued events. If you want to make
@@ -662,6 +732,34 @@ extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
  */
 extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event * event);
 
+/**
+ *  \brief Polls for currently pending events, and gets the timestamp of the
+ *         event returned.
+ *
+ *  \return 1 if there are any pending events, or 0 if there are none available.
+ *
+ *  \param event If not NULL, the next event is removed from the queue and
+ *               stored in that area.
+ *  \param timestamp If not NULL, the nanosecond timestamp of the event is
+ *                   stored there, see SDL_PeepEventsTimestamped().
+ */
+extern DECLSPEC int SDLCALL SDL_PollEventTimestamped(SDL_Event * event, Uint64 * timestamp);
+
+/**
+ *  \brief Polls for currently pending events, and removes as many of them as
+ *         will fit from the queue at once.
+ *
+ *  This pumps the event loop once, and is much cheaper than calling
+ *  SDL_PollEvent() in a loop when a lot of events are queued.
+ *
+ *  \return The number of events stored in \c events, or -1 if there was an
+ *          error.
+ *
+ *  \param events The array the events are stored in.
+ *  \param numevents The number of events that will fit in \c events.
+ */
+extern DECLSPEC int SDLCALL SDL_PollEvents(SDL_Event * events, int numevents);
+
 /**
  *  \brief Waits indefinitely for the next available event.
  *
@@ -736,6 +834,19 @@ extern DECLSPEC SDL_bool SDLCALL SDL_GetEventFilter(SDL_EventFilter * filter,
 extern DECLSPEC void SDLCALL SDL_AddEventWatch(SDL_EventFilter filter,
                                                void *userdata);
 
+/**
+ *  Add a function which is called when an event with a type between
+ *  \c minType and \c maxType inclusive is added to the queue.
+ *
+ *  Events of other types don't call the function at all, which is cheaper
+ *  than checking the type in it.  The watch is removed with
+ *  SDL_DelEventWatch().
+ */
+extern DECLSPEC void SDLCALL SDL_AddEventWatchRange(SDL_EventFilter filter,
+                                                    void *userdata,
+                                                    Uint32 minType,
+                                                    Uint32 maxType);
+
 /**
  *  Remove an event watch function added with SDL_AddEventWatch()
  */
@@ -315,6 +315,21 @@ extern "C" {
  */
 #define SDL_HINT_TOUCH_MOUSE_EVENTS    "SDL_TOUCH_MOUSE_EVENTS"
 
+/**
+ *  \brief  A variable controlling whether motion events are merged in the event queue
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Every motion event is queued (the default)
+ *    "1"       - A motion event that arrives while the previous queued event is
+ *                motion from the same mouse and window, or the same finger, is
+ *                merged into it
+ *
+ *  A merged event has the latest position and timestamp, and the sum of the
+ *  relative motion.  Event filters and watchers are called before merging,
+ *  so an event watcher still sees every motion event at the full rate.
+ */
+#define SDL_HINT_EVENT_COALESCE_MOTION "SDL_EVENT_COALESCE_MOTION"
+
 /**
  *  \brief Minimize your SDL_Window if it loses key focus when in fullscreen mode. Defaults to true.
  *
@@ -545,6 +560,22 @@ extern "C" {
  */
 #define SDL_HINT_JOYSTICK_HIDAPI_XBOX   "SDL_JOYSTICK_HIDAPI_XBOX"
 
+/**
+ *  \brief  A variable controlling whether HIDAPI joysticks are read by a dedicated thread.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Reports are read when the joystick is updated (the default)
+ *    "1"       - Each open device has a thread that queues reports as they arrive
+ *
+ *  Queued reports are still handled when the joystick is updated, but events
+ *  keep the time the report arrived, and runs of reports that only move the
+ *  axes are collapsed to the latest one.  Button presses and releases are
+ *  never dropped.
+ *
+ *  This hint is checked when a joystick is opened.
+ */
+#define SDL_HINT_JOYSTICK_HIDAPI_THREAD "SDL_JOYSTICK_HIDAPI_THREAD"
+
 /**
  *  \brief  A variable that controls whether Steam Controllers should be exposed using the SDL joystick and game controller APIs
  *
@@ -556,6 +587,21 @@ extern "C" {
  */
 #define SDL_HINT_ENABLE_STEAM_CONTROLLERS "SDL_ENABLE_STEAM_CONTROLLERS"
 
+/**
+ *  \brief  A variable that controls whether Linux joystick and evdev input devices are read by a dedicated thread
+ *
+ *  The variable can be set to the following values:
+ *    "0"       - Input devices are read when events are pumped (the default)
+ *    "1"       - A background thread waits on the input devices with epoll and queues their events
+ *
+ *  With the thread the devices are drained as soon as input arrives, and pumping events
+ *  doesn't make any system calls when no input is pending.  The queued input is still
+ *  delivered when events are pumped.
+ *
+ *  This hint must be set before initializing the joystick or video subsystem.
+ */
+#define SDL_HINT_LINUX_INPUT_THREAD "SDL_LINUX_INPUT_THREAD"
+
 
 /**
  *  \brief If set to "0" then never set the top most bit on a SDL Window, even if the video mode expects it.
@@ -374,6 +374,41 @@ extern DECLSPEC int SDLCALL SDL_JoystickGetBall(SDL_Joystick * joystick,
 extern DECLSPEC Uint8 SDLCALL SDL_JoystickGetButton(SDL_Joystick * joystick,
                                                     int button);
 
+/**
+ *  The state of a joystick at one point in time.
+ *
+ *  \sa SDL_JoystickGetSnapshot
+ */
+typedef struct SDL_JoystickSnapshot
+{
+    Uint32 sequence;    /**< Incremented each time the state changes */
+    Uint32 padding;
+    Uint64 timestamp;   /**< When the state changed, see SDL_PeepEventsTimestamped() */
+    Sint16 *axes;       /**< If not NULL, receives SDL_JoystickNumAxes() values */
+    Uint8 *buttons;     /**< If not NULL, receives SDL_JoystickNumButtons() values */
+    Uint8 *hats;        /**< If not NULL, receives SDL_JoystickNumHats() values */
+} SDL_JoystickSnapshot;
+
+/**
+ *  Get a consistent copy of the state of a joystick, without locking.
+ *
+ *  The state is published each time SDL_JoystickUpdate() sees it change,
+ *  and this can be called from any thread while the joystick is open.
+ *
+ *  To read a fast joystick without filling the event queue, disable the
+ *  joystick events with SDL_JoystickEventState(SDL_IGNORE) and call
+ *  SDL_JoystickUpdate() at the rate you need.  Events are generated again
+ *  once they're enabled.
+ *
+ *  \param joystick The joystick to read
+ *  \param snapshot Receives the state, its \c axes, \c buttons and \c hats
+ *                  arrays are provided by the caller
+ *
+ *  \return 0, or -1 if you passed it invalid parameters.
+ */
+extern DECLSPEC int SDLCALL SDL_JoystickGetSnapshot(SDL_Joystick * joystick,
+                                                    SDL_JoystickSnapshot * snapshot);
+
 /**
  *  Trigger a rumble effect
  *  Each call to this function cancels any previous rumble effect, and calling it with 0 intensity stops any rumbling.
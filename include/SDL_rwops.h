@@ -45,6 +45,8 @@ extern "C" {
 #define SDL_RWOPS_JNIFILE   3U  /**< Android asset */
 #define SDL_RWOPS_MEMORY    4U  /**< Memory stream */
 #define SDL_RWOPS_MEMORY_RO 5U  /**< Read-Only memory stream */
+#define SDL_RWOPS_MAPPED    6U  /**< Read-Only memory-mapped file */
+#define SDL_RWOPS_BUFFERED  7U  /**< Buffered stream */
 
 /**
  * This is the read/write operation structure -- very basic.
@@ -165,6 +167,47 @@ extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromMem(void *mem, int size);
 extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromConstMem(const void *mem,
                                                       int size);
 
+/**
+ *  Open a file for reading by mapping it into memory.
+ *
+ *  The file is paged in lazily as it is read instead of being copied into
+ *  a buffer, and the mapped data can be accessed directly with
+ *  SDL_RWGetPointer().  The stream is read-only; writes fail.
+ *
+ *  If the file can't be mapped on this platform (an Android asset, for
+ *  example) this returns a regular read-only file stream instead, so check
+ *  the type for ::SDL_RWOPS_MAPPED if it matters.
+ *
+ *  \return the new stream, or NULL if the file couldn't be opened.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromFileMapped(const char *file);
+
+/**
+ *  Buffer small reads and writes on another stream.
+ *
+ *  Reads are satisfied from a read-ahead buffer and writes are collected
+ *  in a write-behind buffer, so parsing a file a few bytes at a time costs
+ *  a memory copy instead of a call into the underlying stream.  Seeking
+ *  within the data that was read ahead doesn't touch the underlying stream
+ *  either, any other seek discards the buffer.
+ *
+ *  Buffered writes are flushed when reading, seeking, asking for the size
+ *  or closing the stream, so write errors may be reported late.
+ *
+ *  \param context the stream to buffer.
+ *  \param buffersize the size of the buffer in bytes, or 0 for a default.
+ *  \param freesrc non-zero to close \c context when the buffered stream
+ *                 is closed.  Otherwise the data that was read ahead is
+ *                 given back to \c context by seeking backwards, leaving
+ *                 it at the position of the buffered stream.
+ *
+ *  \return the new stream, or NULL on error, in which case \c context is
+ *          left open.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromBuffered(SDL_RWops * context,
+                                                     size_t buffersize,
+                                                     int freesrc);
+
 /* @} *//* RWFrom functions */
 
 
@@ -189,6 +232,23 @@ extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops * area);
 #define SDL_RWclose(ctx)        (ctx)->close(ctx)
 /* @} *//* Read/write macros */
 
+/**
+ *  Borrow a pointer to the data at the current position of a memory backed
+ *  stream, created with SDL_RWFromMem(), SDL_RWFromConstMem() or
+ *  SDL_RWFromFileMapped(), so it can be used without being copied.
+ *
+ *  If \c available is not NULL, it is filled with the number of bytes that
+ *  can be accessed through the pointer.  The position in the stream is not
+ *  changed, use SDL_RWseek() to move past the data that was consumed.
+ *
+ *  The data must not be modified, and the pointer is only valid until the
+ *  stream is closed.
+ *
+ *  \return a pointer to the data, or NULL if the stream isn't memory backed.
+ */
+extern DECLSPEC const void *SDLCALL SDL_RWGetPointer(SDL_RWops * context,
+                                                     size_t *available);
+
 
 /**
  *  Load all the data from an SDL data stream.
@@ -0,0 +1,136 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/**
+ *  \file SDL_shmvideo.h
+ *
+ *  The shared memory layout used by the "shm" video driver.
+ *
+ *  This header is for programs that consume the frames of an SDL
+ *  application running with SDL_VIDEODRIVER=shm, it isn't included by
+ *  SDL.h.
+ *
+ *  Each window framebuffer is published as a POSIX shared memory object
+ *  named "/SDL_shm-<pid>-<window id>", or "/<SDL_VIDEO_SHM_NAME>-<window id>"
+ *  if that environment variable is set.  The name may start with a '/', but
+ *  can't contain one anywhere else.  The object starts with an
+ *  SDL_ShmVideoHeader, followed by \c num_buffers frame buffers of
+ *  \c buffer_size bytes each, starting at \c buffer_offset.
+ *
+ *  To read the latest frame, a consumer:
+ *    1. reads \c front, and stores it in \c reading,
+ *    2. reads \c front again, starting over if it changed,
+ *    3. reads the pixels of that buffer,
+ *    4. stores ::SDL_SHMVIDEO_NONE in \c reading when it's done.
+ *  The application never writes to the buffer named by \c front or
+ *  \c reading.  All accesses to the shared fields must be sequentially
+ *  consistent atomics, like SDL_AtomicGet() and SDL_AtomicSet().
+ *
+ *  \c sequence is incremented after each new frame, on Linux a consumer
+ *  can wait for it to change with FUTEX_WAIT.  When the window is resized
+ *  or destroyed \c closed is set, \c sequence is incremented, and the
+ *  object is unlinked, so the consumer should open it again.
+ *
+ *  Input is injected by adding SDL_ShmVideoEvent entries to the event ring,
+ *  which SDL reads when the application pumps events.  The consumer writes
+ *  the entry at \c event_head modulo \c num_events and then increments
+ *  \c event_head, as long as that leaves fewer than \c num_events entries
+ *  past \c event_tail.
+ */
+
+#ifndef SDL_shmvideo_h_
+#define SDL_shmvideo_h_
+
+#include "SDL_stdinc.h"
+#include "SDL_atomic.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SDL_SHMVIDEO_MAGIC      0x4D485353  /**< "SSHM" */
+#define SDL_SHMVIDEO_VERSION    1
+#define SDL_SHMVIDEO_NONE       -1          /**< No buffer in \c reading */
+
+/**
+ *  \brief The kind of input in an SDL_ShmVideoEvent.
+ */
+typedef enum
+{
+    SDL_SHMVIDEO_EVENT_KEY = 1,         /**< \c code is an SDL_Scancode */
+    SDL_SHMVIDEO_EVENT_TEXT,            /**< \c text is UTF-8 text input */
+    SDL_SHMVIDEO_EVENT_MOUSEMOTION,     /**< \c x and \c y are the position */
+    SDL_SHMVIDEO_EVENT_MOUSEBUTTON,     /**< \c code is the button, like SDL_BUTTON_LEFT */
+    SDL_SHMVIDEO_EVENT_MOUSEWHEEL,      /**< \c x and \c y are the amount scrolled */
+    SDL_SHMVIDEO_EVENT_CLOSE            /**< The window should close */
+} SDL_ShmVideoEventType;
+
+/**
+ *  \brief An input event in the event ring.
+ */
+typedef struct SDL_ShmVideoEvent
+{
+    Uint32 type;        /**< ::SDL_ShmVideoEventType */
+    Uint32 code;        /**< The scancode or mouse button */
+    Sint32 x;           /**< The mouse position or wheel amount */
+    Sint32 y;
+    Uint32 pressed;     /**< Nonzero for a key or button press */
+    Uint32 padding;
+    char text[32];      /**< Null terminated UTF-8 text */
+} SDL_ShmVideoEvent;
+
+/**
+ *  \brief The header at the start of the shared memory object.
+ */
+typedef struct SDL_ShmVideoHeader
+{
+    Uint32 magic;           /**< ::SDL_SHMVIDEO_MAGIC */
+    Uint32 version;         /**< ::SDL_SHMVIDEO_VERSION */
+    Uint32 format;          /**< The SDL_PixelFormatEnum of the pixels */
+    Sint32 w;               /**< The width of a frame in pixels */
+    Sint32 h;               /**< The height of a frame in pixels */
+    Sint32 pitch;           /**< The length of a row of pixels in bytes */
+    Uint32 num_buffers;     /**< The number of frame buffers */
+    Uint32 buffer_offset;   /**< The offset of the first frame buffer */
+    Uint32 buffer_size;     /**< The distance between frame buffers */
+    Uint32 event_offset;    /**< The offset of the event ring */
+    Uint32 num_events;      /**< The number of entries in the event ring */
+    Uint32 padding;
+
+    SDL_atomic_t sequence;  /**< Incremented after each frame */
+    SDL_atomic_t front;     /**< The buffer with the latest frame */
+    SDL_atomic_t reading;   /**< The buffer the consumer is reading */
+    SDL_atomic_t closed;    /**< Nonzero once the object is stale */
+    SDL_atomic_t event_head;    /**< Events added by the consumer */
+    SDL_atomic_t event_tail;    /**< Events read by SDL */
+} SDL_ShmVideoHeader;
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_shmvideo_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -394,11 +394,53 @@ extern DECLSPEC int SDLCALL SDL_SetMemoryFunctions(SDL_malloc_func malloc_func,
  */
 extern DECLSPEC int SDLCALL SDL_GetNumAllocations(void);
 
+/**
+ *  \brief Get the number of size classes in SDL's per-thread allocation cache
+ *
+ *  \return The number of size classes, or 0 if SDL was built without
+ *          MALLOC_THREAD_CACHE or is using the C library allocator.
+ */
+extern DECLSPEC int SDLCALL SDL_GetNumMemorySizeClasses(void);
+
+/**
+ *  \brief Get allocation counters for a size class of the per-thread cache
+ *
+ *  \param size_class A value between 0 and SDL_GetNumMemorySizeClasses() - 1
+ *  \param size Filled in with the block size of the class, may be NULL
+ *  \param allocations Filled in with the number of allocations served from
+ *                     this class since startup, may be NULL
+ *  \param cache_hits Filled in with how many of those allocations were
+ *                    served from a thread cache without locking, may be NULL
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \note Counts are exact for the calling thread; other threads add theirs
+ *        in batches, so their most recent allocations may not be included.
+ */
+extern DECLSPEC int SDLCALL SDL_GetMemorySizeClassStats(int size_class, size_t *size, int *allocations, int *cache_hits);
+
+/**
+ *  \brief Return the calling thread's cached memory blocks to the shared heap
+ *
+ *  \note Threads created with SDL_CreateThread() do this automatically when
+ *        they exit; other threads that call SDL_malloc() should call this
+ *        before exiting.
+ */
+extern DECLSPEC void SDLCALL SDL_FlushThreadMemoryCache(void);
+
 extern DECLSPEC char *SDLCALL SDL_getenv(const char *name);
 extern DECLSPEC int SDLCALL SDL_setenv(const char *name, const char *value, int overwrite);
 
 extern DECLSPEC void SDLCALL SDL_qsort(void *base, size_t nmemb, size_t size, int (*compare) (const void *, const void *));
 
+/**
+ *  \brief Sort an array, passing a context pointer to the comparison function
+ *
+ *  This always uses SDL's own sort, which is an unstable introsort, even
+ *  when the C library provides qsort().
+ */
+extern DECLSPEC void SDLCALL SDL_qsort_r(void *base, size_t nmemb, size_t size, int (*compare) (void *, const void *, const void *), void *userdata);
+
 extern DECLSPEC int SDLCALL SDL_abs(int x);
 
 /* !!! FIXME: these have side effects. You probably shouldn't use them. */
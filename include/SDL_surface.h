@@ -177,6 +177,21 @@ extern DECLSPEC int SDLCALL SDL_SetSurfacePalette(SDL_Surface * surface,
  *  \sa SDL_UnlockSurface()
  */
 extern DECLSPEC int SDLCALL SDL_LockSurface(SDL_Surface * surface);
+
+/**
+ *  \brief Sets up a surface for directly reading the pixels.
+ *
+ *  This is like SDL_LockSurface(), but promises not to change the pixels.
+ *  An RLE accelerated surface keeps its encoding, so it doesn't need to be
+ *  encoded again when it's unlocked.  Writing to \c surface->pixels while
+ *  the surface is locked this way may have no effect.
+ *
+ *  \return 0, or -1 if the surface couldn't be locked.
+ *
+ *  \sa SDL_LockSurface()
+ *  \sa SDL_UnlockSurface()
+ */
+extern DECLSPEC int SDLCALL SDL_LockSurfaceReadOnly(SDL_Surface * surface);
 /** \sa SDL_LockSurface() */
 extern DECLSPEC void SDLCALL SDL_UnlockSurface(SDL_Surface * surface);
 
@@ -30,6 +30,8 @@
 #include "SDL_bits.h"
 #include "SDL_revision.h"
 #include "SDL_assert_c.h"
+#include "SDL_framearena.h"
+#include "file/SDL_asyncio_c.h"
 #include "events/SDL_events_c.h"
 #include "haptic/SDL_haptic_c.h"
 #include "joystick/SDL_joystick_c.h"
@@ -371,6 +373,9 @@ SDL_Quit(void)
 {
     SDL_bInMainQuit = SDL_TRUE;
 
+    /* Let file I/O that's still running finish before events go away */
+    SDL_QuitAsyncIO();
+
     /* Quit all subsystems */
 #if SDL_VIDEO_DRIVER_WINDOWS
     SDL_HelperWindowDestroy();
@@ -384,6 +389,7 @@ SDL_Quit(void)
     SDL_ClearHints();
     SDL_AssertionsQuit();
     SDL_LogResetPriorities();
+    SDL_QuitFrameArena();
 
     /* Now that every subsystem has been quit, we reset the subsystem refcount
      * and the list of initialized subsystems.
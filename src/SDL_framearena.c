@@ -0,0 +1,259 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "./SDL_internal.h"
+#include "SDL.h"
+#include "./SDL_framearena.h"
+
+/* Every allocation is preceded by one of these. Allocations carved out of
+   the arena's block remember where the previous top of the arena was so
+   they can be popped; allocations that didn't fit get their own heap block
+   and are chained together until the next reset. */
+typedef union SDL_FrameHeader
+{
+    struct {
+        size_t prev_used;       /* or the allocation size for heap blocks */
+        union SDL_FrameHeader *link;  /* previous top, or next heap block */
+    } info;
+    Uint8 align[16];
+} SDL_FrameHeader;
+
+#define SDL_FRAME_ALIGN(x)  (((x) + 15) & ~(size_t)15)
+#define SDL_FRAME_MIN_BLOCK (16 * 1024)
+#define SDL_FRAME_SHRINK_FRAMES 120     /* Resets using under a quarter of the block before it shrinks */
+
+typedef struct SDL_FrameArena
+{
+    Uint8 *block;
+    size_t size;
+    size_t used;
+    SDL_FrameHeader *top;       /* most recent allocation in the block */
+    SDL_FrameHeader *overflow;  /* heap blocks, most recent first */
+    size_t overflow_used;
+    size_t peak;
+    size_t quiet_peak;          /* highest peak over the last quiet_frames resets */
+    int quiet_frames;
+} SDL_FrameArena;
+
+static SDL_SpinLock SDL_frame_arena_lock;
+static SDL_TLSID SDL_frame_arena_tls;
+
+static void SDLCALL
+SDL_FreeFrameArena(void *data)
+{
+    SDL_FrameArena *arena = (SDL_FrameArena *)data;
+    SDL_FrameHeader *overflow = arena->overflow;
+
+    while (overflow) {
+        SDL_FrameHeader *next = overflow->info.link;
+        SDL_free(overflow);
+        overflow = next;
+    }
+    SDL_free(arena->block);
+    SDL_free(arena);
+}
+
+static SDL_FrameArena *
+SDL_GetFrameArena(SDL_bool create)
+{
+    SDL_FrameArena *arena;
+
+    if (!SDL_frame_arena_tls) {
+        if (!create) {
+            return NULL;
+        }
+        SDL_AtomicLock(&SDL_frame_arena_lock);
+        if (!SDL_frame_arena_tls) {
+            SDL_TLSID slot = SDL_TLSCreate();
+            SDL_MemoryBarrierRelease();
+            SDL_frame_arena_tls = slot;
+        }
+        SDL_AtomicUnlock(&SDL_frame_arena_lock);
+    }
+    SDL_MemoryBarrierAcquire();
+
+    arena = (SDL_FrameArena *)SDL_TLSGet(SDL_frame_arena_tls);
+    if (!arena && create) {
+        arena = (SDL_FrameArena *)SDL_calloc(1, sizeof(*arena));
+        if (!arena) {
+            return NULL;
+        }
+        if (SDL_TLSSet(SDL_frame_arena_tls, arena, SDL_FreeFrameArena) < 0) {
+            SDL_free(arena);
+            return NULL;
+        }
+    }
+    return arena;
+}
+
+/* Called whenever nothing is allocated, to make the block big enough for
+   everything that was live at once since the last time. */
+static void
+SDL_SettleFrameArena(SDL_FrameArena *arena)
+{
+    if (arena->peak > arena->size) {
+        size_t size = SDL_max(arena->size * 2, SDL_FRAME_MIN_BLOCK);
+        Uint8 *block;
+
+        while (size < arena->peak) {
+            size *= 2;
+        }
+        block = (Uint8 *)SDL_malloc(size);
+        if (block) {
+            SDL_free(arena->block);
+            arena->block = block;
+            arena->size = size;
+        }
+    }
+    arena->quiet_peak = SDL_max(arena->quiet_peak, arena->peak);
+    arena->peak = 0;
+}
+
+/* Called on reset with the arena empty, so that a block sized for a burst
+   doesn't stay that big once the workload has gone back to normal. */
+static void
+SDL_ShrinkFrameArena(SDL_FrameArena *arena)
+{
+    size_t size = SDL_FRAME_MIN_BLOCK;
+
+    if (arena->size <= SDL_FRAME_MIN_BLOCK || arena->quiet_peak > arena->size / 4) {
+        arena->quiet_peak = 0;
+        arena->quiet_frames = 0;
+        return;
+    }
+    if (++arena->quiet_frames < SDL_FRAME_SHRINK_FRAMES) {
+        return;
+    }
+
+    while (size < arena->quiet_peak) {
+        size *= 2;
+    }
+    SDL_free(arena->block);
+    arena->block = (Uint8 *)SDL_malloc(size);
+    arena->size = arena->block ? size : 0;
+    arena->quiet_peak = 0;
+    arena->quiet_frames = 0;
+}
+
+void *
+SDL_AllocFrameMemory(size_t size)
+{
+    SDL_FrameArena *arena = SDL_GetFrameArena(SDL_TRUE);
+    SDL_FrameHeader *header;
+    size_t needed;
+
+    if (!arena) {
+        return NULL;
+    }
+
+    needed = sizeof(SDL_FrameHeader) + SDL_FRAME_ALIGN(size);
+    if (needed < size) {
+        return NULL;  /* overflow */
+    }
+
+    if (needed <= (arena->size - arena->used)) {
+        header = (SDL_FrameHeader *)(arena->block + arena->used);
+        header->info.prev_used = arena->used;
+        header->info.link = arena->top;
+        arena->top = header;
+        arena->used += needed;
+    } else {
+        header = (SDL_FrameHeader *)SDL_malloc(needed);
+        if (!header) {
+            return NULL;
+        }
+        header->info.prev_used = needed;
+        header->info.link = arena->overflow;
+        arena->overflow = header;
+        arena->overflow_used += needed;
+    }
+
+    arena->peak = SDL_max(arena->peak, arena->used + arena->overflow_used);
+    return header + 1;
+}
+
+void
+SDL_FreeFrameMemory(void *mem)
+{
+    SDL_FrameArena *arena;
+    SDL_FrameHeader *header;
+
+    if (!mem) {
+        return;
+    }
+
+    arena = SDL_GetFrameArena(SDL_FALSE);
+    if (!arena) {
+        return;
+    }
+
+    header = (SDL_FrameHeader *)mem - 1;
+    if (header == arena->top) {
+        arena->used = header->info.prev_used;
+        arena->top = header->info.link;
+    } else if (header == arena->overflow) {
+        arena->overflow = header->info.link;
+        arena->overflow_used -= header->info.prev_used;
+        SDL_free(header);
+    } else {
+        return;  /* Out of order, this will be reclaimed on reset */
+    }
+
+    if (!arena->top && !arena->overflow) {
+        SDL_SettleFrameArena(arena);
+    }
+}
+
+void
+SDL_ResetFrameArena(void)
+{
+    SDL_FrameArena *arena = SDL_GetFrameArena(SDL_FALSE);
+
+    if (!arena) {
+        return;
+    }
+
+    if (arena->top || arena->overflow || arena->peak > arena->size) {
+        while (arena->overflow) {
+            SDL_FrameHeader *next = arena->overflow->info.link;
+            SDL_free(arena->overflow);
+            arena->overflow = next;
+        }
+        arena->overflow_used = 0;
+        arena->used = 0;
+        arena->top = NULL;
+    }
+    SDL_SettleFrameArena(arena);
+    SDL_ShrinkFrameArena(arena);
+}
+
+void
+SDL_QuitFrameArena(void)
+{
+    SDL_FrameArena *arena = SDL_GetFrameArena(SDL_FALSE);
+
+    if (arena) {
+        SDL_TLSSet(SDL_frame_arena_tls, NULL, NULL);
+        SDL_FreeFrameArena(arena);
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
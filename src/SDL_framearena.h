@@ -0,0 +1,49 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef SDL_framearena_h_
+#define SDL_framearena_h_
+
+/* this is not a public API. It gives SDL's hot paths somewhere to put
+   temporary buffers without going to the heap every call.
+
+   Each thread gets its own arena. Memory from SDL_AllocFrameMemory() is
+   valid until it is given back with SDL_FreeFrameMemory() or the arena
+   is reset. Frees are cheap when they happen in reverse order of the
+   allocations; anything else is reclaimed at the next reset. Whenever the
+   arena becomes empty it grows its block to the peak it has seen, so once
+   a workload has settled no heap allocations are made at all. If a reset
+   keeps finding the block mostly unused, it shrinks back down again.
+
+   SDL_RenderPresent() and SDL_PumpEvents() reset the calling thread's
+   arena, so never hold on to frame memory across calls to those.
+   Returned memory is uninitialized and 16 byte aligned.
+*/
+
+void *SDL_AllocFrameMemory(size_t size);
+void SDL_FreeFrameMemory(void *mem);
+void SDL_ResetFrameArena(void);
+
+/* Releases the calling thread's arena entirely */
+void SDL_QuitFrameArena(void);
+
+#endif /* SDL_framearena_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -26,7 +26,9 @@
 #include "SDL_wave.h"
 
 
-static int ReadChunk(SDL_RWops * src, Chunk * chunk);
+static void ReadChunkHeader(SDL_RWops * src, Chunk * chunk);
+static int ReadChunkData(SDL_RWops * src, Chunk * chunk);
+static int SkipChunkData(SDL_RWops * src, Chunk * chunk);
 
 struct MS_ADPCM_decodestate
 {
@@ -119,7 +121,7 @@ static int
 MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
 {
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
+    Uint8 *encoded, *decoded;
     Sint32 encoded_len, samplesleft;
     Sint8 nybble;
     Uint8 stereo;
@@ -129,7 +131,6 @@ MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
     /* Allocate the proper sized output buffer */
     encoded_len = *audio_len;
     encoded = *audio_buf;
-    freeable = *audio_buf;
     *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
         MS_ADPCM_state.wSamplesPerBlock *
         MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
@@ -211,7 +212,6 @@ MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
         }
         encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -338,7 +338,7 @@ static int
 IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
 {
     struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
+    Uint8 *encoded, *decoded;
     Sint32 encoded_len, samplesleft;
     unsigned int c, channels;
 
@@ -354,7 +354,6 @@ IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
     /* Allocate the proper sized output buffer */
     encoded_len = *audio_len;
     encoded = *audio_buf;
-    freeable = *audio_buf;
     *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
         IMA_ADPCM_state.wSamplesPerBlock *
         IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
@@ -399,7 +398,6 @@ IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
         }
         encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -453,6 +451,7 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     int lenread;
     int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
     int samplesize;
+    SDL_bool skip;
 
     /* WAV magic header */
     Uint32 RIFFchunk;
@@ -464,6 +463,8 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     WaveFMT *format = NULL;
     WaveExtensibleFMT *ext = NULL;
 
+    SDL_RWops *buffered = NULL;
+
     SDL_zero(chunk);
 
     /* Make sure we are passed a valid data source */
@@ -473,6 +474,14 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         goto done;
     }
 
+    /* The chunk headers are read a few bytes at a time */
+    if (!SDL_RWGetPointer(src, NULL)) {
+        buffered = SDL_RWFromBuffered(src, 0, freesrc);
+        if (buffered) {
+            src = buffered;
+        }
+    }
+
     /* Check the magic header */
     RIFFchunk = SDL_ReadLE32(src);
     wavelen = SDL_ReadLE32(src);
@@ -493,16 +502,20 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     /* Read the audio data format chunk */
     chunk.data = NULL;
     do {
-        SDL_free(chunk.data);
-        chunk.data = NULL;
-        lenread = ReadChunk(src, &chunk);
+        ReadChunkHeader(src, &chunk);
+        skip = (chunk.magic == FACT) || (chunk.magic == LIST) || (chunk.magic == BEXT) || (chunk.magic == JUNK);
+        if (skip) {
+            lenread = SkipChunkData(src, &chunk);
+        } else {
+            lenread = ReadChunkData(src, &chunk);
+        }
         if (lenread < 0) {
             was_error = 1;
             goto done;
         }
         /* 2 Uint32's for chunk header+len, plus the lenread */
         headerDiff += lenread + 2 * sizeof(Uint32);
-    } while ((chunk.magic == FACT) || (chunk.magic == LIST) || (chunk.magic == BEXT) || (chunk.magic == JUNK));
+    } while (skip);
 
     /* Decode the audio data format */
     format = (WaveFMT *) chunk.data;
@@ -610,32 +623,56 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
 
     /* Read the audio data chunk */
     *audio_buf = NULL;
-    do {
-        SDL_free(*audio_buf);
-        *audio_buf = NULL;
-        lenread = ReadChunk(src, &chunk);
+    for (;;) {
+        ReadChunkHeader(src, &chunk);
+        if (chunk.magic == DATA) {
+            break;
+        }
+        lenread = SkipChunkData(src, &chunk);
         if (lenread < 0) {
             was_error = 1;
             goto done;
         }
-        *audio_len = lenread;
-        *audio_buf = chunk.data;
-        if (chunk.magic != DATA)
-            headerDiff += lenread + 2 * sizeof(Uint32);
-    } while (chunk.magic != DATA);
+        headerDiff += lenread + 2 * sizeof(Uint32);
+    }
     headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
 
-    if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
+    if (MS_ADPCM_encoded || IMA_ADPCM_encoded) {
+        /* The encoded data is only needed until it has been decoded,
+           so use it in place if the stream is memory backed. */
+        size_t available = 0;
+        Uint8 *encoded = (Uint8 *) SDL_RWGetPointer(src, &available);
+        Uint8 *freeable = NULL;
+
+        if (encoded && chunk.length > 0 && available >= chunk.length) {
+            SDL_RWseek(src, chunk.length, RW_SEEK_CUR);
+        } else if (ReadChunkData(src, &chunk) < 0) {
             was_error = 1;
             goto done;
+        } else {
+            encoded = freeable = chunk.data;
+            chunk.data = NULL;
         }
-    }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
+        *audio_buf = encoded;
+        *audio_len = chunk.length;
+        if (MS_ADPCM_encoded) {
+            was_error = (MS_ADPCM_decode(audio_buf, audio_len) < 0);
+        } else {
+            was_error = (IMA_ADPCM_decode(audio_buf, audio_len) < 0);
+        }
+        SDL_free(freeable);
+        if (was_error) {
+            *audio_buf = NULL;
+            goto done;
+        }
+    } else {
+        lenread = ReadChunkData(src, &chunk);
+        if (lenread < 0) {
             was_error = 1;
             goto done;
         }
+        *audio_len = lenread;
+        *audio_buf = chunk.data;
     }
 
     if (SDL_SwapLE16(format->bitspersample) == 24) {
@@ -652,12 +689,16 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
   done:
     SDL_free(format);
     if (src) {
-        if (freesrc) {
-            SDL_RWclose(src);
-        } else {
+        if (!freesrc) {
             /* seek to the end of the file (given by the RIFF chunk) */
             SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
         }
+        if (buffered) {
+            /* This closes the original stream too if it should be freed */
+            SDL_RWclose(buffered);
+        } else if (freesrc) {
+            SDL_RWclose(src);
+        }
     }
     if (was_error) {
         spec = NULL;
@@ -674,11 +715,17 @@ SDL_FreeWAV(Uint8 * audio_buf)
     SDL_free(audio_buf);
 }
 
-static int
-ReadChunk(SDL_RWops * src, Chunk * chunk)
+static void
+ReadChunkHeader(SDL_RWops * src, Chunk * chunk)
 {
     chunk->magic = SDL_ReadLE32(src);
     chunk->length = SDL_ReadLE32(src);
+    chunk->data = NULL;
+}
+
+static int
+ReadChunkData(SDL_RWops * src, Chunk * chunk)
+{
     chunk->data = (Uint8 *) SDL_malloc(chunk->length);
     if (chunk->data == NULL) {
         return SDL_OutOfMemory();
@@ -691,4 +738,24 @@ ReadChunk(SDL_RWops * src, Chunk * chunk)
     return (chunk->length);
 }
 
+/* Skip over a chunk we don't use, without copying it if the stream is
+   memory backed */
+static int
+SkipChunkData(SDL_RWops * src, Chunk * chunk)
+{
+    size_t available = 0;
+    int lenread;
+
+    if (chunk->length > 0 && SDL_RWGetPointer(src, &available) &&
+        available >= chunk->length) {
+        SDL_RWseek(src, chunk->length, RW_SEEK_CUR);
+        return (int) chunk->length;
+    }
+
+    lenread = ReadChunkData(src, chunk);
+    SDL_free(chunk->data);
+    chunk->data = NULL;
+    return lenread;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -31,11 +31,13 @@
 
 #include "SDL_evdev.h"
 #include "SDL_evdev_kbd.h"
+#include "SDL_evdev_thread.h"
 
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include <linux/input.h>
 
 #include "SDL.h"
@@ -50,6 +52,10 @@
 #ifndef SYN_DROPPED
 #define SYN_DROPPED 3
 #endif
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
 #ifndef ABS_MT_SLOT
 #define ABS_MT_SLOT         0x2f
 #define ABS_MT_POSITION_X   0x35
@@ -61,6 +67,8 @@ typedef struct SDL_evdevlist_item
 {
     char *path;
     int fd;
+    SDL_EVDEV_thread_device *input;  /* Set if the input thread reads fd */
+    SDL_bool hardware_timestamps;
 
     /* TODO: use this for every device, not just touchscreen */
     int out_of_sync;
@@ -99,6 +107,7 @@ typedef struct SDL_EVDEV_PrivateData
     SDL_evdevlist_item *first;
     SDL_evdevlist_item *last;
     SDL_EVDEV_keyboard_state *kbd;
+    SDL_bool input_thread;
 } SDL_EVDEV_PrivateData;
 
 #undef _THIS
@@ -135,8 +144,14 @@ SDL_EVDEV_Init(void)
             return SDL_OutOfMemory();
         }
 
+        /* Start it before the devices are added by the scan */
+        _this->input_thread = SDL_EVDEV_thread_init();
+
 #if SDL_USE_LIBUDEV
         if (SDL_UDEV_Init() < 0) {
+            if (_this->input_thread) {
+                SDL_EVDEV_thread_quit();
+            }
             SDL_free(_this);
             _this = NULL;
             return -1;
@@ -145,6 +160,9 @@ SDL_EVDEV_Init(void)
         /* Set up the udev callback */
         if (SDL_UDEV_AddCallback(SDL_EVDEV_udev_callback) < 0) {
             SDL_UDEV_Quit();
+            if (_this->input_thread) {
+                SDL_EVDEV_thread_quit();
+            }
             SDL_free(_this);
             _this = NULL;
             return -1;
@@ -190,6 +208,10 @@ SDL_EVDEV_Quit(void)
         SDL_assert(_this->last == NULL);
         SDL_assert(_this->num_devices == 0);
 
+        if (_this->input_thread) {
+            SDL_EVDEV_thread_quit();
+        }
+
         SDL_free(_this);
         _this = NULL;
     }
@@ -242,9 +264,21 @@ SDL_EVDEV_Poll(void)
     mouse = SDL_GetMouse();
 
     for (item = _this->first; item != NULL; item = item->next) {
-        while ((len = read(item->fd, events, (sizeof events))) > 0) {
-            len /= sizeof(events[0]);
+        for (;;) {
+            if (item->input) {
+                len = SDL_EVDEV_thread_read(item->input, events, SDL_arraysize(events));
+            } else {
+                len = read(item->fd, events, (sizeof events));
+                len = (len > 0) ? len / sizeof(events[0]) : 0;
+            }
+            if (len == 0) {
+                break;
+            }
             for (i = 0; i < len; ++i) {
+                if (item->hardware_timestamps) {
+                    SDL_SetEventHardwareTime(SDL_EVDEV_GetEventTime(&events[i]));
+                }
+
                 /* special handling for touchscreen, that should eventually be
                    used for all devices */
                 if (item->out_of_sync && item->is_touchscreen &&
@@ -387,6 +421,40 @@ SDL_EVDEV_Poll(void)
             }
         }    
     }
+
+    SDL_SetEventHardwareTime(0);
+}
+
+SDL_bool
+SDL_EVDEV_SetMonotonicClock(int fd)
+{
+#ifdef EVIOCSCLOCKID
+    int clock = CLOCK_MONOTONIC;
+
+    return (ioctl(fd, EVIOCSCLOCKID, &clock) == 0);
+#else
+    return SDL_FALSE;
+#endif
+}
+
+Uint64
+SDL_EVDEV_GetEventTime(const struct input_event *event)
+{
+    struct timespec now;
+    Uint64 now_ns, event_ns;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &now) < 0) {
+        return 0;
+    }
+    now_ns = (Uint64)now.tv_sec * 1000000000 + now.tv_nsec;
+    event_ns = (Uint64)event->input_event_sec * 1000000000 + (Uint64)event->input_event_usec * 1000;
+
+    /* Event timestamps use the performance counter, which may be on a
+       different clock, so only carry over how long ago the event happened */
+    if (event_ns > now_ns) {
+        event_ns = now_ns;
+    }
+    return SDL_GetEventTimeNS() - (now_ns - event_ns);
 }
 
 static SDL_Scancode
@@ -647,6 +715,12 @@ SDL_EVDEV_device_added(const char *dev_path, int udev_class)
         }
     }
 
+    item->hardware_timestamps = SDL_EVDEV_SetMonotonicClock(item->fd);
+
+    if (_this->input_thread) {
+        item->input = SDL_EVDEV_thread_add_device(item->fd);
+    }
+
     if (_this->last == NULL) {
         _this->first = _this->last = item;
     } else {
@@ -681,6 +755,7 @@ SDL_EVDEV_device_removed(const char *dev_path)
             if (item->is_touchscreen) {
                 SDL_EVDEV_destroy_touchscreen(item);
             }
+            SDL_EVDEV_thread_remove_device(item->input);
             close(item->fd);
             SDL_free(item->path);
             SDL_free(item);
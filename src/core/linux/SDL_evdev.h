@@ -28,10 +28,18 @@
 
 #include "SDL_events.h"
 
+#include <linux/input.h>
+
 extern int SDL_EVDEV_Init(void);
 extern void SDL_EVDEV_Quit(void);
 extern void SDL_EVDEV_Poll(void);
 
+/* Switches a device to CLOCK_MONOTONIC event times, returns SDL_FALSE if
+   they can't be used as event timestamps */
+extern SDL_bool SDL_EVDEV_SetMonotonicClock(int fd);
+/* Converts the time of an event from such a device to SDL_GetEventTimeNS() */
+extern Uint64 SDL_EVDEV_GetEventTime(const struct input_event *event);
+
 #endif /* SDL_INPUT_LINUXEV */
 
 #endif /* SDL_evdev_h_ */
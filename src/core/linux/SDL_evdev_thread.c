@@ -0,0 +1,405 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifdef SDL_INPUT_LINUXEV
+
+/* The thread only moves input events from the devices into queues, they're
+   still dispatched by the thread pumping events, which owns the joystick,
+   mouse and keyboard state.
+ */
+
+#include "SDL_evdev_thread.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "SDL_assert.h"
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "../../thread/SDL_systhread.h"
+
+/* These are not defined in older Linux kernel headers */
+#ifndef SYN_DROPPED
+#define SYN_DROPPED 3
+#endif
+
+/* The number of events queued for each device, the kernel keeps 64 */
+#define EVDEV_THREAD_QUEUE_SIZE 256
+
+/* The epoll data of the file descriptors that aren't devices */
+#define EVDEV_THREAD_WAKEUP     0
+#define EVDEV_THREAD_HOTPLUG    1
+
+struct SDL_EVDEV_thread_device
+{
+    Uint64 id;
+    int fd;
+    SDL_bool watched;
+
+    /* The count is only changed with the lock held, but it can be read
+       without it to find out if there's anything to do */
+    SDL_atomic_t count;
+    int head;
+    struct input_event queue[EVDEV_THREAD_QUEUE_SIZE];
+
+    struct SDL_EVDEV_thread_device *next;
+};
+
+typedef struct SDL_EVDEV_thread_data
+{
+    int ref_count;
+    int epoll_fd;
+    int wakeup_fd;
+    int hotplug_fd;
+    SDL_atomic_t hotplug_pending;
+    SDL_atomic_t quit;
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    Uint64 next_id;
+    SDL_EVDEV_thread_device *first;
+} SDL_EVDEV_thread_data;
+
+#undef _THIS
+#define _THIS SDL_EVDEV_thread_data *_this
+static _THIS = NULL;
+
+static void
+SDL_EVDEV_thread_read_device(SDL_EVDEV_thread_device *device)
+{
+    const int size = sizeof(device->queue[0]);
+
+    for (;;) {
+        int count = SDL_AtomicGet(&device->count);
+        int tail = (device->head + count) % EVDEV_THREAD_QUEUE_SIZE;
+        int space = SDL_min(EVDEV_THREAD_QUEUE_SIZE - count, EVDEV_THREAD_QUEUE_SIZE - tail);
+        ssize_t len;
+
+        if (count == EVDEV_THREAD_QUEUE_SIZE) {
+            /* Nobody is pumping events, throw away the queue and have the
+               device resynchronized, like the kernel does when it runs out
+               of room */
+            SDL_zero(device->queue[0]);
+            device->queue[0].type = EV_SYN;
+            device->queue[0].code = SYN_DROPPED;
+            device->head = 0;
+            SDL_AtomicSet(&device->count, 1);
+            continue;
+        }
+
+        len = read(device->fd, &device->queue[tail], space * size);
+        if (len > 0) {
+            SDL_AtomicAdd(&device->count, (int)(len / size));
+            if (len < space * size) {
+                break;  /* drained, epoll will tell us when there's more */
+            }
+        } else if (len < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (len == 0 || errno != EAGAIN) {
+                /* The device is gone, stop waiting on it until it's removed */
+                epoll_ctl(_this->epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+                device->watched = SDL_FALSE;
+            }
+            break;
+        }
+    }
+}
+
+static int SDLCALL
+SDL_EVDEV_thread_run(void *data)
+{
+    struct epoll_event events[16];
+    SDL_EVDEV_thread_device *device;
+    Uint64 counter;
+    int i, n;
+
+    while (!SDL_AtomicGet(&_this->quit)) {
+        n = epoll_wait(_this->epoll_fd, events, SDL_arraysize(events), -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        SDL_LockMutex(_this->lock);
+        for (i = 0; i < n; ++i) {
+            switch (events[i].data.u64) {
+            case EVDEV_THREAD_WAKEUP:
+                while (read(_this->wakeup_fd, &counter, sizeof(counter)) > 0) {
+                    continue;
+                }
+                break;
+            case EVDEV_THREAD_HOTPLUG:
+                /* The monitor is watched with EPOLLONESHOT, and rearmed once
+                   SDL_UDEV_Poll() has handled it */
+                SDL_AtomicSet(&_this->hotplug_pending, 1);
+                break;
+            default:
+                /* The device may have been removed since epoll_wait() returned */
+                for (device = _this->first; device != NULL; device = device->next) {
+                    if (device->id == events[i].data.u64) {
+                        if (device->watched) {
+                            SDL_EVDEV_thread_read_device(device);
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+        SDL_UnlockMutex(_this->lock);
+    }
+    return 0;
+}
+
+SDL_bool
+SDL_EVDEV_thread_init(void)
+{
+    struct epoll_event event;
+
+    if (_this != NULL) {
+        _this->ref_count += 1;
+        return SDL_TRUE;
+    }
+
+    if (!SDL_GetHintBoolean(SDL_HINT_LINUX_INPUT_THREAD, SDL_FALSE)) {
+        return SDL_FALSE;
+    }
+
+    _this = (SDL_EVDEV_thread_data *)SDL_calloc(1, sizeof(*_this));
+    if (_this == NULL) {
+        SDL_OutOfMemory();
+        return SDL_FALSE;
+    }
+    _this->hotplug_fd = -1;
+    _this->next_id = EVDEV_THREAD_HOTPLUG + 1;
+
+    _this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_this->epoll_fd < 0) {
+        SDL_free(_this);
+        _this = NULL;
+        return SDL_FALSE;
+    }
+
+    _this->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_this->wakeup_fd < 0) {
+        close(_this->epoll_fd);
+        SDL_free(_this);
+        _this = NULL;
+        return SDL_FALSE;
+    }
+
+    SDL_zero(event);
+    event.events = EPOLLIN;
+    event.data.u64 = EVDEV_THREAD_WAKEUP;
+    if (epoll_ctl(_this->epoll_fd, EPOLL_CTL_ADD, _this->wakeup_fd, &event) < 0) {
+        goto fail;
+    }
+
+    _this->lock = SDL_CreateMutex();
+    if (_this->lock == NULL) {
+        goto fail;
+    }
+
+    _this->thread = SDL_CreateThreadInternal(SDL_EVDEV_thread_run, "SDLInputThread", 64 * 1024, NULL);
+    if (_this->thread == NULL) {
+        goto fail;
+    }
+
+    _this->ref_count = 1;
+    return SDL_TRUE;
+
+fail:
+    if (_this->lock) {
+        SDL_DestroyMutex(_this->lock);
+    }
+    close(_this->wakeup_fd);
+    close(_this->epoll_fd);
+    SDL_free(_this);
+    _this = NULL;
+    return SDL_FALSE;
+}
+
+void
+SDL_EVDEV_thread_quit(void)
+{
+    const Uint64 counter = 1;
+
+    if (_this == NULL) {
+        return;
+    }
+
+    _this->ref_count -= 1;
+
+    if (_this->ref_count < 1) {
+        SDL_assert(_this->first == NULL);
+
+        SDL_AtomicSet(&_this->quit, 1);
+        if (write(_this->wakeup_fd, &counter, sizeof(counter)) < 0) {
+            /* Can't happen, the counter only overflows at 2^64 - 1 */
+        }
+        SDL_WaitThread(_this->thread, NULL);
+
+        SDL_DestroyMutex(_this->lock);
+        close(_this->wakeup_fd);
+        close(_this->epoll_fd);
+        SDL_free(_this);
+        _this = NULL;
+    }
+}
+
+SDL_EVDEV_thread_device *
+SDL_EVDEV_thread_add_device(int fd)
+{
+    SDL_EVDEV_thread_device *device;
+    struct epoll_event event;
+
+    if (_this == NULL) {
+        return NULL;
+    }
+
+    device = (SDL_EVDEV_thread_device *)SDL_calloc(1, sizeof(*device));
+    if (device == NULL) {
+        return NULL;
+    }
+    device->fd = fd;
+    device->watched = SDL_TRUE;
+
+    SDL_LockMutex(_this->lock);
+    device->id = _this->next_id++;
+
+    SDL_zero(event);
+    event.events = EPOLLIN;
+    event.data.u64 = device->id;
+    if (epoll_ctl(_this->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        SDL_UnlockMutex(_this->lock);
+        SDL_free(device);
+        return NULL;
+    }
+
+    device->next = _this->first;
+    _this->first = device;
+    SDL_UnlockMutex(_this->lock);
+
+    return device;
+}
+
+void
+SDL_EVDEV_thread_remove_device(SDL_EVDEV_thread_device *device)
+{
+    SDL_EVDEV_thread_device *prev = NULL;
+    SDL_EVDEV_thread_device *curr;
+
+    if (_this == NULL || device == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(_this->lock);
+    if (device->watched) {
+        epoll_ctl(_this->epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+    }
+    for (curr = _this->first; curr != NULL; curr = curr->next) {
+        if (curr == device) {
+            if (prev != NULL) {
+                prev->next = curr->next;
+            } else {
+                _this->first = curr->next;
+            }
+            break;
+        }
+        prev = curr;
+    }
+    SDL_UnlockMutex(_this->lock);
+
+    SDL_free(device);
+}
+
+int
+SDL_EVDEV_thread_read(SDL_EVDEV_thread_device *device, struct input_event *events, int maxevents)
+{
+    int count, n, first;
+
+    if (SDL_AtomicGet(&device->count) == 0) {
+        return 0;
+    }
+
+    SDL_LockMutex(_this->lock);
+    count = SDL_AtomicGet(&device->count);
+    n = SDL_min(count, maxevents);
+    first = SDL_min(n, EVDEV_THREAD_QUEUE_SIZE - device->head);
+    SDL_memcpy(events, &device->queue[device->head], first * sizeof(*events));
+    SDL_memcpy(events + first, &device->queue[0], (n - first) * sizeof(*events));
+    device->head = (device->head + n) % EVDEV_THREAD_QUEUE_SIZE;
+    SDL_AtomicSet(&device->count, count - n);
+    SDL_UnlockMutex(_this->lock);
+
+    return n;
+}
+
+SDL_bool
+SDL_EVDEV_thread_hotplug_idle(int fd)
+{
+    struct epoll_event event;
+
+    if (_this == NULL) {
+        return SDL_FALSE;
+    }
+
+    SDL_zero(event);
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = EVDEV_THREAD_HOTPLUG;
+
+    if (_this->hotplug_fd != fd) {
+        SDL_EVDEV_thread_unwatch_hotplug(_this->hotplug_fd);
+        if (epoll_ctl(_this->epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0) {
+            _this->hotplug_fd = fd;
+        }
+        return SDL_FALSE;
+    }
+
+    if (SDL_AtomicCAS(&_this->hotplug_pending, 1, 0)) {
+        epoll_ctl(_this->epoll_fd, EPOLL_CTL_MOD, fd, &event);
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+void
+SDL_EVDEV_thread_unwatch_hotplug(int fd)
+{
+    if (_this == NULL || fd < 0 || _this->hotplug_fd != fd) {
+        return;
+    }
+
+    epoll_ctl(_this->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    _this->hotplug_fd = -1;
+    SDL_AtomicSet(&_this->hotplug_pending, 0);
+}
+
+#endif /* SDL_INPUT_LINUXEV */
+
+/* vi: set ts=4 sw=4 expandtab: */
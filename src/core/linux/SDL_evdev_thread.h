@@ -0,0 +1,64 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_evdev_thread_h_
+#define SDL_evdev_thread_h_
+
+#include "../../SDL_internal.h"
+
+#ifdef SDL_INPUT_LINUXEV
+
+#include "SDL_stdinc.h"
+
+#include <linux/input.h>
+
+/* A thread that waits on input device file descriptors with epoll and
+   queues their events, so they can be drained without a system call when
+   events are pumped.  It's only started if SDL_HINT_LINUX_INPUT_THREAD is
+   set.
+ */
+struct SDL_EVDEV_thread_device;
+typedef struct SDL_EVDEV_thread_device SDL_EVDEV_thread_device;
+
+/* Returns SDL_TRUE if the thread is running, in which case the caller must
+   call SDL_EVDEV_thread_quit() when it's done with it */
+extern SDL_bool SDL_EVDEV_thread_init(void);
+extern void SDL_EVDEV_thread_quit(void);
+
+/* Starts reading a non-blocking device, returns NULL if the thread isn't
+   running and the caller should read the device itself */
+extern SDL_EVDEV_thread_device *SDL_EVDEV_thread_add_device(int fd);
+extern void SDL_EVDEV_thread_remove_device(SDL_EVDEV_thread_device *device);
+
+/* Returns the number of queued events copied into events, a SYN_DROPPED
+   event is queued if the application fell too far behind */
+extern int SDL_EVDEV_thread_read(SDL_EVDEV_thread_device *device, struct input_event *events, int maxevents);
+
+/* Returns SDL_TRUE if the thread is watching the udev monitor and it hasn't
+   received anything since the last call */
+extern SDL_bool SDL_EVDEV_thread_hotplug_idle(int fd);
+extern void SDL_EVDEV_thread_unwatch_hotplug(int fd);
+
+#endif /* SDL_INPUT_LINUXEV */
+
+#endif /* SDL_evdev_thread_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -35,6 +35,7 @@
 #include "SDL_loadso.h"
 #include "SDL_timer.h"
 #include "../unix/SDL_poll.h"
+#include "SDL_evdev_thread.h"
 
 static const char *SDL_UDEV_LIBS[] = { "libudev.so.1", "libudev.so.0" };
 
@@ -170,6 +171,9 @@ SDL_UDEV_Quit(void)
     if (_this->ref_count < 1) {
         
         if (_this->udev_mon != NULL) {
+#ifdef SDL_INPUT_LINUXEV
+            SDL_EVDEV_thread_unwatch_hotplug(_this->syms.udev_monitor_get_fd(_this->udev_mon));
+#endif
             _this->syms.udev_monitor_unref(_this->udev_mon);
             _this->udev_mon = NULL;
         }
@@ -480,6 +484,14 @@ SDL_UDEV_Poll(void)
         return;
     }
 
+#ifdef SDL_INPUT_LINUXEV
+    /* Skip the select() when the input thread knows nothing arrived */
+    if (_this->udev_mon != NULL &&
+        SDL_EVDEV_thread_hotplug_idle(_this->syms.udev_monitor_get_fd(_this->udev_mon))) {
+        return;
+    }
+#endif
+
     while (SDL_UDEV_hotplug_update_available()) {
         dev = _this->syms.udev_monitor_receive_device(_this->udev_mon);
         if (dev == NULL) {
@@ -701,3 +701,26 @@
 #define SDL_JoystickGetDevicePlayerIndex SDL_JoystickGetDevicePlayerIndex_REAL
 #define SDL_JoystickGetPlayerIndex SDL_JoystickGetPlayerIndex_REAL
 #define SDL_GameControllerGetPlayerIndex SDL_GameControllerGetPlayerIndex_REAL
+#define SDL_GetNumMemorySizeClasses SDL_GetNumMemorySizeClasses_REAL
+#define SDL_GetMemorySizeClassStats SDL_GetMemorySizeClassStats_REAL
+#define SDL_FlushThreadMemoryCache SDL_FlushThreadMemoryCache_REAL
+#define SDL_qsort_r SDL_qsort_r_REAL
+#define SDL_RWFromFileMapped SDL_RWFromFileMapped_REAL
+#define SDL_RWGetPointer SDL_RWGetPointer_REAL
+#define SDL_RWFromBuffered SDL_RWFromBuffered_REAL
+#define SDL_AsyncIOFromFile SDL_AsyncIOFromFile_REAL
+#define SDL_AsyncIOSize SDL_AsyncIOSize_REAL
+#define SDL_ReadAsyncIO SDL_ReadAsyncIO_REAL
+#define SDL_WriteAsyncIO SDL_WriteAsyncIO_REAL
+#define SDL_CloseAsyncIO SDL_CloseAsyncIO_REAL
+#define SDL_CreateAsyncIOQueue SDL_CreateAsyncIOQueue_REAL
+#define SDL_DestroyAsyncIOQueue SDL_DestroyAsyncIOQueue_REAL
+#define SDL_GetAsyncIOResult SDL_GetAsyncIOResult_REAL
+#define SDL_WaitAsyncIOResult SDL_WaitAsyncIOResult_REAL
+#define SDL_LockSurfaceReadOnly SDL_LockSurfaceReadOnly_REAL
+#define SDL_PeepEventsTimestamped SDL_PeepEventsTimestamped_REAL
+#define SDL_GetEventLatency SDL_GetEventLatency_REAL
+#define SDL_PollEventTimestamped SDL_PollEventTimestamped_REAL
+#define SDL_JoystickGetSnapshot SDL_JoystickGetSnapshot_REAL
+#define SDL_PollEvents SDL_PollEvents_REAL
+#define SDL_AddEventWatchRange SDL_AddEventWatchRange_REAL
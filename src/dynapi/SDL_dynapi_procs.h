@@ -755,3 +755,26 @@ SDL_DYNAPI_PROC(SDL_Thread*,SDL_CreateThreadWithStackSize,(SDL_ThreadFunction a,
 SDL_DYNAPI_PROC(int,SDL_JoystickGetDevicePlayerIndex,(int a),(a),return)
 SDL_DYNAPI_PROC(int,SDL_JoystickGetPlayerIndex,(SDL_Joystick *a),(a),return)
 SDL_DYNAPI_PROC(int,SDL_GameControllerGetPlayerIndex,(SDL_GameController *a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_GetNumMemorySizeClasses,(void),(),return)
+SDL_DYNAPI_PROC(int,SDL_GetMemorySizeClassStats,(int a, size_t *b, int *c, int *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_FlushThreadMemoryCache,(void),(),)
+SDL_DYNAPI_PROC(void,SDL_qsort_r,(void *a, size_t b, size_t c, int (*d)(void *, const void *, const void *), void *e),(a,b,c,d,e),)
+SDL_DYNAPI_PROC(SDL_RWops*,SDL_RWFromFileMapped,(const char *a),(a),return)
+SDL_DYNAPI_PROC(const void*,SDL_RWGetPointer,(SDL_RWops *a, size_t *b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_RWops*,SDL_RWFromBuffered,(SDL_RWops *a, size_t b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(SDL_AsyncIO*,SDL_AsyncIOFromFile,(const char *a, const char *b),(a,b),return)
+SDL_DYNAPI_PROC(Sint64,SDL_AsyncIOSize,(SDL_AsyncIO *a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_ReadAsyncIO,(SDL_AsyncIO *a, void *b, Uint64 c, Uint64 d, SDL_AsyncIOQueue *e, void *f),(a,b,c,d,e,f),return)
+SDL_DYNAPI_PROC(int,SDL_WriteAsyncIO,(SDL_AsyncIO *a, const void *b, Uint64 c, Uint64 d, SDL_AsyncIOQueue *e, void *f),(a,b,c,d,e,f),return)
+SDL_DYNAPI_PROC(int,SDL_CloseAsyncIO,(SDL_AsyncIO *a, SDL_AsyncIOQueue *b, void *c),(a,b,c),return)
+SDL_DYNAPI_PROC(SDL_AsyncIOQueue*,SDL_CreateAsyncIOQueue,(void),(),return)
+SDL_DYNAPI_PROC(void,SDL_DestroyAsyncIOQueue,(SDL_AsyncIOQueue *a),(a),)
+SDL_DYNAPI_PROC(SDL_bool,SDL_GetAsyncIOResult,(SDL_AsyncIOQueue *a, SDL_AsyncIOOutcome *b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_bool,SDL_WaitAsyncIOResult,(SDL_AsyncIOQueue *a, SDL_AsyncIOOutcome *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_LockSurfaceReadOnly,(SDL_Surface *a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_PeepEventsTimestamped,(SDL_Event *a, Uint64 *b, int c, SDL_eventaction d, Uint32 e, Uint32 f),(a,b,c,d,e,f),return)
+SDL_DYNAPI_PROC(int,SDL_GetEventLatency,(Uint32 a, SDL_EventLatency *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_PollEventTimestamped,(SDL_Event *a, Uint64 *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_JoystickGetSnapshot,(SDL_Joystick *a, SDL_JoystickSnapshot *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_PollEvents,(SDL_Event *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(void,SDL_AddEventWatchRange,(SDL_EventFilter a, void *b, Uint32 c, Uint32 d),(a,b,c,d),)
@@ -31,6 +31,7 @@
 #include "../joystick/SDL_joystick_c.h"
 #endif
 #include "../video/SDL_sysvideo.h"
+#include "../SDL_framearena.h"
 #include "SDL_syswm.h"
 
 /*#define SDL_DEBUG_EVENTS 1*/
@@ -38,18 +39,43 @@
 /* An arbitrary limit so we don't have unbounded growth */
 #define SDL_MAX_QUEUED_EVENTS   65535
 
+/* Queued events are also listed by category, the high byte of their type,
+   with all the user events sharing a category */
+#define SDL_EVENT_CATEGORIES    ((SDL_USEREVENT >> 8) + 1)
+
 typedef struct SDL_EventWatcher {
     SDL_EventFilter callback;
     void *userdata;
-    SDL_bool removed;
+    Uint32 minType;
+    Uint32 maxType;
+    SDL_atomic_t removed;
 } SDL_EventWatcher;
 
-static SDL_mutex *SDL_event_watchers_lock;
-static SDL_EventWatcher SDL_EventOK;
-static SDL_EventWatcher *SDL_event_watchers = NULL;
-static int SDL_event_watchers_count = 0;
-static SDL_bool SDL_event_watchers_dispatching = SDL_FALSE;
-static SDL_bool SDL_event_watchers_removed = SDL_FALSE;
+/* The event filter and watchers, which are never changed once they're
+   published, so events can be dispatched without taking a lock. */
+typedef struct SDL_EventWatcherTable {
+    SDL_EventFilter filter;
+    void *filter_userdata;
+    int num_watchers;
+    SDL_EventWatcher **watchers;            /* In the order they were added */
+    SDL_EventWatcher **category_watchers;   /* The watchers for each category */
+    int category_start[SDL_EVENT_CATEGORIES + 1];
+
+    /* Set when the table is replaced, and it's freed when nothing can be
+       dispatching it any more */
+    SDL_EventWatcher *removed;
+    struct SDL_EventWatcherTable *next_retired;
+} SDL_EventWatcherTable;
+
+static SDL_mutex *SDL_event_watchers_lock;          /* Held while changing the table */
+static SDL_mutex *SDL_event_watchers_sync_lock;     /* Held while waiting for dispatches to finish */
+static void *SDL_event_watchers_table = NULL;       /* SDL_EventWatcherTable, use atomics */
+static SDL_EventWatcherTable *SDL_event_watchers_retired = NULL;
+static SDL_atomic_t SDL_event_watchers_epoch;
+static SDL_atomic_t SDL_event_watchers_readers[2];  /* Dispatches in progress, by epoch */
+static SDL_TLSID SDL_event_watchers_depth;          /* Dispatches in progress on this thread */
+
+static void SDL_FreeEventWatchers(void);
 
 typedef struct {
     Uint32 bits[8];
@@ -57,14 +83,37 @@ typedef struct {
 
 static SDL_DisabledEventBlock *SDL_disabled_events[256];
 static Uint32 SDL_userevents = SDL_USEREVENT;
+static SDL_bool SDL_coalesce_motion = SDL_FALSE;
+
+typedef struct {
+    Uint32 count;
+    Uint64 last;
+    Uint64 total;
+    Uint64 max;
+} SDL_EventLatencyStats;
+
+typedef struct {
+    SDL_EventLatencyStats types[256];
+} SDL_EventLatencyBlock;
+
+/* Protected by the event queue lock */
+static SDL_EventLatencyBlock *SDL_event_latency[256];
+
+/* The hardware time of the events being sent, kept per thread as a Uint64 * */
+static SDL_SpinLock SDL_event_hardware_time_lock;
+static SDL_atomic_t SDL_event_hardware_time_tls;    /* SDL_TLSID, 0 until a time is set */
 
 /* Private data -- event queue */
 typedef struct _SDL_EventEntry
 {
     SDL_Event event;
+    Uint64 timestamp;   /* Nanoseconds, see SDL_GetEventTimeNS() */
     SDL_SysWMmsg msg;
     struct _SDL_EventEntry *prev;
     struct _SDL_EventEntry *next;
+    int category;       /* The list it's on, event filters may change its type */
+    struct _SDL_EventEntry *category_prev;
+    struct _SDL_EventEntry *category_next;
 } SDL_EventEntry;
 
 typedef struct _SDL_SysWMEntry
@@ -84,6 +133,8 @@ static struct
     SDL_EventEntry *free;
     SDL_SysWMEntry *wmmsg_used;
     SDL_SysWMEntry *wmmsg_free;
+    SDL_EventEntry *category_head[SDL_EVENT_CATEGORIES];
+    SDL_EventEntry *category_tail[SDL_EVENT_CATEGORIES];
 } SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
 
 
@@ -311,6 +362,12 @@ SDL_DebugPrintEvent(const SDL_Event *event)
 
 
 
+static void SDLCALL
+SDL_CoalesceMotionChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL_coalesce_motion = (hint && *hint != '0') ? SDL_TRUE : SDL_FALSE;
+}
+
 /* Public functions */
 
 void
@@ -361,6 +418,8 @@ SDL_StopEventLoop(void)
     SDL_EventQ.free = NULL;
     SDL_EventQ.wmmsg_used = NULL;
     SDL_EventQ.wmmsg_free = NULL;
+    SDL_zero(SDL_EventQ.category_head);
+    SDL_zero(SDL_EventQ.category_tail);
 
     /* Clear disabled event state */
     for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
@@ -368,16 +427,23 @@ SDL_StopEventLoop(void)
         SDL_disabled_events[i] = NULL;
     }
 
+    for (i = 0; i < SDL_arraysize(SDL_event_latency); ++i) {
+        SDL_free(SDL_event_latency[i]);
+        SDL_event_latency[i] = NULL;
+    }
+
+    SDL_FreeEventWatchers();
     if (SDL_event_watchers_lock) {
         SDL_DestroyMutex(SDL_event_watchers_lock);
         SDL_event_watchers_lock = NULL;
     }
-    if (SDL_event_watchers) {
-        SDL_free(SDL_event_watchers);
-        SDL_event_watchers = NULL;
-        SDL_event_watchers_count = 0;
+    if (SDL_event_watchers_sync_lock) {
+        SDL_DestroyMutex(SDL_event_watchers_sync_lock);
+        SDL_event_watchers_sync_lock = NULL;
     }
-    SDL_zero(SDL_EventOK);
+
+    SDL_DelHintCallback(SDL_HINT_EVENT_COALESCE_MOTION, SDL_CoalesceMotionChanged, NULL);
+    SDL_coalesce_motion = SDL_FALSE;
 
     if (SDL_EventQ.lock) {
         SDL_UnlockMutex(SDL_EventQ.lock);
@@ -411,8 +477,21 @@ SDL_StartEventLoop(void)
             return -1;
         }
     }
+
+    if (!SDL_event_watchers_sync_lock) {
+        SDL_event_watchers_sync_lock = SDL_CreateMutex();
+        if (SDL_event_watchers_sync_lock == NULL) {
+            return -1;
+        }
+    }
 #endif /* !SDL_THREADS_DISABLED */
 
+    if (!SDL_event_watchers_depth) {
+        SDL_event_watchers_depth = SDL_TLSCreate();
+    }
+
+    SDL_AddHintCallback(SDL_HINT_EVENT_COALESCE_MOTION, SDL_CoalesceMotionChanged, NULL);
+
     /* Process most event types */
     SDL_EventState(SDL_TEXTINPUT, SDL_DISABLE);
     SDL_EventState(SDL_TEXTEDITING, SDL_DISABLE);
@@ -428,13 +507,234 @@ SDL_StartEventLoop(void)
 }
 
 
+Uint64
+SDL_GetEventTimeNS(void)
+{
+    const Uint64 counter = SDL_GetPerformanceCounter();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    return (counter / frequency) * 1000000000 + ((counter % frequency) * 1000000000) / frequency;
+}
+
+void
+SDL_SetEventHardwareTime(Uint64 timestamp)
+{
+    SDL_TLSID tls = (SDL_TLSID)SDL_AtomicGet(&SDL_event_hardware_time_tls);
+    Uint64 *hardware_time;
+
+    if (!tls) {
+        if (!timestamp) {
+            return;
+        }
+        SDL_AtomicLock(&SDL_event_hardware_time_lock);
+        tls = (SDL_TLSID)SDL_AtomicGet(&SDL_event_hardware_time_tls);
+        if (!tls) {
+            tls = SDL_TLSCreate();
+            SDL_AtomicSet(&SDL_event_hardware_time_tls, (int)tls);
+        }
+        SDL_AtomicUnlock(&SDL_event_hardware_time_lock);
+        if (!tls) {
+            return;
+        }
+    }
+
+    hardware_time = (Uint64 *)SDL_TLSGet(tls);
+    if (!hardware_time) {
+        if (!timestamp) {
+            return;
+        }
+        hardware_time = (Uint64 *)SDL_malloc(sizeof(*hardware_time));
+        if (!hardware_time || SDL_TLSSet(tls, hardware_time, SDL_free) < 0) {
+            SDL_free(hardware_time);
+            return;
+        }
+    }
+    *hardware_time = timestamp;
+}
+
+Uint64
+SDL_GetEventHardwareTime(void)
+{
+    SDL_TLSID tls = (SDL_TLSID)SDL_AtomicGet(&SDL_event_hardware_time_tls);
+    const Uint64 *hardware_time;
+
+    if (!tls) {
+        return 0;
+    }
+    hardware_time = (const Uint64 *)SDL_TLSGet(tls);
+    return hardware_time ? *hardware_time : 0;
+}
+
+/* Record how long an event took to be queued -- called with the queue locked */
+static void
+SDL_UpdateEventLatency(Uint32 type, Uint64 latency)
+{
+    SDL_EventLatencyStats *stats;
+    Uint8 hi = ((type >> 8) & 0xff);
+
+    if (type > SDL_LASTEVENT) {
+        return;
+    }
+
+    if (!SDL_event_latency[hi]) {
+        SDL_event_latency[hi] = (SDL_EventLatencyBlock *)SDL_calloc(1, sizeof(SDL_EventLatencyBlock));
+        if (!SDL_event_latency[hi]) {
+            return;
+        }
+    }
+
+    stats = &SDL_event_latency[hi]->types[type & 0xff];
+    stats->count += 1;
+    stats->last = latency;
+    stats->total += latency;
+    if (latency > stats->max) {
+        stats->max = latency;
+    }
+}
+
+static SDL_INLINE int
+SDL_GetEventCategory(Uint32 type)
+{
+    if (type >= SDL_USEREVENT) {
+        return (SDL_USEREVENT >> 8);
+    }
+    return (int)(type >> 8);
+}
+
+/* Find the first queued event that could be in the range of types, and
+   whether the rest should be found by category -- called with the queue locked */
+static SDL_EventEntry *
+SDL_FindEvents(Uint32 minType, Uint32 maxType, SDL_bool *by_category)
+{
+    const int first = SDL_GetEventCategory(minType);
+    const int last = SDL_GetEventCategory(maxType);
+    int category, found = -1;
+
+    *by_category = SDL_FALSE;
+
+    if (!SDL_EventQ.head || minType > maxType) {
+        return NULL;
+    }
+    if (first == 0 && last == SDL_EVENT_CATEGORIES - 1) {
+        /* Every queued event's category is in range, as when polling */
+        return SDL_EventQ.head;
+    }
+
+    for (category = first; category <= last; ++category) {
+        if (SDL_EventQ.category_head[category]) {
+            if (found >= 0) {
+                /* Events from several categories have to be seen in order */
+                return SDL_EventQ.head;
+            }
+            found = category;
+        }
+    }
+    if (found < 0) {
+        return NULL;
+    }
+
+    *by_category = SDL_TRUE;
+    return SDL_EventQ.category_head[found];
+}
+
+/* Merge a motion event into the one at the end of the queue, if it continues it */
+static SDL_bool
+SDL_CoalesceEvent(SDL_Event *last, const SDL_Event *event)
+{
+    if (last->type != event->type) {
+        return SDL_FALSE;
+    }
+
+    switch (event->type) {
+    case SDL_MOUSEMOTION:
+        if (last->motion.windowID != event->motion.windowID ||
+            last->motion.which != event->motion.which ||
+            last->motion.state != event->motion.state) {
+            return SDL_FALSE;
+        }
+        last->motion.timestamp = event->motion.timestamp;
+        last->motion.x = event->motion.x;
+        last->motion.y = event->motion.y;
+        last->motion.xrel += event->motion.xrel;
+        last->motion.yrel += event->motion.yrel;
+        return SDL_TRUE;
+
+    case SDL_FINGERMOTION:
+        if (last->tfinger.touchId != event->tfinger.touchId ||
+            last->tfinger.fingerId != event->tfinger.fingerId) {
+            return SDL_FALSE;
+        }
+        last->tfinger.timestamp = event->tfinger.timestamp;
+        last->tfinger.x = event->tfinger.x;
+        last->tfinger.y = event->tfinger.y;
+        last->tfinger.dx += event->tfinger.dx;
+        last->tfinger.dy += event->tfinger.dy;
+        last->tfinger.pressure = event->tfinger.pressure;
+        return SDL_TRUE;
+
+    default:
+        return SDL_FALSE;
+    }
+}
+
+/* Put a queued event on its category list after prev, or first if prev is NULL -- called with the queue locked */
+static void
+SDL_LinkEventCategory(SDL_EventEntry *entry, int category, SDL_EventEntry *prev)
+{
+    entry->category = category;
+    entry->category_prev = prev;
+    entry->category_next = prev ? prev->category_next : SDL_EventQ.category_head[category];
+    if (prev) {
+        prev->category_next = entry;
+    } else {
+        SDL_EventQ.category_head[category] = entry;
+    }
+    if (entry->category_next) {
+        entry->category_next->category_prev = entry;
+    } else {
+        SDL_EventQ.category_tail[category] = entry;
+    }
+}
+
+/* Take an event off the category list it was put on -- called with the queue locked */
+static void
+SDL_UnlinkEventCategory(SDL_EventEntry *entry)
+{
+    const int category = entry->category;
+
+    if (entry->category_prev) {
+        entry->category_prev->category_next = entry->category_next;
+    } else {
+        SDL_EventQ.category_head[category] = entry->category_next;
+    }
+    if (entry->category_next) {
+        entry->category_next->category_prev = entry->category_prev;
+    } else {
+        SDL_EventQ.category_tail[category] = entry->category_prev;
+    }
+}
+
 /* Add an event to the event queue -- called with the queue locked */
 static int
-SDL_AddEvent(SDL_Event * event)
+SDL_AddEvent(SDL_Event * event, Uint64 hardware_time)
 {
     SDL_EventEntry *entry;
     const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
     int final_count;
+    int category;
+    Uint64 now;
+
+    if (SDL_coalesce_motion && SDL_EventQ.tail &&
+        SDL_CoalesceEvent(&SDL_EventQ.tail->event, event)) {
+        now = SDL_GetEventTimeNS();
+        if (hardware_time) {
+            SDL_EventQ.tail->timestamp = hardware_time;
+            SDL_UpdateEventLatency(event->type, (now > hardware_time) ? (now - hardware_time) : 0);
+        } else {
+            SDL_EventQ.tail->timestamp = now;
+        }
+        return 1;
+    }
 
     if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
         SDL_SetError("Event queue is full (%d events)", initial_count);
@@ -461,6 +761,14 @@ SDL_AddEvent(SDL_Event * event)
         entry->event.syswm.msg = &entry->msg;
     }
 
+    now = SDL_GetEventTimeNS();
+    if (hardware_time) {
+        entry->timestamp = hardware_time;
+        SDL_UpdateEventLatency(event->type, (now > hardware_time) ? (now - hardware_time) : 0);
+    } else {
+        entry->timestamp = now;
+    }
+
     if (SDL_EventQ.tail) {
         SDL_EventQ.tail->next = entry;
         entry->prev = SDL_EventQ.tail;
@@ -473,6 +781,8 @@ SDL_AddEvent(SDL_Event * event)
         entry->prev = NULL;
         entry->next = NULL;
     }
+    category = SDL_GetEventCategory(event->type);
+    SDL_LinkEventCategory(entry, category, SDL_EventQ.category_tail[category]);
 
     final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
     if (final_count > SDL_EventQ.max_events_seen) {
@@ -486,6 +796,8 @@ SDL_AddEvent(SDL_Event * event)
 static void
 SDL_CutEvent(SDL_EventEntry *entry)
 {
+    SDL_UnlinkEventCategory(entry);
+
     if (entry->prev) {
         entry->prev->next = entry->next;
     }
@@ -512,6 +824,13 @@ SDL_CutEvent(SDL_EventEntry *entry)
 int
 SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
                Uint32 minType, Uint32 maxType)
+{
+    return SDL_PeepEventsTimestamped(events, NULL, numevents, action, minType, maxType);
+}
+
+int
+SDL_PeepEventsTimestamped(SDL_Event * events, Uint64 * timestamps, int numevents,
+                          SDL_eventaction action, Uint32 minType, Uint32 maxType)
 {
     int i, used;
 
@@ -527,12 +846,14 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
     used = 0;
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         if (action == SDL_ADDEVENT) {
+            const Uint64 hardware_time = SDL_GetEventHardwareTime();
             for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
+                used += SDL_AddEvent(&events[i], (timestamps && timestamps[i]) ? timestamps[i] : hardware_time);
             }
         } else {
             SDL_EventEntry *entry, *next;
             SDL_SysWMEntry *wmmsg, *wmmsg_next;
+            SDL_bool by_category;
             Uint32 type;
 
             if (action == SDL_GETEVENT) {
@@ -547,12 +868,15 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
                 SDL_EventQ.wmmsg_used = NULL;
             }
 
-            for (entry = SDL_EventQ.head; entry && (!events || used < numevents); entry = next) {
-                next = entry->next;
+            for (entry = SDL_FindEvents(minType, maxType, &by_category); entry && (!events || used < numevents); entry = next) {
+                next = by_category ? entry->category_next : entry->next;
                 type = entry->event.type;
                 if (minType <= type && type <= maxType) {
                     if (events) {
                         events[used] = entry->event;
+                        if (timestamps) {
+                            timestamps[used] = entry->timestamp;
+                        }
                         if (entry->event.type == SDL_SYSWMEVENT) {
                             /* We need to copy the wmmsg somewhere safe.
                                For now we'll guarantee it's valid at least until
@@ -599,6 +923,37 @@ SDL_HasEvents(Uint32 minType, Uint32 maxType)
     return (SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, minType, maxType) > 0);
 }
 
+int
+SDL_GetEventLatency(Uint32 type, SDL_EventLatency * latency)
+{
+    const SDL_EventLatencyStats *stats = NULL;
+
+    if (!latency) {
+        return SDL_InvalidParamError("latency");
+    }
+    SDL_zerop(latency);
+
+    if (type > SDL_LASTEVENT) {
+        return SDL_InvalidParamError("type");
+    }
+
+    if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        if (SDL_event_latency[(type >> 8) & 0xff]) {
+            stats = &SDL_event_latency[(type >> 8) & 0xff]->types[type & 0xff];
+            if (stats->count > 0) {
+                latency->count = stats->count;
+                latency->last = stats->last;
+                latency->average = stats->total / stats->count;
+                latency->max = stats->max;
+            }
+        }
+        if (SDL_EventQ.lock) {
+            SDL_UnlockMutex(SDL_EventQ.lock);
+        }
+    }
+    return 0;
+}
+
 void
 SDL_FlushEvent(Uint32 type)
 {
@@ -628,9 +983,10 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+        SDL_bool by_category;
         Uint32 type;
-        for (entry = SDL_EventQ.head; entry; entry = next) {
-            next = entry->next;
+        for (entry = SDL_FindEvents(minType, maxType, &by_category); entry; entry = next) {
+            next = by_category ? entry->category_next : entry->next;
             type = entry->event.type;
             if (minType <= type && type <= maxType) {
                 SDL_CutEvent(entry);
@@ -667,6 +1023,9 @@ SDL_PumpEvents(void)
 #endif
 
     SDL_SendPendingQuit();  /* in case we had a signal handler fire, etc. */
+
+    /* Temporary memory used while processing events can be reused */
+    SDL_ResetFrameArena();
 }
 
 /* Public functions */
@@ -677,6 +1036,27 @@ SDL_PollEvent(SDL_Event * event)
     return SDL_WaitEventTimeout(event, 0);
 }
 
+int
+SDL_PollEventTimestamped(SDL_Event * event, Uint64 * timestamp)
+{
+    SDL_PumpEvents();
+    return (SDL_PeepEventsTimestamped(event, timestamp, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0);
+}
+
+int
+SDL_PollEvents(SDL_Event * events, int numevents)
+{
+    if (!events) {
+        return SDL_InvalidParamError("events");
+    }
+    if (numevents <= 0) {
+        return 0;
+    }
+
+    SDL_PumpEvents();
+    return SDL_PeepEvents(events, numevents, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
 int
 SDL_WaitEvent(SDL_Event * event)
 {
@@ -714,51 +1094,236 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
     }
 }
 
-int
-SDL_PushEvent(SDL_Event * event)
+/* Start using the current watcher table, which won't be freed until
+   SDL_LeaveEventWatchers() is called with the epoch this returns */
+static int
+SDL_EnterEventWatchers(void)
 {
-    event->common.timestamp = SDL_GetTicks();
+    int epoch;
 
-    if (SDL_EventOK.callback || SDL_event_watchers_count > 0) {
-        if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
-            if (SDL_EventOK.callback && !SDL_EventOK.callback(SDL_EventOK.userdata, event)) {
-                if (SDL_event_watchers_lock) {
-                    SDL_UnlockMutex(SDL_event_watchers_lock);
-                }
-                return 0;
+    for ( ; ; ) {
+        epoch = SDL_AtomicGet(&SDL_event_watchers_epoch);
+        SDL_AtomicIncRef(&SDL_event_watchers_readers[epoch]);
+        if (SDL_AtomicGet(&SDL_event_watchers_epoch) == epoch) {
+            return epoch;
+        }
+        /* A table was retired in between, so make sure it isn't waiting on us */
+        SDL_AtomicAdd(&SDL_event_watchers_readers[epoch], -1);
+    }
+}
+
+static void
+SDL_LeaveEventWatchers(int epoch)
+{
+    SDL_AtomicAdd(&SDL_event_watchers_readers[epoch], -1);
+}
+
+static SDL_bool
+SDL_IsDispatchingEvent(void)
+{
+    return (SDL_event_watchers_depth && SDL_TLSGet(SDL_event_watchers_depth)) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void
+SDL_SetDispatchingEvent(int delta)
+{
+    if (SDL_event_watchers_depth) {
+        size_t depth = (size_t)SDL_TLSGet(SDL_event_watchers_depth);
+        SDL_TLSSet(SDL_event_watchers_depth, (void *)(depth + delta), NULL);
+    }
+}
+
+static void
+SDL_FreeEventWatcherTable(SDL_EventWatcherTable *table)
+{
+    SDL_free(table->removed);
+    SDL_free(table);
+}
+
+/* Build a table with the watchers of an old one, leaving one out and adding another */
+static SDL_EventWatcherTable *
+SDL_CreateEventWatcherTable(SDL_EventFilter filter, void *filter_userdata, const SDL_EventWatcherTable *old, SDL_EventWatcher *add, SDL_EventWatcher *remove)
+{
+    SDL_EventWatcherTable *table;
+    SDL_EventWatcher *watcher;
+    int cursor[SDL_EVENT_CATEGORIES];
+    int i, category, last, num_watchers = 0, num_entries = 0;
+    const int num_old = old ? old->num_watchers : 0;
+
+    for (i = 0; i <= num_old; ++i) {
+        watcher = (i < num_old) ? old->watchers[i] : add;
+        if (watcher && watcher != remove) {
+            ++num_watchers;
+            num_entries += SDL_GetEventCategory(watcher->maxType) - SDL_GetEventCategory(watcher->minType) + 1;
+        }
+    }
+
+    table = (SDL_EventWatcherTable *)SDL_calloc(1, sizeof(*table) + (num_watchers + num_entries) * sizeof(SDL_EventWatcher *));
+    if (!table) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    table->filter = filter;
+    table->filter_userdata = filter_userdata;
+    table->watchers = (SDL_EventWatcher **)(table + 1);
+    table->category_watchers = table->watchers + num_watchers;
+
+    for (i = 0; i <= num_old; ++i) {
+        watcher = (i < num_old) ? old->watchers[i] : add;
+        if (watcher && watcher != remove) {
+            table->watchers[table->num_watchers++] = watcher;
+            last = SDL_GetEventCategory(watcher->maxType);
+            for (category = SDL_GetEventCategory(watcher->minType); category <= last; ++category) {
+                ++table->category_start[category + 1];
             }
+        }
+    }
 
-            if (SDL_event_watchers_count > 0) {
-                /* Make sure we only dispatch the current watcher list */
-                int i, event_watchers_count = SDL_event_watchers_count;
+    /* List the watchers for each category in the order they were added */
+    for (category = 0; category < SDL_EVENT_CATEGORIES; ++category) {
+        table->category_start[category + 1] += table->category_start[category];
+        cursor[category] = table->category_start[category];
+    }
+    for (i = 0; i < table->num_watchers; ++i) {
+        watcher = table->watchers[i];
+        last = SDL_GetEventCategory(watcher->maxType);
+        for (category = SDL_GetEventCategory(watcher->minType); category <= last; ++category) {
+            table->category_watchers[cursor[category]++] = watcher;
+        }
+    }
+    return table;
+}
 
-                SDL_event_watchers_dispatching = SDL_TRUE;
-                for (i = 0; i < event_watchers_count; ++i) {
-                    if (!SDL_event_watchers[i].removed) {
-                        SDL_event_watchers[i].callback(SDL_event_watchers[i].userdata, event);
-                    }
-                }
-                SDL_event_watchers_dispatching = SDL_FALSE;
-
-                if (SDL_event_watchers_removed) {
-                    for (i = SDL_event_watchers_count; i--; ) {
-                        if (SDL_event_watchers[i].removed) {
-                            --SDL_event_watchers_count;
-                            if (i < SDL_event_watchers_count) {
-                                SDL_memmove(&SDL_event_watchers[i], &SDL_event_watchers[i+1], (SDL_event_watchers_count - i) * sizeof(SDL_event_watchers[i]));
-                            }
-                        }
+/* Make a table current -- called with the watchers locked */
+static void
+SDL_PublishEventWatcherTable(SDL_EventWatcherTable *table, SDL_EventWatcher *removed)
+{
+    SDL_EventWatcherTable *old = (SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+
+    if (!table->filter && table->num_watchers == 0) {
+        /* Let events skip dispatching altogether */
+        SDL_free(table);
+        table = NULL;
+    }
+    SDL_AtomicSetPtr(&SDL_event_watchers_table, table);
+
+    if (old) {
+        old->removed = removed;
+        old->next_retired = SDL_event_watchers_retired;
+        SDL_event_watchers_retired = old;
+    } else {
+        SDL_free(removed);
+    }
+}
+
+/* Wait for any dispatch that could be using a retired table, and free them */
+static void
+SDL_SyncEventWatchers(void)
+{
+    SDL_EventWatcherTable *retired, *next;
+    int epoch;
+
+    if (SDL_IsDispatchingEvent()) {
+        /* We'd be waiting on ourselves, they'll be freed later */
+        return;
+    }
+
+    if (SDL_event_watchers_sync_lock) {
+        SDL_LockMutex(SDL_event_watchers_sync_lock);
+    }
+
+    if (SDL_event_watchers_lock) {
+        SDL_LockMutex(SDL_event_watchers_lock);
+    }
+    retired = SDL_event_watchers_retired;
+    SDL_event_watchers_retired = NULL;
+    if (SDL_event_watchers_lock) {
+        SDL_UnlockMutex(SDL_event_watchers_lock);
+    }
+
+    /* New dispatches count against the other epoch, so this one drains */
+    epoch = SDL_AtomicGet(&SDL_event_watchers_epoch);
+    SDL_AtomicSet(&SDL_event_watchers_epoch, !epoch);
+    while (SDL_AtomicGet(&SDL_event_watchers_readers[epoch]) > 0) {
+        SDL_Delay(0);
+    }
+
+    for ( ; retired; retired = next) {
+        next = retired->next_retired;
+        SDL_FreeEventWatcherTable(retired);
+    }
+
+    if (SDL_event_watchers_sync_lock) {
+        SDL_UnlockMutex(SDL_event_watchers_sync_lock);
+    }
+}
+
+/* Free the watchers when the event loop stops -- called with the queue locked */
+static void
+SDL_FreeEventWatchers(void)
+{
+    SDL_EventWatcherTable *table = (SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+    SDL_EventWatcherTable *next;
+    int i;
+
+    if (table) {
+        for (i = 0; i < table->num_watchers; ++i) {
+            SDL_free(table->watchers[i]);
+        }
+        SDL_free(table);
+        SDL_AtomicSetPtr(&SDL_event_watchers_table, NULL);
+    }
+
+    for (table = SDL_event_watchers_retired; table; table = next) {
+        next = table->next_retired;
+        SDL_FreeEventWatcherTable(table);
+    }
+    SDL_event_watchers_retired = NULL;
+}
+
+/* Run the filter and watchers, returns SDL_FALSE if the filter dropped the event */
+static SDL_bool
+SDL_DispatchEvent(SDL_Event * event)
+{
+    const int epoch = SDL_EnterEventWatchers();
+    const SDL_EventWatcherTable *table = (const SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+    SDL_bool keep = SDL_TRUE;
+
+    if (table) {
+        const int category = SDL_GetEventCategory(event->type);
+        const int end = table->category_start[category + 1];
+        int i = table->category_start[category];
+
+        if (table->filter || i < end) {
+            SDL_SetDispatchingEvent(1);
+            if (table->filter && !table->filter(table->filter_userdata, event)) {
+                keep = SDL_FALSE;
+            } else {
+                for ( ; i < end; ++i) {
+                    SDL_EventWatcher *watcher = table->category_watchers[i];
+                    if (watcher->minType <= event->type && event->type <= watcher->maxType &&
+                        !SDL_AtomicGet(&watcher->removed)) {
+                        watcher->callback(watcher->userdata, event);
                     }
-                    SDL_event_watchers_removed = SDL_FALSE;
                 }
             }
-
-            if (SDL_event_watchers_lock) {
-                SDL_UnlockMutex(SDL_event_watchers_lock);
-            }
+            SDL_SetDispatchingEvent(-1);
         }
     }
 
+    SDL_LeaveEventWatchers(epoch);
+    return keep;
+}
+
+int
+SDL_PushEvent(SDL_Event * event)
+{
+    event->common.timestamp = SDL_GetTicks();
+
+    if (SDL_AtomicGetPtr(&SDL_event_watchers_table) && !SDL_DispatchEvent(event)) {
+        return 0;
+    }
+
     if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
         return -1;
     }
@@ -772,81 +1337,113 @@ void
 SDL_SetEventFilter(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
-        /* Set filter and discard pending events */
-        SDL_EventOK.callback = filter;
-        SDL_EventOK.userdata = userdata;
-        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+        const SDL_EventWatcherTable *old = (const SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+        SDL_EventWatcherTable *table = SDL_CreateEventWatcherTable(filter, userdata, old, NULL, NULL);
+
+        if (table) {
+            /* Set filter and discard pending events */
+            SDL_PublishEventWatcherTable(table, NULL);
+            SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+        }
 
         if (SDL_event_watchers_lock) {
             SDL_UnlockMutex(SDL_event_watchers_lock);
         }
+
+        /* Make sure the old filter isn't still running */
+        SDL_SyncEventWatchers();
     }
 }
 
 SDL_bool
 SDL_GetEventFilter(SDL_EventFilter * filter, void **userdata)
 {
-    SDL_EventWatcher event_ok;
+    const int epoch = SDL_EnterEventWatchers();
+    const SDL_EventWatcherTable *table = (const SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+    SDL_EventFilter callback = table ? table->filter : NULL;
+    void *data = table ? table->filter_userdata : NULL;
 
-    if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
-        event_ok = SDL_EventOK;
-
-        if (SDL_event_watchers_lock) {
-            SDL_UnlockMutex(SDL_event_watchers_lock);
-        }
-    } else {
-        SDL_zero(event_ok);
-    }
+    SDL_LeaveEventWatchers(epoch);
 
     if (filter) {
-        *filter = event_ok.callback;
+        *filter = callback;
     }
     if (userdata) {
-        *userdata = event_ok.userdata;
+        *userdata = data;
     }
-    return event_ok.callback ? SDL_TRUE : SDL_FALSE;
+    return callback ? SDL_TRUE : SDL_FALSE;
 }
 
 void
 SDL_AddEventWatch(SDL_EventFilter filter, void *userdata)
 {
-    if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
-        SDL_EventWatcher *event_watchers;
+    SDL_AddEventWatchRange(filter, userdata, 0, 0xFFFFFFFF);
+}
+
+void
+SDL_AddEventWatchRange(SDL_EventFilter filter, void *userdata, Uint32 minType, Uint32 maxType)
+{
+    SDL_EventWatcher *watcher;
+
+    if (minType > maxType) {
+        return;
+    }
 
-        event_watchers = SDL_realloc(SDL_event_watchers, (SDL_event_watchers_count + 1) * sizeof(*event_watchers));
-        if (event_watchers) {
-            SDL_EventWatcher *watcher;
+    watcher = (SDL_EventWatcher *)SDL_calloc(1, sizeof(*watcher));
+    if (!watcher) {
+        SDL_OutOfMemory();
+        return;
+    }
+    watcher->callback = filter;
+    watcher->userdata = userdata;
+    watcher->minType = minType;
+    watcher->maxType = maxType;
+
+    if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
+        const SDL_EventWatcherTable *old = (const SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+        SDL_EventWatcherTable *table;
 
-            SDL_event_watchers = event_watchers;
-            watcher = &SDL_event_watchers[SDL_event_watchers_count];
-            watcher->callback = filter;
-            watcher->userdata = userdata;
-            watcher->removed = SDL_FALSE;
-            ++SDL_event_watchers_count;
+        if (old) {
+            table = SDL_CreateEventWatcherTable(old->filter, old->filter_userdata, old, watcher, NULL);
+        } else {
+            table = SDL_CreateEventWatcherTable(NULL, NULL, NULL, watcher, NULL);
+        }
+        if (table) {
+            SDL_PublishEventWatcherTable(table, NULL);
+        } else {
+            SDL_free(watcher);
         }
 
         if (SDL_event_watchers_lock) {
             SDL_UnlockMutex(SDL_event_watchers_lock);
         }
+    } else {
+        SDL_free(watcher);
     }
 }
 
 void
 SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
 {
+    SDL_bool removed = SDL_FALSE;
+
     if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
+        const SDL_EventWatcherTable *old = (const SDL_EventWatcherTable *)SDL_AtomicGetPtr(&SDL_event_watchers_table);
+        SDL_EventWatcherTable *table;
         int i;
 
-        for (i = 0; i < SDL_event_watchers_count; ++i) {
-            if (SDL_event_watchers[i].callback == filter && SDL_event_watchers[i].userdata == userdata) {
-                if (SDL_event_watchers_dispatching) {
-                    SDL_event_watchers[i].removed = SDL_TRUE;
-                    SDL_event_watchers_removed = SDL_TRUE;
-                } else {
-                    --SDL_event_watchers_count;
-                    if (i < SDL_event_watchers_count) {
-                        SDL_memmove(&SDL_event_watchers[i], &SDL_event_watchers[i+1], (SDL_event_watchers_count - i) * sizeof(SDL_event_watchers[i]));
-                    }
+        for (i = 0; old && i < old->num_watchers; ++i) {
+            SDL_EventWatcher *watcher = old->watchers[i];
+            if (watcher->callback == filter && watcher->userdata == userdata &&
+                !SDL_AtomicGet(&watcher->removed)) {
+                /* Dispatches in progress skip it from now on */
+                SDL_AtomicSet(&watcher->removed, 1);
+                removed = SDL_TRUE;
+
+                /* If this fails it stays in the table until the event loop stops */
+                table = SDL_CreateEventWatcherTable(old->filter, old->filter_userdata, old, NULL, watcher);
+                if (table) {
+                    SDL_PublishEventWatcherTable(table, watcher);
                 }
                 break;
             }
@@ -856,17 +1453,35 @@ SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
             SDL_UnlockMutex(SDL_event_watchers_lock);
         }
     }
+
+    if (removed) {
+        /* Make sure the watcher isn't still running, the caller may free its userdata */
+        SDL_SyncEventWatchers();
+    }
 }
 
 void
 SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        SDL_EventEntry *entry, *next;
+        SDL_EventEntry *entry, *next, *prev;
+        int category;
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
                 SDL_CutEvent(entry);
+                continue;
+            }
+
+            /* If the filter changed the event type, move it to its new category,
+               after the closest earlier event there -- those are already sorted */
+            category = SDL_GetEventCategory(entry->event.type);
+            if (category != entry->category) {
+                for (prev = entry->prev; prev && prev->category != category; prev = prev->prev) {
+                    continue;
+                }
+                SDL_UnlinkEventCategory(entry);
+                SDL_LinkEventCategory(entry, category, prev);
             }
         }
         if (SDL_EventQ.lock) {
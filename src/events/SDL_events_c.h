@@ -53,6 +53,15 @@ extern void SDL_QuitQuit(void);
 
 extern void SDL_SendPendingQuit(void);
 
+/* The clock used for event timestamps, SDL_GetPerformanceCounter() in nanoseconds */
+extern Uint64 SDL_GetEventTimeNS(void);
+
+/* Sets the hardware time of the events the calling thread sends next, or 0 to
+   use the time they're queued */
+extern void SDL_SetEventHardwareTime(Uint64 timestamp);
+/* Gets the hardware time set by the calling thread, or 0 */
+extern Uint64 SDL_GetEventHardwareTime(void);
+
 #endif /* SDL_events_c_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,878 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Asynchronous file I/O.
+
+   Every read, write and close is a task. Tasks on regular files are handed
+   to the kernel with io_uring when it's available, anything else runs on a
+   small pool of worker threads using the SDL_RWops file backends. Finished
+   tasks are added to the queue given when they were started, or sent as
+   SDL_ASYNCIOCOMPLETE events.
+*/
+
+#include "SDL_asyncio.h"
+#include "SDL_atomic.h"
+#include "SDL_events.h"
+#include "SDL_rwops.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_asyncio_c.h"
+#include "../thread/SDL_systhread.h"
+
+#if defined(__LINUX__) && defined(HAVE_LINUX_IO_URING_H) && defined(HAVE_STDIO_H) && !SDL_THREADS_DISABLED
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#ifdef __NR_io_uring_setup
+#define SDL_ASYNCIO_IO_URING 1
+#endif
+#endif
+
+#define MAX_WORKER_THREADS  8
+
+typedef struct SDL_AsyncIOTask
+{
+    SDL_AsyncIO *asyncio;
+    SDL_AsyncIOQueue *queue;
+    SDL_AsyncIOOutcome outcome;
+#ifdef SDL_ASYNCIO_IO_URING
+    struct iovec iov;
+#endif
+    struct SDL_AsyncIOTask *next;
+} SDL_AsyncIOTask;
+
+struct SDL_AsyncIO
+{
+    SDL_RWops *rwops;
+    SDL_mutex *lock;        /* Tasks on the worker threads share the stream position */
+    int fd;                 /* Tasks go to io_uring if this isn't -1 */
+    SDL_atomic_t pending;   /* Tasks that were started and haven't finished */
+    SDL_atomic_t closing;
+    void *close_task;       /* Started once there's nothing pending */
+};
+
+struct SDL_AsyncIOQueue
+{
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    SDL_AsyncIOTask *head;
+    SDL_AsyncIOTask *tail;
+    int pending;            /* Tasks that will finish into this queue */
+};
+
+/* The worker threads */
+static struct
+{
+    SDL_SpinLock init_lock;
+    SDL_bool initialized;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    SDL_AsyncIOTask *head;
+    SDL_AsyncIOTask *tail;
+    int queued;
+    SDL_Thread *threads[MAX_WORKER_THREADS];
+    int num_threads;
+    int idle_threads;
+    SDL_bool shutdown;
+} SDL_AsyncIOPool;
+
+static void SDL_FinishAsyncIOTask(SDL_AsyncIOTask *task);
+
+
+/* Run a task on the calling thread, picking up where io_uring left off */
+static void
+SDL_RunAsyncIOTask(SDL_AsyncIOTask *task)
+{
+    SDL_AsyncIO *asyncio = task->asyncio;
+    SDL_AsyncIOOutcome *outcome = &task->outcome;
+    Uint8 *ptr = (Uint8 *) outcome->buffer;
+    size_t amount;
+
+    if (outcome->type == SDL_ASYNCIO_TASK_CLOSE) {
+        if (SDL_RWclose(asyncio->rwops) < 0) {
+            outcome->result = SDL_ASYNCIO_FAILURE;
+        }
+        SDL_DestroyMutex(asyncio->lock);
+        SDL_free(asyncio);
+        return;
+    }
+
+#ifdef SDL_ASYNCIO_IO_URING
+    if (asyncio->fd >= 0) {
+        /* Stay clear of the stdio buffer, io_uring doesn't see it */
+        ssize_t result;
+
+        while (outcome->bytes_transferred < outcome->bytes_requested) {
+            amount = (size_t) (outcome->bytes_requested - outcome->bytes_transferred);
+            if (outcome->type == SDL_ASYNCIO_TASK_READ) {
+                result = pread(asyncio->fd, ptr + outcome->bytes_transferred, amount,
+                               (off_t) (outcome->offset + outcome->bytes_transferred));
+            } else {
+                result = pwrite(asyncio->fd, ptr + outcome->bytes_transferred, amount,
+                                (off_t) (outcome->offset + outcome->bytes_transferred));
+            }
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 || (result == 0 && outcome->type == SDL_ASYNCIO_TASK_WRITE)) {
+                outcome->result = SDL_ASYNCIO_FAILURE;
+                break;
+            }
+            if (result == 0) {
+                /* End of file */
+                break;
+            }
+            outcome->bytes_transferred += result;
+        }
+        return;
+    }
+#endif
+
+    SDL_LockMutex(asyncio->lock);
+    if (SDL_RWseek(asyncio->rwops, (Sint64) (outcome->offset + outcome->bytes_transferred), RW_SEEK_SET) < 0) {
+        outcome->result = SDL_ASYNCIO_FAILURE;
+    } else {
+        while (outcome->bytes_transferred < outcome->bytes_requested) {
+            amount = (size_t) (outcome->bytes_requested - outcome->bytes_transferred);
+            if (outcome->type == SDL_ASYNCIO_TASK_READ) {
+                amount = SDL_RWread(asyncio->rwops, ptr + outcome->bytes_transferred, 1, amount);
+                if (amount == 0) {
+                    /* End of file */
+                    break;
+                }
+            } else {
+                amount = SDL_RWwrite(asyncio->rwops, ptr + outcome->bytes_transferred, 1, amount);
+                if (amount == 0) {
+                    outcome->result = SDL_ASYNCIO_FAILURE;
+                    break;
+                }
+            }
+            outcome->bytes_transferred += amount;
+        }
+    }
+    SDL_UnlockMutex(asyncio->lock);
+}
+
+static int SDLCALL
+SDL_AsyncIOWorker(void *unused)
+{
+    SDL_AsyncIOTask *task;
+
+    SDL_LockMutex(SDL_AsyncIOPool.lock);
+    for ( ; ; ) {
+        while (!SDL_AsyncIOPool.head && !SDL_AsyncIOPool.shutdown) {
+            SDL_CondWait(SDL_AsyncIOPool.cond, SDL_AsyncIOPool.lock);
+        }
+        task = SDL_AsyncIOPool.head;
+        if (!task) {
+            /* Shutting down and the queue has been drained */
+            break;
+        }
+        SDL_AsyncIOPool.head = task->next;
+        if (!SDL_AsyncIOPool.head) {
+            SDL_AsyncIOPool.tail = NULL;
+        }
+        --SDL_AsyncIOPool.queued;
+        --SDL_AsyncIOPool.idle_threads;
+        SDL_UnlockMutex(SDL_AsyncIOPool.lock);
+
+        SDL_RunAsyncIOTask(task);
+        SDL_FinishAsyncIOTask(task);
+
+        SDL_LockMutex(SDL_AsyncIOPool.lock);
+        ++SDL_AsyncIOPool.idle_threads;
+    }
+    SDL_UnlockMutex(SDL_AsyncIOPool.lock);
+    return 0;
+}
+
+/* Hand a task to the worker threads */
+static void
+SDL_QueueAsyncIOTask(SDL_AsyncIOTask *task)
+{
+    SDL_Thread *thread;
+    SDL_bool run_now = SDL_FALSE;
+
+    task->next = NULL;
+
+    SDL_LockMutex(SDL_AsyncIOPool.lock);
+    if (SDL_AsyncIOPool.queued >= SDL_AsyncIOPool.idle_threads &&
+        SDL_AsyncIOPool.num_threads < MAX_WORKER_THREADS) {
+        thread = SDL_CreateThreadInternal(SDL_AsyncIOWorker, "SDLAsyncIO", 0, NULL);
+        if (thread) {
+            SDL_AsyncIOPool.threads[SDL_AsyncIOPool.num_threads++] = thread;
+            ++SDL_AsyncIOPool.idle_threads;
+        }
+    }
+    if (SDL_AsyncIOPool.num_threads == 0) {
+        /* No threads available, just do it now */
+        run_now = SDL_TRUE;
+    } else {
+        if (SDL_AsyncIOPool.tail) {
+            SDL_AsyncIOPool.tail->next = task;
+        } else {
+            SDL_AsyncIOPool.head = task;
+        }
+        SDL_AsyncIOPool.tail = task;
+        ++SDL_AsyncIOPool.queued;
+        SDL_CondSignal(SDL_AsyncIOPool.cond);
+    }
+    SDL_UnlockMutex(SDL_AsyncIOPool.lock);
+
+    if (run_now) {
+        SDL_RunAsyncIOTask(task);
+        SDL_FinishAsyncIOTask(task);
+    }
+}
+
+
+#ifdef SDL_ASYNCIO_IO_URING
+
+/* Only the first io_uring features are used, so this works on any kernel
+   that has it. Completions are collected by a thread of their own. */
+static struct
+{
+    int fd;
+    SDL_mutex *lock;        /* Serializes submissions */
+    volatile unsigned *sq_head;
+    volatile unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    volatile unsigned *cq_head;
+    volatile unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned cq_entries;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    SDL_atomic_t in_flight;
+    SDL_Thread *thread;
+} SDL_AsyncIOUring;
+
+static int
+uring_setup(unsigned entries, struct io_uring_params *params)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int
+uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int) syscall(__NR_io_uring_enter, SDL_AsyncIOUring.fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* Submit a task, or a wakeup for the completion thread if it's NULL */
+static SDL_bool
+SDL_SubmitIOUring(SDL_AsyncIOTask *task)
+{
+    SDL_AsyncIOOutcome *outcome;
+    struct io_uring_sqe *sqe;
+    unsigned tail, index;
+    Uint64 remaining;
+    int result;
+
+    SDL_LockMutex(SDL_AsyncIOUring.lock);
+
+    /* Don't start more than the completion ring can hold */
+    if (task && (unsigned) SDL_AtomicGet(&SDL_AsyncIOUring.in_flight) >= SDL_AsyncIOUring.cq_entries) {
+        SDL_UnlockMutex(SDL_AsyncIOUring.lock);
+        return SDL_FALSE;
+    }
+
+    tail = *SDL_AsyncIOUring.sq_tail;
+    index = tail & *SDL_AsyncIOUring.sq_mask;
+    sqe = &SDL_AsyncIOUring.sqes[index];
+    SDL_zerop(sqe);
+    if (task) {
+        outcome = &task->outcome;
+        remaining = outcome->bytes_requested - outcome->bytes_transferred;
+        task->iov.iov_base = (Uint8 *) outcome->buffer + outcome->bytes_transferred;
+        task->iov.iov_len = (size_t) SDL_min(remaining, 0x40000000);
+        sqe->opcode = (outcome->type == SDL_ASYNCIO_TASK_READ) ? IORING_OP_READV : IORING_OP_WRITEV;
+        sqe->fd = task->asyncio->fd;
+        sqe->off = outcome->offset + outcome->bytes_transferred;
+        sqe->addr = (Uint64) (uintptr_t) &task->iov;
+        sqe->len = 1;
+        sqe->user_data = (Uint64) (uintptr_t) task;
+        SDL_AtomicIncRef(&SDL_AsyncIOUring.in_flight);
+    } else {
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = 0;
+    }
+    SDL_AsyncIOUring.sq_array[index] = index;
+    SDL_MemoryBarrierRelease();
+    *SDL_AsyncIOUring.sq_tail = tail + 1;
+
+    do {
+        result = uring_enter(1, 0, 0);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 1) {
+        /* The kernel didn't take it, so it's still ours to take back */
+        *SDL_AsyncIOUring.sq_tail = tail;
+        if (task) {
+            SDL_AtomicAdd(&SDL_AsyncIOUring.in_flight, -1);
+        }
+    }
+    SDL_UnlockMutex(SDL_AsyncIOUring.lock);
+
+    return (result == 1) ? SDL_TRUE : SDL_FALSE;
+}
+
+static int SDLCALL
+SDL_IOUringCompletions(void *unused)
+{
+    struct io_uring_cqe *cqe;
+    SDL_AsyncIOTask *task;
+    SDL_AsyncIOOutcome *outcome;
+    SDL_bool quit = SDL_FALSE;
+    unsigned head, tail;
+    int result;
+
+    while (!quit || SDL_AtomicGet(&SDL_AsyncIOUring.in_flight) > 0) {
+        head = *SDL_AsyncIOUring.cq_head;
+        tail = *SDL_AsyncIOUring.cq_tail;
+        SDL_MemoryBarrierAcquire();
+        if (head == tail) {
+            uring_enter(0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+
+        while (head != tail) {
+            cqe = &SDL_AsyncIOUring.cqes[head & *SDL_AsyncIOUring.cq_mask];
+            task = (SDL_AsyncIOTask *) (uintptr_t) cqe->user_data;
+            result = cqe->res;
+            ++head;
+
+            /* Give the entry back before anything is resubmitted */
+            SDL_MemoryBarrierRelease();
+            *SDL_AsyncIOUring.cq_head = head;
+
+            if (!task) {
+                quit = SDL_TRUE;
+                continue;
+            }
+            SDL_AtomicAdd(&SDL_AsyncIOUring.in_flight, -1);
+
+            outcome = &task->outcome;
+            if (result < 0) {
+                outcome->result = SDL_ASYNCIO_FAILURE;
+            } else if (result == 0) {
+                if (outcome->type == SDL_ASYNCIO_TASK_WRITE) {
+                    outcome->result = SDL_ASYNCIO_FAILURE;
+                }
+            } else {
+                outcome->bytes_transferred += result;
+                if (outcome->bytes_transferred < outcome->bytes_requested) {
+                    /* Short transfer, start on the rest */
+                    if (!SDL_SubmitIOUring(task)) {
+                        SDL_QueueAsyncIOTask(task);
+                    }
+                    continue;
+                }
+            }
+            SDL_FinishAsyncIOTask(task);
+        }
+    }
+    return 0;
+}
+
+static void
+SDL_QuitIOUring(void)
+{
+    if (SDL_AsyncIOUring.thread) {
+        while (!SDL_SubmitIOUring(NULL)) {
+            SDL_Delay(1);
+        }
+        SDL_WaitThread(SDL_AsyncIOUring.thread, NULL);
+    }
+    if (SDL_AsyncIOUring.sqes) {
+        munmap(SDL_AsyncIOUring.sqes, SDL_AsyncIOUring.sqes_size);
+    }
+    if (SDL_AsyncIOUring.cq_ring) {
+        munmap(SDL_AsyncIOUring.cq_ring, SDL_AsyncIOUring.cq_ring_size);
+    }
+    if (SDL_AsyncIOUring.sq_ring) {
+        munmap(SDL_AsyncIOUring.sq_ring, SDL_AsyncIOUring.sq_ring_size);
+    }
+    if (SDL_AsyncIOUring.lock) {
+        SDL_DestroyMutex(SDL_AsyncIOUring.lock);
+    }
+    if (SDL_AsyncIOUring.fd >= 0) {
+        close(SDL_AsyncIOUring.fd);
+    }
+    SDL_zero(SDL_AsyncIOUring);
+    SDL_AsyncIOUring.fd = -1;
+}
+
+static void
+SDL_InitIOUring(void)
+{
+    struct io_uring_params params;
+    Uint8 *sq_ring, *cq_ring;
+    void *addr;
+
+    SDL_zero(SDL_AsyncIOUring);
+    SDL_zero(params);
+    SDL_AsyncIOUring.fd = uring_setup(64, &params);
+    if (SDL_AsyncIOUring.fd < 0) {
+        /* Not supported by this kernel, or not allowed */
+        return;
+    }
+
+    SDL_AsyncIOUring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    addr = mmap(NULL, SDL_AsyncIOUring.sq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, SDL_AsyncIOUring.fd, IORING_OFF_SQ_RING);
+    if (addr == MAP_FAILED) {
+        SDL_QuitIOUring();
+        return;
+    }
+    SDL_AsyncIOUring.sq_ring = addr;
+
+    SDL_AsyncIOUring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    addr = mmap(NULL, SDL_AsyncIOUring.cq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, SDL_AsyncIOUring.fd, IORING_OFF_CQ_RING);
+    if (addr == MAP_FAILED) {
+        SDL_QuitIOUring();
+        return;
+    }
+    SDL_AsyncIOUring.cq_ring = addr;
+
+    SDL_AsyncIOUring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    addr = mmap(NULL, SDL_AsyncIOUring.sqes_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, SDL_AsyncIOUring.fd, IORING_OFF_SQES);
+    if (addr == MAP_FAILED) {
+        SDL_QuitIOUring();
+        return;
+    }
+    SDL_AsyncIOUring.sqes = (struct io_uring_sqe *) addr;
+
+    sq_ring = (Uint8 *) SDL_AsyncIOUring.sq_ring;
+    SDL_AsyncIOUring.sq_head = (unsigned *) (sq_ring + params.sq_off.head);
+    SDL_AsyncIOUring.sq_tail = (unsigned *) (sq_ring + params.sq_off.tail);
+    SDL_AsyncIOUring.sq_mask = (unsigned *) (sq_ring + params.sq_off.ring_mask);
+    SDL_AsyncIOUring.sq_array = (unsigned *) (sq_ring + params.sq_off.array);
+    cq_ring = (Uint8 *) SDL_AsyncIOUring.cq_ring;
+    SDL_AsyncIOUring.cq_head = (unsigned *) (cq_ring + params.cq_off.head);
+    SDL_AsyncIOUring.cq_tail = (unsigned *) (cq_ring + params.cq_off.tail);
+    SDL_AsyncIOUring.cq_mask = (unsigned *) (cq_ring + params.cq_off.ring_mask);
+    SDL_AsyncIOUring.cqes = (struct io_uring_cqe *) (cq_ring + params.cq_off.cqes);
+    SDL_AsyncIOUring.cq_entries = params.cq_entries;
+
+    SDL_AsyncIOUring.lock = SDL_CreateMutex();
+    if (!SDL_AsyncIOUring.lock) {
+        SDL_QuitIOUring();
+        return;
+    }
+    SDL_AsyncIOUring.thread = SDL_CreateThreadInternal(SDL_IOUringCompletions, "SDLAsyncIOUring", 0, NULL);
+    if (!SDL_AsyncIOUring.thread) {
+        SDL_QuitIOUring();
+        return;
+    }
+}
+
+#endif /* SDL_ASYNCIO_IO_URING */
+
+
+/* Whoever drops the last pending task starts the close, if one is waiting */
+static void
+SDL_ReleaseAsyncIOPending(SDL_AsyncIO *asyncio)
+{
+    SDL_AsyncIOTask *close_task;
+
+    if (SDL_AtomicDecRef(&asyncio->pending)) {
+        close_task = (SDL_AsyncIOTask *) SDL_AtomicGetPtr(&asyncio->close_task);
+        if (close_task && SDL_AtomicCASPtr(&asyncio->close_task, close_task, NULL)) {
+            SDL_QueueAsyncIOTask(close_task);
+        }
+    }
+}
+
+/* Report the outcome of a task and start a close that was waiting on it */
+static void
+SDL_FinishAsyncIOTask(SDL_AsyncIOTask *task)
+{
+    SDL_AsyncIO *asyncio = task->asyncio;
+    SDL_AsyncIOQueue *queue = task->queue;
+    SDL_bool closed = (task->outcome.type == SDL_ASYNCIO_TASK_CLOSE);
+    SDL_Event event;
+
+    if (queue) {
+        task->next = NULL;
+        SDL_LockMutex(queue->lock);
+        if (queue->tail) {
+            queue->tail->next = task;
+        } else {
+            queue->head = task;
+        }
+        queue->tail = task;
+        --queue->pending;
+        SDL_CondBroadcast(queue->cond);
+        SDL_UnlockMutex(queue->lock);
+    } else {
+        if (SDL_GetEventState(SDL_ASYNCIOCOMPLETE) == SDL_ENABLE) {
+            SDL_zero(event);
+            event.asyncio.type = SDL_ASYNCIOCOMPLETE;
+            event.asyncio.task = task->outcome.type;
+            event.asyncio.result = task->outcome.result;
+            event.asyncio.asyncio = task->outcome.asyncio;
+            event.asyncio.buffer = task->outcome.buffer;
+            event.asyncio.bytes_transferred = task->outcome.bytes_transferred;
+            event.asyncio.userdata = task->outcome.userdata;
+            SDL_PushEvent(&event);
+        }
+        SDL_free(task);
+    }
+
+    if (!closed) {
+        SDL_ReleaseAsyncIOPending(asyncio);
+    }
+}
+
+static int
+SDL_InitAsyncIO(void)
+{
+    int retval = 0;
+
+    SDL_AtomicLock(&SDL_AsyncIOPool.init_lock);
+    if (!SDL_AsyncIOPool.initialized) {
+        SDL_AsyncIOPool.lock = SDL_CreateMutex();
+        SDL_AsyncIOPool.cond = SDL_CreateCond();
+        if (!SDL_AsyncIOPool.lock || !SDL_AsyncIOPool.cond) {
+            if (SDL_AsyncIOPool.lock) {
+                SDL_DestroyMutex(SDL_AsyncIOPool.lock);
+                SDL_AsyncIOPool.lock = NULL;
+            }
+            if (SDL_AsyncIOPool.cond) {
+                SDL_DestroyCond(SDL_AsyncIOPool.cond);
+                SDL_AsyncIOPool.cond = NULL;
+            }
+            retval = -1;
+        } else {
+#ifdef SDL_ASYNCIO_IO_URING
+            SDL_InitIOUring();
+#endif
+            SDL_AsyncIOPool.initialized = SDL_TRUE;
+        }
+    }
+    SDL_AtomicUnlock(&SDL_AsyncIOPool.init_lock);
+
+    return retval;
+}
+
+void
+SDL_QuitAsyncIO(void)
+{
+    int i;
+
+    if (!SDL_AsyncIOPool.initialized) {
+        return;
+    }
+
+#ifdef SDL_ASYNCIO_IO_URING
+    /* This can still hand tasks to the worker threads, so it goes first */
+    SDL_QuitIOUring();
+#endif
+
+    SDL_LockMutex(SDL_AsyncIOPool.lock);
+    SDL_AsyncIOPool.shutdown = SDL_TRUE;
+    SDL_CondBroadcast(SDL_AsyncIOPool.cond);
+    SDL_UnlockMutex(SDL_AsyncIOPool.lock);
+    for (i = 0; i < SDL_AsyncIOPool.num_threads; ++i) {
+        SDL_WaitThread(SDL_AsyncIOPool.threads[i], NULL);
+    }
+
+    SDL_DestroyCond(SDL_AsyncIOPool.cond);
+    SDL_DestroyMutex(SDL_AsyncIOPool.lock);
+    SDL_zero(SDL_AsyncIOPool);
+}
+
+static int
+SDL_StartAsyncIOTask(SDL_AsyncIO *asyncio, SDL_AsyncIOTaskType type,
+                     void *ptr, Uint64 offset, Uint64 size,
+                     SDL_AsyncIOQueue *queue, void *userdata)
+{
+    SDL_AsyncIOTask *task;
+
+    if (!asyncio) {
+        return SDL_InvalidParamError("asyncio");
+    }
+    if (!ptr && size > 0) {
+        return SDL_InvalidParamError("ptr");
+    }
+    if ((Uint64) (size_t) size != size) {
+        return SDL_SetError("Can't transfer that much data at once");
+    }
+
+    task = (SDL_AsyncIOTask *) SDL_calloc(1, sizeof(*task));
+    if (!task) {
+        return SDL_OutOfMemory();
+    }
+    task->asyncio = asyncio;
+    task->queue = queue;
+    task->outcome.asyncio = asyncio;
+    task->outcome.type = type;
+    task->outcome.result = SDL_ASYNCIO_COMPLETE;
+    task->outcome.buffer = ptr;
+    task->outcome.offset = offset;
+    task->outcome.bytes_requested = size;
+    task->outcome.userdata = userdata;
+
+    /* Count the task before checking, so a close can't miss it */
+    SDL_AtomicIncRef(&asyncio->pending);
+    if (SDL_AtomicGet(&asyncio->closing)) {
+        SDL_ReleaseAsyncIOPending(asyncio);
+        SDL_free(task);
+        return SDL_SetError("The file is being closed");
+    }
+    if (queue) {
+        SDL_LockMutex(queue->lock);
+        ++queue->pending;
+        SDL_UnlockMutex(queue->lock);
+    }
+
+#ifdef SDL_ASYNCIO_IO_URING
+    if (asyncio->fd >= 0 && size > 0 && SDL_SubmitIOUring(task)) {
+        return 0;
+    }
+#endif
+    SDL_QueueAsyncIOTask(task);
+    return 0;
+}
+
+
+/* Public functions */
+
+SDL_AsyncIO *
+SDL_AsyncIOFromFile(const char *file, const char *mode)
+{
+    SDL_AsyncIO *asyncio;
+
+    if (SDL_InitAsyncIO() < 0) {
+        return NULL;
+    }
+
+    asyncio = (SDL_AsyncIO *) SDL_calloc(1, sizeof(*asyncio));
+    if (!asyncio) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    asyncio->rwops = SDL_RWFromFile(file, mode);
+    if (!asyncio->rwops) {
+        SDL_free(asyncio);
+        return NULL;
+    }
+    asyncio->lock = SDL_CreateMutex();
+    if (!asyncio->lock) {
+        SDL_RWclose(asyncio->rwops);
+        SDL_free(asyncio);
+        return NULL;
+    }
+
+    asyncio->fd = -1;
+#ifdef SDL_ASYNCIO_IO_URING
+    if (SDL_AsyncIOUring.thread && asyncio->rwops->type == SDL_RWOPS_STDFILE) {
+        /* Nothing else touches the stream, so its buffering doesn't matter */
+        asyncio->fd = fileno((FILE *) asyncio->rwops->hidden.stdio.fp);
+    }
+#endif
+    return asyncio;
+}
+
+Sint64
+SDL_AsyncIOSize(SDL_AsyncIO *asyncio)
+{
+    Sint64 size;
+
+    if (!asyncio) {
+        return SDL_InvalidParamError("asyncio");
+    }
+    SDL_LockMutex(asyncio->lock);
+    size = SDL_RWsize(asyncio->rwops);
+    SDL_UnlockMutex(asyncio->lock);
+    return size;
+}
+
+int
+SDL_ReadAsyncIO(SDL_AsyncIO *asyncio, void *ptr, Uint64 offset, Uint64 size,
+                SDL_AsyncIOQueue *queue, void *userdata)
+{
+    return SDL_StartAsyncIOTask(asyncio, SDL_ASYNCIO_TASK_READ, ptr, offset, size, queue, userdata);
+}
+
+int
+SDL_WriteAsyncIO(SDL_AsyncIO *asyncio, const void *ptr, Uint64 offset, Uint64 size,
+                 SDL_AsyncIOQueue *queue, void *userdata)
+{
+    return SDL_StartAsyncIOTask(asyncio, SDL_ASYNCIO_TASK_WRITE, (void *) ptr, offset, size, queue, userdata);
+}
+
+int
+SDL_CloseAsyncIO(SDL_AsyncIO *asyncio, SDL_AsyncIOQueue *queue, void *userdata)
+{
+    SDL_AsyncIOTask *task;
+
+    if (!asyncio) {
+        return SDL_InvalidParamError("asyncio");
+    }
+    if (!SDL_AtomicCAS(&asyncio->closing, 0, 1)) {
+        return SDL_SetError("The file is already being closed");
+    }
+
+    task = (SDL_AsyncIOTask *) SDL_calloc(1, sizeof(*task));
+    if (!task) {
+        SDL_AtomicSet(&asyncio->closing, 0);
+        return SDL_OutOfMemory();
+    }
+    task->asyncio = asyncio;
+    task->queue = queue;
+    task->outcome.asyncio = asyncio;
+    task->outcome.type = SDL_ASYNCIO_TASK_CLOSE;
+    task->outcome.result = SDL_ASYNCIO_COMPLETE;
+    task->outcome.userdata = userdata;
+
+    if (queue) {
+        SDL_LockMutex(queue->lock);
+        ++queue->pending;
+        SDL_UnlockMutex(queue->lock);
+    }
+
+    /* Whoever sees the last pending task finish starts the close */
+    SDL_AtomicSetPtr(&asyncio->close_task, task);
+    if (SDL_AtomicGet(&asyncio->pending) == 0 &&
+        SDL_AtomicCASPtr(&asyncio->close_task, task, NULL)) {
+        SDL_QueueAsyncIOTask(task);
+    }
+    return 0;
+}
+
+SDL_AsyncIOQueue *
+SDL_CreateAsyncIOQueue(void)
+{
+    SDL_AsyncIOQueue *queue;
+
+    queue = (SDL_AsyncIOQueue *) SDL_calloc(1, sizeof(*queue));
+    if (!queue) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    queue->lock = SDL_CreateMutex();
+    queue->cond = SDL_CreateCond();
+    if (!queue->lock || !queue->cond) {
+        SDL_DestroyAsyncIOQueue(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+void
+SDL_DestroyAsyncIOQueue(SDL_AsyncIOQueue *queue)
+{
+    SDL_AsyncIOTask *task;
+
+    if (!queue) {
+        return;
+    }
+
+    if (queue->lock && queue->cond) {
+        SDL_LockMutex(queue->lock);
+        while (queue->pending > 0) {
+            SDL_CondWait(queue->cond, queue->lock);
+        }
+        SDL_UnlockMutex(queue->lock);
+    }
+    while (queue->head) {
+        task = queue->head;
+        queue->head = task->next;
+        SDL_free(task);
+    }
+    if (queue->cond) {
+        SDL_DestroyCond(queue->cond);
+    }
+    if (queue->lock) {
+        SDL_DestroyMutex(queue->lock);
+    }
+    SDL_free(queue);
+}
+
+SDL_bool
+SDL_GetAsyncIOResult(SDL_AsyncIOQueue *queue, SDL_AsyncIOOutcome *outcome)
+{
+    return SDL_WaitAsyncIOResult(queue, outcome, 0);
+}
+
+SDL_bool
+SDL_WaitAsyncIOResult(SDL_AsyncIOQueue *queue, SDL_AsyncIOOutcome *outcome, int timeout)
+{
+    SDL_AsyncIOTask *task;
+    Uint32 now, deadline;
+
+    if (!queue) {
+        SDL_InvalidParamError("queue");
+        return SDL_FALSE;
+    }
+    if (!outcome) {
+        SDL_InvalidParamError("outcome");
+        return SDL_FALSE;
+    }
+
+    SDL_LockMutex(queue->lock);
+    if (timeout < 0) {
+        while (!queue->head && queue->pending > 0) {
+            SDL_CondWait(queue->cond, queue->lock);
+        }
+    } else if (timeout > 0) {
+        deadline = SDL_GetTicks() + timeout;
+        while (!queue->head && queue->pending > 0) {
+            now = SDL_GetTicks();
+            if (SDL_TICKS_PASSED(now, deadline)) {
+                break;
+            }
+            SDL_CondWaitTimeout(queue->cond, queue->lock, deadline - now);
+        }
+    }
+    task = queue->head;
+    if (task) {
+        queue->head = task->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+    }
+    SDL_UnlockMutex(queue->lock);
+
+    if (!task) {
+        return SDL_FALSE;
+    }
+    *outcome = task->outcome;
+    SDL_free(task);
+    return SDL_TRUE;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -40,6 +40,13 @@
 #include <limits.h>
 #endif
 
+#if defined(HAVE_MMAP) && defined(HAVE_STDIO_H) && !defined(__WIN32__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#define SDL_RWOPS_MMAP 1
+#endif
+
 /* This file provides a general interface for SDL to read and write
    data sources.  It can easily be extended to files, memory, etc.
 */
@@ -504,6 +511,297 @@ mem_close(SDL_RWops * context)
     return 0;
 }
 
+/* Functions to map files into memory */
+
+static Uint8 mapped_empty[1];
+
+static void
+unmap_file(Uint8 * base, size_t size)
+{
+    if (base != mapped_empty) {
+#if defined(__WIN32__)
+        UnmapViewOfFile(base);
+#elif defined(SDL_RWOPS_MMAP)
+        munmap(base, size);
+#endif
+    }
+}
+
+static int SDLCALL
+mapped_close(SDL_RWops * context)
+{
+    if (context) {
+        unmap_file(context->hidden.mem.base,
+                   (size_t)(context->hidden.mem.stop - context->hidden.mem.base));
+        SDL_FreeRW(context);
+    }
+    return 0;
+}
+
+/* Map the whole file behind an open file stream, returns 0 on success */
+static int
+map_file(SDL_RWops * file, Uint8 ** base, size_t * size)
+{
+#if defined(__WIN32__)
+    HANDLE mapping;
+    LARGE_INTEGER filesize;
+
+    if (file->type != SDL_RWOPS_WINFILE ||
+        !GetFileSizeEx(file->hidden.windowsio.h, &filesize) ||
+        (Uint64) filesize.QuadPart > (Uint64) ((size_t) -1)) {
+        return -1;
+    }
+    *size = (size_t) filesize.QuadPart;
+    if (*size == 0) {
+        *base = mapped_empty;
+        return 0;
+    }
+    mapping = CreateFileMapping(file->hidden.windowsio.h, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return -1;
+    }
+    *base = (Uint8 *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    /* The view keeps the mapping alive */
+    CloseHandle(mapping);
+    return (*base != NULL) ? 0 : -1;
+#elif defined(SDL_RWOPS_MMAP)
+    struct stat st;
+    void *addr;
+    int fd;
+
+    if (file->type != SDL_RWOPS_STDFILE) {
+        return -1;
+    }
+    fd = fileno(file->hidden.stdio.fp);
+    if (fd < 0 || fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+        (Uint64) st.st_size > (Uint64) ((size_t) -1)) {
+        return -1;
+    }
+    *size = (size_t) st.st_size;
+    if (*size == 0) {
+        *base = mapped_empty;
+        return 0;
+    }
+    addr = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+    *base = (Uint8 *) addr;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+
+/* Functions to buffer small reads and writes on another stream */
+
+#define DEFAULT_BUFFER_SIZE 4096
+
+typedef struct
+{
+    SDL_RWops *src;
+    int freesrc;
+    Sint64 position;    /* Position of the source stream, or -1 if unknown */
+    Uint8 *data;
+    size_t size;
+    size_t here;        /* Read position in the data that was read ahead */
+    size_t stop;        /* Amount of data that was read ahead */
+    size_t dirty;       /* Amount of data waiting to be written */
+} SDL_RWBuffer;
+
+static int
+buffered_flush(SDL_RWBuffer * buffer)
+{
+    size_t written;
+
+    if (buffer->dirty == 0) {
+        return 0;
+    }
+    written = SDL_RWwrite(buffer->src, buffer->data, 1, buffer->dirty);
+    if (buffer->position >= 0) {
+        buffer->position += written;
+    }
+    if (written < buffer->dirty) {
+        /* Keep what wasn't written so it can be retried */
+        SDL_memmove(buffer->data, buffer->data + written, buffer->dirty - written);
+        buffer->dirty -= written;
+        return -1;
+    }
+    buffer->dirty = 0;
+    return 0;
+}
+
+/* Give the data that was read ahead back to the source stream */
+static int
+buffered_unread(SDL_RWBuffer * buffer)
+{
+    Sint64 unread = (Sint64) (buffer->stop - buffer->here);
+
+    buffer->here = buffer->stop = 0;
+    if (unread > 0) {
+        buffer->position = SDL_RWseek(buffer->src, -unread, RW_SEEK_CUR);
+        if (buffer->position < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static Sint64 SDLCALL
+buffered_size(SDL_RWops * context)
+{
+    SDL_RWBuffer *buffer = (SDL_RWBuffer *) context->hidden.unknown.data1;
+
+    if (buffered_flush(buffer) < 0) {
+        return -1;
+    }
+    return SDL_RWsize(buffer->src);
+}
+
+static Sint64 SDLCALL
+buffered_seek(SDL_RWops * context, Sint64 offset, int whence)
+{
+    SDL_RWBuffer *buffer = (SDL_RWBuffer *) context->hidden.unknown.data1;
+    Sint64 start, target;
+
+    if (whence != RW_SEEK_SET && whence != RW_SEEK_CUR && whence != RW_SEEK_END) {
+        return SDL_SetError("Unknown value for 'whence'");
+    }
+    if (buffered_flush(buffer) < 0) {
+        return -1;
+    }
+
+    /* Seeks within the data that was read ahead don't touch the source */
+    if (buffer->position >= 0 && whence != RW_SEEK_END) {
+        start = buffer->position - (Sint64) buffer->stop;
+        if (whence == RW_SEEK_SET) {
+            target = offset;
+        } else {
+            target = start + (Sint64) buffer->here + offset;
+        }
+        if (target >= start && target <= buffer->position) {
+            buffer->here = (size_t) (target - start);
+            return target;
+        }
+    }
+
+    if (whence == RW_SEEK_CUR) {
+        offset -= (Sint64) (buffer->stop - buffer->here);
+    }
+    buffer->here = buffer->stop = 0;
+    buffer->position = SDL_RWseek(buffer->src, offset, whence);
+    return buffer->position;
+}
+
+static size_t SDLCALL
+buffered_read(SDL_RWops * context, void *ptr, size_t size, size_t maxnum)
+{
+    SDL_RWBuffer *buffer = (SDL_RWBuffer *) context->hidden.unknown.data1;
+    Uint8 *dst = (Uint8 *) ptr;
+    size_t total_bytes;
+    size_t left, amount;
+
+    total_bytes = (maxnum * size);
+    if ((maxnum <= 0) || (size <= 0)
+        || ((total_bytes / maxnum) != (size_t) size)) {
+        return 0;
+    }
+    if (buffered_flush(buffer) < 0) {
+        return 0;
+    }
+
+    left = total_bytes;
+    while (left > 0) {
+        amount = buffer->stop - buffer->here;
+        if (amount > 0) {
+            if (amount > left) {
+                amount = left;
+            }
+            SDL_memcpy(dst, buffer->data + buffer->here, amount);
+            buffer->here += amount;
+            dst += amount;
+            left -= amount;
+            continue;
+        }
+
+        buffer->here = buffer->stop = 0;
+        if (left >= buffer->size) {
+            /* Large reads go straight to the source */
+            amount = SDL_RWread(buffer->src, dst, 1, left);
+            dst += amount;
+            left -= amount;
+        } else {
+            amount = SDL_RWread(buffer->src, buffer->data, 1, buffer->size);
+            buffer->stop = amount;
+        }
+        if (buffer->position >= 0) {
+            buffer->position += amount;
+        }
+        if (amount == 0) {
+            break;
+        }
+    }
+    return (total_bytes - left) / size;
+}
+
+static size_t SDLCALL
+buffered_write(SDL_RWops * context, const void *ptr, size_t size, size_t num)
+{
+    SDL_RWBuffer *buffer = (SDL_RWBuffer *) context->hidden.unknown.data1;
+    size_t total_bytes;
+    size_t written;
+
+    total_bytes = (num * size);
+    if ((num <= 0) || (size <= 0)
+        || ((total_bytes / num) != (size_t) size)) {
+        return 0;
+    }
+    if (buffered_unread(buffer) < 0) {
+        return 0;
+    }
+    if ((buffer->dirty + total_bytes) > buffer->size && buffered_flush(buffer) < 0) {
+        return 0;
+    }
+
+    if (total_bytes >= buffer->size) {
+        /* Large writes go straight to the source */
+        written = SDL_RWwrite(buffer->src, ptr, size, num);
+        if (buffer->position >= 0) {
+            buffer->position += written * size;
+        }
+        return written;
+    }
+    SDL_memcpy(buffer->data + buffer->dirty, ptr, total_bytes);
+    buffer->dirty += total_bytes;
+    return num;
+}
+
+static int SDLCALL
+buffered_close(SDL_RWops * context)
+{
+    SDL_RWBuffer *buffer;
+    int status = 0;
+
+    if (context) {
+        buffer = (SDL_RWBuffer *) context->hidden.unknown.data1;
+        if (buffered_flush(buffer) < 0) {
+            status = -1;
+        }
+        if (buffer->freesrc) {
+            if (SDL_RWclose(buffer->src) < 0) {
+                status = -1;
+            }
+        } else if (buffered_unread(buffer) < 0) {
+            status = -1;
+        }
+        SDL_free(buffer->data);
+        SDL_free(buffer);
+        SDL_FreeRW(context);
+    }
+    return status;
+}
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -678,6 +976,103 @@ SDL_RWFromConstMem(const void *mem, int size)
     return rwops;
 }
 
+SDL_RWops *
+SDL_RWFromFileMapped(const char *file)
+{
+    SDL_RWops *rwops;
+    SDL_RWops *mapped;
+    Uint8 *base;
+    size_t size;
+
+    /* Let SDL_RWFromFile() find the file, it knows about bundles and
+       Android internal storage, then map whatever it opened. */
+    rwops = SDL_RWFromFile(file, "rb");
+    if (rwops == NULL || map_file(rwops, &base, &size) < 0) {
+        return rwops;
+    }
+
+    mapped = SDL_AllocRW();
+    if (mapped == NULL) {
+        unmap_file(base, size);
+        SDL_RWclose(rwops);
+        return NULL;
+    }
+    mapped->size = mem_size;
+    mapped->seek = mem_seek;
+    mapped->read = mem_read;
+    mapped->write = mem_writeconst;
+    mapped->close = mapped_close;
+    mapped->hidden.mem.base = base;
+    mapped->hidden.mem.here = base;
+    mapped->hidden.mem.stop = base + size;
+    mapped->type = SDL_RWOPS_MAPPED;
+
+    /* The mapping stays valid after the file is closed */
+    SDL_RWclose(rwops);
+    return mapped;
+}
+
+SDL_RWops *
+SDL_RWFromBuffered(SDL_RWops * context, size_t buffersize, int freesrc)
+{
+    SDL_RWops *rwops;
+    SDL_RWBuffer *buffer;
+
+    if (!context) {
+        SDL_InvalidParamError("context");
+        return NULL;
+    }
+    if (buffersize == 0) {
+        buffersize = DEFAULT_BUFFER_SIZE;
+    }
+
+    buffer = (SDL_RWBuffer *) SDL_calloc(1, sizeof(*buffer));
+    if (buffer == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    buffer->data = (Uint8 *) SDL_malloc(buffersize);
+    if (buffer->data == NULL) {
+        SDL_free(buffer);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    rwops = SDL_AllocRW();
+    if (rwops == NULL) {
+        SDL_free(buffer->data);
+        SDL_free(buffer);
+        return NULL;
+    }
+    buffer->src = context;
+    buffer->freesrc = freesrc;
+    buffer->position = SDL_RWtell(context);
+    buffer->size = buffersize;
+
+    rwops->size = buffered_size;
+    rwops->seek = buffered_seek;
+    rwops->read = buffered_read;
+    rwops->write = buffered_write;
+    rwops->close = buffered_close;
+    rwops->hidden.unknown.data1 = buffer;
+    rwops->type = SDL_RWOPS_BUFFERED;
+    return rwops;
+}
+
+const void *
+SDL_RWGetPointer(SDL_RWops * context, size_t *available)
+{
+    if (!context || context->read != mem_read) {
+        if (available) {
+            *available = 0;
+        }
+        return NULL;
+    }
+    if (available) {
+        *available = (size_t)(context->hidden.mem.stop - context->hidden.mem.here);
+    }
+    return context->hidden.mem.here;
+}
+
 SDL_RWops *
 SDL_AllocRW(void)
 {
@@ -706,12 +1101,30 @@ SDL_LoadFile_RW(SDL_RWops * src, size_t *datasize, int freesrc)
     Sint64 size;
     size_t size_read, size_total;
     void *data = NULL, *newdata;
+    const void *mem;
 
     if (!src) {
         SDL_InvalidParamError("src");
         return NULL;
     }
 
+    /* Memory backed streams can be copied in one go */
+    mem = SDL_RWGetPointer(src, &size_total);
+    if (mem) {
+        data = SDL_malloc(size_total + 1);
+        if (!data) {
+            SDL_OutOfMemory();
+            goto done;
+        }
+        SDL_memcpy(data, mem, size_total);
+        SDL_RWseek(src, (Sint64)size_total, RW_SEEK_CUR);
+        if (datasize) {
+            *datasize = size_total;
+        }
+        ((char *)data)[size_total] = '\0';
+        goto done;
+    }
+
     size = SDL_RWsize(src);
     if (size < 0) {
         size = FILE_CHUNK_SIZE;
@@ -46,6 +46,7 @@
 
 /* a list of currently opened game controllers */
 static SDL_GameController *SDL_gamecontrollers = NULL;
+static SDL_JoystickRegistry SDL_gamecontroller_registry;
 
 typedef struct
 {
@@ -82,6 +83,27 @@ typedef struct
 
 } SDL_ExtendedGameControllerBind;
 
+/* A binding with the values used to translate its input precomputed */
+typedef struct
+{
+    SDL_ExtendedGameControllerBind *binding;
+    int input_min;      /* The input axis range, in increasing order */
+    int input_max;
+    int output_min;     /* The output axis range, in increasing order */
+    int output_max;
+    int threshold;      /* Where an input axis presses an output button */
+    SDL_bool scaled;    /* The input axis range is scaled to the output one */
+    SDL_bool negative;  /* The output axis range is decreasing */
+    Uint64 scale;       /* The ratio of the ranges, 32.32 fixed point */
+} SDL_CompiledGameControllerBind;
+
+/* The bindings of one controller output or joystick input */
+typedef struct
+{
+    SDL_CompiledGameControllerBind **first;
+    int count;
+} SDL_GameControllerBindList;
+
 /* our hard coded list of mapping support */
 typedef enum
 {
@@ -95,12 +117,30 @@ typedef struct _ControllerMapping_t
     SDL_JoystickGUID guid;
     char *name;
     char *mapping;
+    const char *source;     /* The unparsed mapping string, if name and mapping haven't been extracted yet */
+    size_t source_len;
     SDL_ControllerMappingPriority priority;
     struct _ControllerMapping_t *next;
+    struct _ControllerMapping_t *hash_next;
 } ControllerMapping_t;
 
+/* A mappings database kept in memory so its entries can be parsed on demand */
+typedef struct _ControllerMappingDB_t
+{
+    SDL_RWops *rw;          /* The memory-mapped file, or NULL if data was allocated */
+    char *data;
+    struct _ControllerMappingDB_t *next;
+} ControllerMappingDB_t;
+
+#define SDL_CONTROLLER_MAPPING_HASH_MIN 256
+
 static SDL_JoystickGUID s_zeroGUID;
 static ControllerMapping_t *s_pSupportedControllers = NULL;
+static ControllerMapping_t *s_pLastController = NULL;
+static ControllerMapping_t **s_pMappingHash = NULL;
+static int s_nMappingHashSize = 0;
+static int s_nMappings = 0;
+static ControllerMappingDB_t *s_pMappingDBs = NULL;
 static ControllerMapping_t *s_pDefaultMapping = NULL;
 static ControllerMapping_t *s_pHIDAPIMapping = NULL;
 static ControllerMapping_t *s_pXInputMapping = NULL;
@@ -114,6 +154,16 @@ struct _SDL_GameController
     const char *name;
     int num_bindings;
     SDL_ExtendedGameControllerBind *bindings;
+
+    /* The bindings grouped by output and by input, in mapping order */
+    SDL_CompiledGameControllerBind *compiled;
+    SDL_CompiledGameControllerBind **bind_order;
+    SDL_GameControllerBindList axis_outputs[SDL_CONTROLLER_AXIS_MAX];
+    SDL_GameControllerBindList button_outputs[SDL_CONTROLLER_BUTTON_MAX];
+    SDL_GameControllerBindList *axis_inputs;
+    SDL_GameControllerBindList *button_inputs;
+    SDL_GameControllerBindList *hat_inputs;
+
     SDL_ExtendedGameControllerBind **last_match_axis;
     Uint8 *last_hat_mask;
     Uint32 guide_button_down;
@@ -190,6 +240,7 @@ SDL_GameControllerIgnoreDevicesExceptChanged(void *userdata, const char *name, c
     SDL_LoadVIDPIDListFromHint(hint, &SDL_allowed_controllers);
 }
 
+static int SDL_PrivateGameControllerAddMapping(const char *mappingString, const char *source, SDL_ControllerMappingPriority priority);
 static int SDL_PrivateGameControllerAxis(SDL_GameController * gamecontroller, SDL_GameControllerAxis axis, Sint16 value);
 static int SDL_PrivateGameControllerButton(SDL_GameController * gamecontroller, SDL_GameControllerButton button, Uint8 state);
 
@@ -244,29 +295,47 @@ static void ResetOutput(SDL_GameController *gamecontroller, SDL_ExtendedGameCont
     }
 }
 
+static SDL_INLINE int ScaleAxisValue(const SDL_CompiledGameControllerBind *compiled, int value)
+{
+    const SDL_ExtendedGameControllerBind *binding = compiled->binding;
+    int offset;
+
+    if (!compiled->scaled) {
+        return value;
+    }
+    offset = (int)(((Uint64)SDL_abs(value - binding->input.axis.axis_min) * compiled->scale) >> 32);
+    if (compiled->negative) {
+        return binding->output.axis.axis_min - offset;
+    }
+    return binding->output.axis.axis_min + offset;
+}
+
+static SDL_INLINE SDL_bool InInputRange(const SDL_CompiledGameControllerBind *compiled, int value)
+{
+    return (value >= compiled->input_min && value <= compiled->input_max);
+}
+
+static SDL_INLINE Uint8 AxisButtonState(const SDL_CompiledGameControllerBind *compiled, int value)
+{
+    if (compiled->binding->input.axis.axis_max < compiled->binding->input.axis.axis_min) {
+        return (value <= compiled->threshold) ? SDL_PRESSED : SDL_RELEASED;
+    }
+    return (value >= compiled->threshold) ? SDL_PRESSED : SDL_RELEASED;
+}
+
 static void HandleJoystickAxis(SDL_GameController *gamecontroller, int axis, int value)
 {
     int i;
     SDL_ExtendedGameControllerBind *last_match = gamecontroller->last_match_axis[axis];
+    SDL_CompiledGameControllerBind *compiled = NULL;
     SDL_ExtendedGameControllerBind *match = NULL;
+    const SDL_GameControllerBindList *list = &gamecontroller->axis_inputs[axis];
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS &&
-            axis == binding->input.axis.axis) {
-            if (binding->input.axis.axis_min < binding->input.axis.axis_max) {
-                if (value >= binding->input.axis.axis_min &&
-                    value <= binding->input.axis.axis_max) {
-                    match = binding;
-                    break;
-                }
-            } else {
-                if (value >= binding->input.axis.axis_max &&
-                    value <= binding->input.axis.axis_min) {
-                    match = binding;
-                    break;
-                }
-            }
+    for (i = 0; i < list->count; ++i) {
+        if (InInputRange(list->first[i], value)) {
+            compiled = list->first[i];
+            match = compiled->binding;
+            break;
         }
     }
 
@@ -277,20 +346,9 @@ static void HandleJoystickAxis(SDL_GameController *gamecontroller, int axis, int
 
     if (match) {
         if (match->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-            if (match->input.axis.axis_min != match->output.axis.axis_min || match->input.axis.axis_max != match->output.axis.axis_max) {
-                float normalized_value = (float)(value - match->input.axis.axis_min) / (match->input.axis.axis_max - match->input.axis.axis_min);
-                value = match->output.axis.axis_min + (int)(normalized_value * (match->output.axis.axis_max - match->output.axis.axis_min));
-            }
-            SDL_PrivateGameControllerAxis(gamecontroller, match->output.axis.axis, (Sint16)value);
+            SDL_PrivateGameControllerAxis(gamecontroller, match->output.axis.axis, (Sint16)ScaleAxisValue(compiled, value));
         } else {
-            Uint8 state;
-            int threshold = match->input.axis.axis_min + (match->input.axis.axis_max - match->input.axis.axis_min) / 2;
-            if (match->input.axis.axis_max < match->input.axis.axis_min) {
-                state = (value <= threshold) ? SDL_PRESSED : SDL_RELEASED;
-            } else {
-                state = (value >= threshold) ? SDL_PRESSED : SDL_RELEASED;
-            }
-            SDL_PrivateGameControllerButton(gamecontroller, match->output.button, state);
+            SDL_PrivateGameControllerButton(gamecontroller, match->output.button, AxisButtonState(compiled, value));
         }
     }
     gamecontroller->last_match_axis[axis] = match;
@@ -298,19 +356,16 @@ static void HandleJoystickAxis(SDL_GameController *gamecontroller, int axis, int
 
 static void HandleJoystickButton(SDL_GameController *gamecontroller, int button, Uint8 state)
 {
-    int i;
+    const SDL_GameControllerBindList *list = &gamecontroller->button_inputs[button];
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON &&
-            button == binding->input.button) {
-            if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                int value = state ? binding->output.axis.axis_max : binding->output.axis.axis_min;
-                SDL_PrivateGameControllerAxis(gamecontroller, binding->output.axis.axis, (Sint16)value);
-            } else {
-                SDL_PrivateGameControllerButton(gamecontroller, binding->output.button, state);
-            }
-            break;
+    /* Only the first binding of a button is used */
+    if (list->count > 0) {
+        SDL_ExtendedGameControllerBind *binding = list->first[0]->binding;
+        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            int value = state ? binding->output.axis.axis_max : binding->output.axis.axis_min;
+            SDL_PrivateGameControllerAxis(gamecontroller, binding->output.axis.axis, (Sint16)value);
+        } else {
+            SDL_PrivateGameControllerButton(gamecontroller, binding->output.button, state);
         }
     }
 }
@@ -320,20 +375,19 @@ static void HandleJoystickHat(SDL_GameController *gamecontroller, int hat, Uint8
     int i;
     Uint8 last_mask = gamecontroller->last_hat_mask[hat];
     Uint8 changed_mask = (last_mask ^ value);
-
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT && hat == binding->input.hat.hat) {
-            if ((changed_mask & binding->input.hat.hat_mask) != 0) {
-                if (value & binding->input.hat.hat_mask) {
-                    if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                        SDL_PrivateGameControllerAxis(gamecontroller, binding->output.axis.axis, (Sint16)binding->output.axis.axis_max);
-                    } else {
-                        SDL_PrivateGameControllerButton(gamecontroller, binding->output.button, SDL_PRESSED);
-                    }
+    const SDL_GameControllerBindList *list = &gamecontroller->hat_inputs[hat];
+
+    for (i = 0; i < list->count; ++i) {
+        SDL_ExtendedGameControllerBind *binding = list->first[i]->binding;
+        if ((changed_mask & binding->input.hat.hat_mask) != 0) {
+            if (value & binding->input.hat.hat_mask) {
+                if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+                    SDL_PrivateGameControllerAxis(gamecontroller, binding->output.axis.axis, (Sint16)binding->output.axis.axis_max);
                 } else {
-                    ResetOutput(gamecontroller, binding);
+                    SDL_PrivateGameControllerButton(gamecontroller, binding->output.button, SDL_PRESSED);
                 }
+            } else {
+                ResetOutput(gamecontroller, binding);
             }
         }
     }
@@ -348,38 +402,26 @@ static int SDLCALL SDL_GameControllerEventWatcher(void *userdata, SDL_Event * ev
     switch(event->type) {
     case SDL_JOYAXISMOTION:
         {
-            SDL_GameController *controllerlist = SDL_gamecontrollers;
-            while (controllerlist) {
-                if (controllerlist->joystick->instance_id == event->jaxis.which) {
-                    HandleJoystickAxis(controllerlist, event->jaxis.axis, event->jaxis.value);
-                    break;
-                }
-                controllerlist = controllerlist->next;
+            SDL_GameController *controllerlist = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, event->jaxis.which);
+            if (controllerlist) {
+                HandleJoystickAxis(controllerlist, event->jaxis.axis, event->jaxis.value);
             }
         }
         break;
     case SDL_JOYBUTTONDOWN:
     case SDL_JOYBUTTONUP:
         {
-            SDL_GameController *controllerlist = SDL_gamecontrollers;
-            while (controllerlist) {
-                if (controllerlist->joystick->instance_id == event->jbutton.which) {
-                    HandleJoystickButton(controllerlist, event->jbutton.button, event->jbutton.state);
-                    break;
-                }
-                controllerlist = controllerlist->next;
+            SDL_GameController *controllerlist = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, event->jbutton.which);
+            if (controllerlist) {
+                HandleJoystickButton(controllerlist, event->jbutton.button, event->jbutton.state);
             }
         }
         break;
     case SDL_JOYHATMOTION:
         {
-            SDL_GameController *controllerlist = SDL_gamecontrollers;
-            while (controllerlist) {
-                if (controllerlist->joystick->instance_id == event->jhat.which) {
-                    HandleJoystickHat(controllerlist, event->jhat.hat, event->jhat.value);
-                    break;
-                }
-                controllerlist = controllerlist->next;
+            SDL_GameController *controllerlist = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, event->jhat.which);
+            if (controllerlist) {
+                HandleJoystickHat(controllerlist, event->jhat.hat, event->jhat.value);
             }
         }
         break;
@@ -395,19 +437,15 @@ static int SDLCALL SDL_GameControllerEventWatcher(void *userdata, SDL_Event * ev
         break;
     case SDL_JOYDEVICEREMOVED:
         {
-            SDL_GameController *controllerlist = SDL_gamecontrollers;
-            while (controllerlist) {
-                if (controllerlist->joystick->instance_id == event->jdevice.which) {
-                    SDL_Event deviceevent;
+            SDL_GameController *controllerlist = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, event->jdevice.which);
+            if (controllerlist) {
+                SDL_Event deviceevent;
 
-                    deviceevent.type = SDL_CONTROLLERDEVICEREMOVED;
-                    deviceevent.cdevice.which = event->jdevice.which;
-                    SDL_PushEvent(&deviceevent);
+                deviceevent.type = SDL_CONTROLLERDEVICEREMOVED;
+                deviceevent.cdevice.which = event->jdevice.which;
+                SDL_PushEvent(&deviceevent);
 
-                    UpdateEventsForDeviceRemoval();
-                    break;
-                }
-                controllerlist = controllerlist->next;
+                UpdateEventsForDeviceRemoval();
             }
         }
         break;
@@ -421,14 +459,61 @@ static int SDLCALL SDL_GameControllerEventWatcher(void *userdata, SDL_Event * ev
 /*
  * Helper function to scan the mappings database for a controller with the specified GUID
  */
+static Uint32 SDL_PrivateHashGUID(const SDL_JoystickGUID *guid)
+{
+    /* FNV-1a */
+    Uint32 hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < sizeof(guid->data); ++i) {
+        hash = (hash ^ guid->data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Helper function to add a mapping to the hash table, growing it as needed
+ */
+static SDL_bool SDL_PrivateHashControllerMapping(ControllerMapping_t *pControllerMapping)
+{
+    Uint32 bucket;
+
+    if (s_nMappings >= s_nMappingHashSize) {
+        int size = s_nMappingHashSize ? s_nMappingHashSize * 2 : SDL_CONTROLLER_MAPPING_HASH_MIN;
+        ControllerMapping_t **hash = (ControllerMapping_t **)SDL_calloc(size, sizeof(*hash));
+        ControllerMapping_t *mapping;
+
+        if (!hash) {
+            SDL_OutOfMemory();
+            return SDL_FALSE;
+        }
+        for (mapping = s_pSupportedControllers; mapping; mapping = mapping->next) {
+            bucket = SDL_PrivateHashGUID(&mapping->guid) & (size - 1);
+            mapping->hash_next = hash[bucket];
+            hash[bucket] = mapping;
+        }
+        SDL_free(s_pMappingHash);
+        s_pMappingHash = hash;
+        s_nMappingHashSize = size;
+    }
+
+    bucket = SDL_PrivateHashGUID(&pControllerMapping->guid) & (s_nMappingHashSize - 1);
+    pControllerMapping->hash_next = s_pMappingHash[bucket];
+    s_pMappingHash[bucket] = pControllerMapping;
+    ++s_nMappings;
+    return SDL_TRUE;
+}
+
 static ControllerMapping_t *SDL_PrivateGetControllerMappingForGUID(SDL_JoystickGUID *guid, SDL_bool exact_match)
 {
-    ControllerMapping_t *pSupportedController = s_pSupportedControllers;
-    while (pSupportedController) {
-        if (SDL_memcmp(guid, &pSupportedController->guid, sizeof(*guid)) == 0) {
-            return pSupportedController;
+    if (s_pMappingHash) {
+        ControllerMapping_t *pSupportedController = s_pMappingHash[SDL_PrivateHashGUID(guid) & (s_nMappingHashSize - 1)];
+        while (pSupportedController) {
+            if (SDL_memcmp(guid, &pSupportedController->guid, sizeof(*guid)) == 0) {
+                return pSupportedController;
+            }
+            pSupportedController = pSupportedController->hash_next;
         }
-        pSupportedController = pSupportedController->next;
     }
     if (!exact_match) {
         if (SDL_IsJoystickHIDAPI(*guid)) {
@@ -679,6 +764,137 @@ SDL_PrivateGameControllerParseControllerConfigString(SDL_GameController *gamecon
 
 }
 
+static SDL_GameControllerBindList *GetOutputBindList(SDL_GameController *gamecontroller, const SDL_ExtendedGameControllerBind *binding)
+{
+    if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+        if (binding->output.axis.axis >= 0 && binding->output.axis.axis < SDL_CONTROLLER_AXIS_MAX) {
+            return &gamecontroller->axis_outputs[binding->output.axis.axis];
+        }
+    } else if (binding->outputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+        if (binding->output.button >= 0 && binding->output.button < SDL_CONTROLLER_BUTTON_MAX) {
+            return &gamecontroller->button_outputs[binding->output.button];
+        }
+    }
+    return NULL;
+}
+
+static SDL_GameControllerBindList *GetInputBindList(SDL_GameController *gamecontroller, const SDL_ExtendedGameControllerBind *binding)
+{
+    SDL_Joystick *joystick = gamecontroller->joystick;
+
+    if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+        if (binding->input.axis.axis >= 0 && binding->input.axis.axis < joystick->naxes) {
+            return &gamecontroller->axis_inputs[binding->input.axis.axis];
+        }
+    } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+        if (binding->input.button >= 0 && binding->input.button < joystick->nbuttons) {
+            return &gamecontroller->button_inputs[binding->input.button];
+        }
+    } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
+        if (binding->input.hat.hat >= 0 && binding->input.hat.hat < joystick->nhats) {
+            return &gamecontroller->hat_inputs[binding->input.hat.hat];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Store the compiled bindings contiguously for each list, keeping their order
+ */
+static SDL_CompiledGameControllerBind **GroupBindings(SDL_GameController *gamecontroller, SDL_CompiledGameControllerBind **order,
+    SDL_GameControllerBindList *(*GetBindList)(SDL_GameController *, const SDL_ExtendedGameControllerBind *))
+{
+    SDL_GameControllerBindList *list;
+    int i;
+
+    for (i = 0; i < gamecontroller->num_bindings; ++i) {
+        list = GetBindList(gamecontroller, &gamecontroller->bindings[i]);
+        if (list) {
+            ++list->count;
+        }
+    }
+    for (i = 0; i < gamecontroller->num_bindings; ++i) {
+        list = GetBindList(gamecontroller, &gamecontroller->bindings[i]);
+        if (list) {
+            if (!list->first) {
+                list->first = order;
+                order += list->count;
+                list->count = 0;
+            }
+            list->first[list->count++] = &gamecontroller->compiled[i];
+        }
+    }
+    return order;
+}
+
+/*
+ * Precompute the bindings of each controller output and joystick input
+ */
+static void SDL_PrivateCompileBindings(SDL_GameController *gamecontroller)
+{
+    SDL_Joystick *joystick = gamecontroller->joystick;
+    SDL_CompiledGameControllerBind **order;
+    int i;
+
+    SDL_zero(gamecontroller->axis_outputs);
+    SDL_zero(gamecontroller->button_outputs);
+    SDL_memset(gamecontroller->axis_inputs, 0, joystick->naxes * sizeof(*gamecontroller->axis_inputs));
+    SDL_memset(gamecontroller->button_inputs, 0, joystick->nbuttons * sizeof(*gamecontroller->button_inputs));
+    SDL_memset(gamecontroller->hat_inputs, 0, joystick->nhats * sizeof(*gamecontroller->hat_inputs));
+    SDL_free(gamecontroller->compiled);
+    SDL_free(gamecontroller->bind_order);
+    gamecontroller->compiled = NULL;
+    gamecontroller->bind_order = NULL;
+
+    if (gamecontroller->num_bindings == 0) {
+        return;
+    }
+
+    gamecontroller->compiled = (SDL_CompiledGameControllerBind *)SDL_calloc(gamecontroller->num_bindings, sizeof(*gamecontroller->compiled));
+    gamecontroller->bind_order = (SDL_CompiledGameControllerBind **)SDL_calloc(2 * gamecontroller->num_bindings, sizeof(*gamecontroller->bind_order));
+    if (!gamecontroller->compiled || !gamecontroller->bind_order) {
+        SDL_free(gamecontroller->compiled);
+        SDL_free(gamecontroller->bind_order);
+        gamecontroller->compiled = NULL;
+        gamecontroller->bind_order = NULL;
+        SDL_OutOfMemory();
+        return;
+    }
+
+    for (i = 0; i < gamecontroller->num_bindings; ++i) {
+        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
+        SDL_CompiledGameControllerBind *compiled = &gamecontroller->compiled[i];
+
+        compiled->binding = binding;
+        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            compiled->input_min = SDL_min(binding->input.axis.axis_min, binding->input.axis.axis_max);
+            compiled->input_max = SDL_max(binding->input.axis.axis_min, binding->input.axis.axis_max);
+            compiled->threshold = binding->input.axis.axis_min + (binding->input.axis.axis_max - binding->input.axis.axis_min) / 2;
+        }
+        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            compiled->output_min = SDL_min(binding->output.axis.axis_min, binding->output.axis.axis_max);
+            compiled->output_max = SDL_max(binding->output.axis.axis_min, binding->output.axis.axis_max);
+            compiled->negative = (binding->output.axis.axis_max < binding->output.axis.axis_min);
+            if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS &&
+                (binding->input.axis.axis_min != binding->output.axis.axis_min || binding->input.axis.axis_max != binding->output.axis.axis_max)) {
+                const Uint64 input_range = (Uint64)(compiled->input_max - compiled->input_min);
+                const Uint64 output_range = (Uint64)(compiled->output_max - compiled->output_min);
+
+                /* Rounding up makes the ends of the input range land exactly on
+                   the ends of the output range, and is exact in between since
+                   the ranges are at most 65535 */
+                compiled->scaled = SDL_TRUE;
+                if (input_range > 0) {
+                    compiled->scale = ((output_range << 32) + input_range - 1) / input_range;
+                }
+            }
+        }
+    }
+
+    order = GroupBindings(gamecontroller, gamecontroller->bind_order, GetOutputBindList);
+    GroupBindings(gamecontroller, order, GetInputBindList);
+}
+
 /*
  * Make a new button mapping struct
  */
@@ -705,21 +921,18 @@ static void SDL_PrivateLoadButtonMapping(SDL_GameController *gamecontroller, con
             }
         }
     }
+
+    SDL_PrivateCompileBindings(gamecontroller);
 }
 
 
 /*
  * grab the guid string from a mapping string
  */
-static char *SDL_PrivateGetControllerGUIDFromMappingString(const char *pMapping)
+static SDL_bool SDL_PrivateGetControllerGUIDFromMappingString(const char *pMapping, char *pchGUID, size_t size)
 {
     const char *pFirstComma = SDL_strchr(pMapping, ',');
-    if (pFirstComma) {
-        char *pchGUID = SDL_malloc(pFirstComma - pMapping + 1);
-        if (!pchGUID) {
-            SDL_OutOfMemory();
-            return NULL;
-        }
+    if (pFirstComma && (size_t)(pFirstComma - pMapping) < size) {
         SDL_memcpy(pchGUID, pMapping, pFirstComma - pMapping);
         pchGUID[pFirstComma - pMapping] = '\0';
 
@@ -741,9 +954,9 @@ static char *SDL_PrivateGetControllerGUIDFromMappingString(const char *pMapping)
             SDL_memcpy(&pchGUID[0], "03000000", 8);
         }
 #endif
-        return pchGUID;
+        return SDL_TRUE;
     }
-    return NULL;
+    return SDL_FALSE;
 }
 
 
@@ -792,6 +1005,47 @@ static char *SDL_PrivateGetControllerMappingFromMappingString(const char *pMappi
     return SDL_strdup(pSecondComma + 1); /* mapping is everything after the 3rd comma */
 }
 
+/*
+ * Helper function to extract the name and mapping of an entry that was added unparsed
+ */
+static SDL_bool SDL_PrivateParseControllerMapping(ControllerMapping_t *pControllerMapping)
+{
+    const char *pFirstComma, *pSecondComma, *pEnd;
+    char *pchName, *pchMapping;
+
+    if (!pControllerMapping->source) {
+        return SDL_TRUE;
+    }
+
+    /* The source isn't necessarily terminated, but was checked for both commas when it was added */
+    pEnd = pControllerMapping->source + pControllerMapping->source_len;
+    for (pFirstComma = pControllerMapping->source; *pFirstComma != ','; ++pFirstComma) {
+        continue;
+    }
+    for (pSecondComma = pFirstComma + 1; *pSecondComma != ','; ++pSecondComma) {
+        continue;
+    }
+
+    pchName = (char *)SDL_malloc(pSecondComma - pFirstComma);
+    pchMapping = (char *)SDL_malloc(pEnd - pSecondComma);
+    if (!pchName || !pchMapping) {
+        SDL_free(pchName);
+        SDL_free(pchMapping);
+        SDL_OutOfMemory();
+        return SDL_FALSE;
+    }
+    SDL_memcpy(pchName, pFirstComma + 1, pSecondComma - pFirstComma - 1);
+    pchName[pSecondComma - pFirstComma - 1] = '\0';
+    SDL_memcpy(pchMapping, pSecondComma + 1, pEnd - pSecondComma - 1);
+    pchMapping[pEnd - pSecondComma - 1] = '\0';
+
+    pControllerMapping->name = pchName;
+    pControllerMapping->mapping = pchMapping;
+    pControllerMapping->source = NULL;
+    pControllerMapping->source_len = 0;
+    return SDL_TRUE;
+}
+
 /*
  * Helper function to refresh a mapping
  */
@@ -799,7 +1053,8 @@ static void SDL_PrivateGameControllerRefreshMapping(ControllerMapping_t *pContro
 {
     SDL_GameController *gamecontrollerlist = SDL_gamecontrollers;
     while (gamecontrollerlist) {
-        if (!SDL_memcmp(&gamecontrollerlist->joystick->guid, &pControllerMapping->guid, sizeof(pControllerMapping->guid))) {
+        if (!SDL_memcmp(&gamecontrollerlist->joystick->guid, &pControllerMapping->guid, sizeof(pControllerMapping->guid)) &&
+            SDL_PrivateParseControllerMapping(pControllerMapping)) {
             /* Not really threadsafe.  Should this lock access within SDL_GameControllerEventWatcher? */
             SDL_PrivateLoadButtonMapping(gamecontrollerlist, pControllerMapping->name, pControllerMapping->mapping);
 
@@ -817,25 +1072,36 @@ static void SDL_PrivateGameControllerRefreshMapping(ControllerMapping_t *pContro
 
 /*
  * Helper function to add a mapping for a guid
+ *
+ * If source is not NULL, it holds a copy of mappingString that stays valid
+ * until the mappings are freed, and the entry is parsed when it's first used.
  */
 static ControllerMapping_t *
-SDL_PrivateAddMappingForGUID(SDL_JoystickGUID jGUID, const char *mappingString, SDL_bool *existing, SDL_ControllerMappingPriority priority)
+SDL_PrivateAddMappingForGUID(SDL_JoystickGUID jGUID, const char *mappingString, const char *source, SDL_bool *existing, SDL_ControllerMappingPriority priority)
 {
-    char *pchName;
-    char *pchMapping;
+    char *pchName = NULL;
+    char *pchMapping = NULL;
     ControllerMapping_t *pControllerMapping;
 
-    pchName = SDL_PrivateGetControllerNameFromMappingString(mappingString);
-    if (!pchName) {
-        SDL_SetError("Couldn't parse name from %s", mappingString);
-        return NULL;
-    }
+    if (source) {
+        const char *pFirstComma = SDL_strchr(mappingString, ',');
+        if (!pFirstComma || !SDL_strchr(pFirstComma + 1, ',')) {
+            SDL_SetError("Couldn't parse %s", mappingString);
+            return NULL;
+        }
+    } else {
+        pchName = SDL_PrivateGetControllerNameFromMappingString(mappingString);
+        if (!pchName) {
+            SDL_SetError("Couldn't parse name from %s", mappingString);
+            return NULL;
+        }
 
-    pchMapping = SDL_PrivateGetControllerMappingFromMappingString(mappingString);
-    if (!pchMapping) {
-        SDL_free(pchName);
-        SDL_SetError("Couldn't parse %s", mappingString);
-        return NULL;
+        pchMapping = SDL_PrivateGetControllerMappingFromMappingString(mappingString);
+        if (!pchMapping) {
+            SDL_free(pchName);
+            SDL_SetError("Couldn't parse %s", mappingString);
+            return NULL;
+        }
     }
 
     pControllerMapping = SDL_PrivateGetControllerMappingForGUID(&jGUID, SDL_TRUE);
@@ -847,6 +1113,8 @@ SDL_PrivateAddMappingForGUID(SDL_JoystickGUID jGUID, const char *mappingString,
             pControllerMapping->name = pchName;
             SDL_free(pControllerMapping->mapping);
             pControllerMapping->mapping = pchMapping;
+            pControllerMapping->source = source;
+            pControllerMapping->source_len = source ? SDL_strlen(mappingString) : 0;
             pControllerMapping->priority = priority;
             /* refresh open controllers */
             SDL_PrivateGameControllerRefreshMapping(pControllerMapping);
@@ -866,22 +1134,25 @@ SDL_PrivateAddMappingForGUID(SDL_JoystickGUID jGUID, const char *mappingString,
         pControllerMapping->guid = jGUID;
         pControllerMapping->name = pchName;
         pControllerMapping->mapping = pchMapping;
+        pControllerMapping->source = source;
+        pControllerMapping->source_len = source ? SDL_strlen(mappingString) : 0;
         pControllerMapping->next = NULL;
         pControllerMapping->priority = priority;
 
-        if (s_pSupportedControllers) {
-            /* Add the mapping to the end of the list */
-            ControllerMapping_t *pCurrMapping, *pPrevMapping;
+        if (!SDL_PrivateHashControllerMapping(pControllerMapping)) {
+            SDL_free(pchName);
+            SDL_free(pchMapping);
+            SDL_free(pControllerMapping);
+            return NULL;
+        }
 
-            for ( pPrevMapping = s_pSupportedControllers, pCurrMapping = pPrevMapping->next;
-                  pCurrMapping; 
-                  pPrevMapping = pCurrMapping, pCurrMapping = pCurrMapping->next ) {
-                continue;
-            }
-            pPrevMapping->next = pControllerMapping;
+        /* Add the mapping to the end of the list */
+        if (s_pLastController) {
+            s_pLastController->next = pControllerMapping;
         } else {
             s_pSupportedControllers = pControllerMapping;
         }
+        s_pLastController = pControllerMapping;
         *existing = SDL_FALSE;
     }
     return pControllerMapping;
@@ -994,7 +1265,7 @@ static ControllerMapping_t *SDL_CreateMappingForAndroidController(const char *na
     if (axis_mask & (1 << SDL_CONTROLLER_AXIS_TRIGGERRIGHT)) {
         SDL_strlcat(mapping_string, "righttrigger:a5,", sizeof(mapping_string));
     }
-    return SDL_PrivateAddMappingForGUID(guid, mapping_string,
+    return SDL_PrivateAddMappingForGUID(guid, mapping_string, NULL,
                       &existing, SDL_CONTROLLER_MAPPING_PRIORITY_DEFAULT);
 }
 #endif /* __ANDROID__ */
@@ -1015,7 +1286,7 @@ static ControllerMapping_t *SDL_PrivateGetControllerMappingForNameAndGUID(const
             SDL_bool existing;
             mapping = SDL_PrivateAddMappingForGUID(guid,
 "none,X360 Wireless Controller,a:b0,b:b1,back:b6,dpdown:b14,dpleft:b11,dpright:b12,dpup:b13,guide:b8,leftshoulder:b4,leftstick:b9,lefttrigger:a2,leftx:a0,lefty:a1,rightshoulder:b5,rightstick:b10,righttrigger:a5,rightx:a3,righty:a4,start:b7,x:b2,y:b3,",
-                          &existing, SDL_CONTROLLER_MAPPING_PRIORITY_DEFAULT);
+                          NULL, &existing, SDL_CONTROLLER_MAPPING_PRIORITY_DEFAULT);
         }
     }
 #endif /* __LINUX__ */
@@ -1033,6 +1304,9 @@ static ControllerMapping_t *SDL_PrivateGetControllerMappingForNameAndGUID(const
     if (!mapping) {
         mapping = s_pDefaultMapping;
     }
+    if (mapping && !SDL_PrivateParseControllerMapping(mapping)) {
+        mapping = NULL;
+    }
     return mapping;
 }
 
@@ -1065,45 +1339,86 @@ SDL_GameControllerAddMappingsFromRW(SDL_RWops * rw, int freerw)
 {
     const char *platform = SDL_GetPlatform();
     int controllers = 0;
-    char *buf, *line, *line_end, *tmp, *comma, line_platform[64];
-    size_t db_size, platform_len;
-    
+    SDL_bool used = SDL_FALSE;
+    char *line = NULL, *tmp, *comma, line_platform[64];
+    const char *db, *db_end, *line_start, *line_end;
+    size_t db_size, line_size = 0, line_len, platform_len;
+    ControllerMappingDB_t *pMappingDB;
+
     if (rw == NULL) {
         return SDL_SetError("Invalid RWops");
     }
-    db_size = (size_t)SDL_RWsize(rw);
-    
-    buf = (char *)SDL_malloc(db_size + 1);
-    if (buf == NULL) {
+
+    pMappingDB = (ControllerMappingDB_t *)SDL_calloc(1, sizeof(*pMappingDB));
+    if (pMappingDB == NULL) {
         if (freerw) {
             SDL_RWclose(rw);
         }
-        return SDL_SetError("Could not allocate space to read DB into memory");
+        return SDL_OutOfMemory();
     }
-    
-    if (SDL_RWread(rw, buf, db_size, 1) != 1) {
+
+    /* The database is kept in memory and entries are only parsed when
+       they're used.  A memory-mapped file that we own is kept open,
+       anything else is copied.
+     */
+    db = (const char *)SDL_RWGetPointer(rw, &db_size);
+    if (db != NULL && freerw && rw->type == SDL_RWOPS_MAPPED) {
+        pMappingDB->rw = rw;
+    } else {
+        if (db == NULL) {
+            db_size = (size_t)SDL_RWsize(rw);
+        }
+
+        pMappingDB->data = (char *)SDL_malloc(db_size + 1);
+        if (pMappingDB->data == NULL) {
+            if (freerw) {
+                SDL_RWclose(rw);
+            }
+            SDL_free(pMappingDB);
+            return SDL_SetError("Could not allocate space to read DB into memory");
+        }
+
+        if (db != NULL) {
+            SDL_memcpy(pMappingDB->data, db, db_size);
+            if (!freerw) {
+                SDL_RWseek(rw, (Sint64)db_size, RW_SEEK_CUR);
+            }
+        } else if (SDL_RWread(rw, pMappingDB->data, db_size, 1) != 1) {
+            if (freerw) {
+                SDL_RWclose(rw);
+            }
+            SDL_free(pMappingDB->data);
+            SDL_free(pMappingDB);
+            return SDL_SetError("Could not read DB");
+        }
+
         if (freerw) {
             SDL_RWclose(rw);
         }
-        SDL_free(buf);
-        return SDL_SetError("Could not read DB");
-    }
-    
-    if (freerw) {
-        SDL_RWclose(rw);
-    }
-    
-    buf[db_size] = '\0';
-    line = buf;
-    
-    while (line < buf + db_size) {
-        line_end = SDL_strchr(line, '\n');
-        if (line_end != NULL) {
-            *line_end = '\0';
-        } else {
-            line_end = buf + db_size;
+        pMappingDB->data[db_size] = '\0';
+        db = pMappingDB->data;
+    }
+    db_end = db + db_size;
+
+    for (line_start = db; line_start < db_end; line_start = line_end + 1) {
+        for (line_end = line_start; line_end < db_end && *line_end != '\n'; ++line_end) {
+            continue;
+        }
+
+        /* Each line is copied out to be checked, the database itself is never modified */
+        line_len = line_end - line_start;
+        if (line_len + 1 > line_size) {
+            char *new_line = (char *)SDL_realloc(line, line_len + 1);
+            if (new_line == NULL) {
+                SDL_OutOfMemory();
+                break;
+            }
+            line = new_line;
+            line_size = line_len + 1;
         }
-        
+        SDL_memcpy(line, line_start, line_len);
+        line[line_len] = '\0';
+
         /* Extract and verify the platform */
         tmp = SDL_strstr(line, SDL_CONTROLLER_PLATFORM_FIELD);
         if (tmp != NULL) {
@@ -1113,28 +1428,45 @@ SDL_GameControllerAddMappingsFromRW(SDL_RWops * rw, int freerw)
                 platform_len = comma - tmp + 1;
                 if (platform_len + 1 < SDL_arraysize(line_platform)) {
                     SDL_strlcpy(line_platform, tmp, platform_len);
-                    if (SDL_strncasecmp(line_platform, platform, platform_len) == 0 &&
-                        SDL_GameControllerAddMapping(line) > 0) {
-                        controllers++;
+                    if (SDL_strncasecmp(line_platform, platform, platform_len) == 0) {
+                        int result = SDL_PrivateGameControllerAddMapping(line, line_start, SDL_CONTROLLER_MAPPING_PRIORITY_API);
+                        if (result > 0) {
+                            controllers++;
+                        }
+                        if (result >= 0) {
+                            used = SDL_TRUE;
+                        }
                     }
                 }
             }
         }
-        
-        line = line_end + 1;
     }
+    SDL_free(line);
 
-    SDL_free(buf);
+    /* Keep the database if any entries may refer to it */
+    if (used) {
+        pMappingDB->next = s_pMappingDBs;
+        s_pMappingDBs = pMappingDB;
+    } else {
+        if (pMappingDB->rw) {
+            SDL_RWclose(pMappingDB->rw);
+        }
+        SDL_free(pMappingDB->data);
+        SDL_free(pMappingDB);
+    }
     return controllers;
 }
 
 /*
  * Add or update an entry into the Mappings Database with a priority
+ *
+ * If source is not NULL, it's a copy of mappingString that is kept until the
+ * mappings are freed, and parsing the entry is deferred until it's used.
  */
 static int
-SDL_PrivateGameControllerAddMapping(const char *mappingString, SDL_ControllerMappingPriority priority)
+SDL_PrivateGameControllerAddMapping(const char *mappingString, const char *source, SDL_ControllerMappingPriority priority)
 {
-    char *pchGUID;
+    char pchGUID[64];
     SDL_JoystickGUID jGUID;
     SDL_bool is_default_mapping = SDL_FALSE;
     SDL_bool is_hidapi_mapping = SDL_FALSE;
@@ -1146,8 +1478,7 @@ SDL_PrivateGameControllerAddMapping(const char *mappingString, SDL_ControllerMap
         return SDL_InvalidParamError("mappingString");
     }
 
-    pchGUID = SDL_PrivateGetControllerGUIDFromMappingString(mappingString);
-    if (!pchGUID) {
+    if (!SDL_PrivateGetControllerGUIDFromMappingString(mappingString, pchGUID, sizeof(pchGUID))) {
         return SDL_SetError("Couldn't parse GUID from %s", mappingString);
     }
     if (!SDL_strcasecmp(pchGUID, "default")) {
@@ -1158,9 +1489,8 @@ SDL_PrivateGameControllerAddMapping(const char *mappingString, SDL_ControllerMap
         is_xinput_mapping = SDL_TRUE;
     }
     jGUID = SDL_JoystickGetGUIDFromString(pchGUID);
-    SDL_free(pchGUID);
 
-    pControllerMapping = SDL_PrivateAddMappingForGUID(jGUID, mappingString, &existing, priority);
+    pControllerMapping = SDL_PrivateAddMappingForGUID(jGUID, mappingString, source, &existing, priority);
     if (!pControllerMapping) {
         return -1;
     }
@@ -1185,7 +1515,7 @@ SDL_PrivateGameControllerAddMapping(const char *mappingString, SDL_ControllerMap
 int
 SDL_GameControllerAddMapping(const char *mappingString)
 {
-    return SDL_PrivateGameControllerAddMapping(mappingString, SDL_CONTROLLER_MAPPING_PRIORITY_API);
+    return SDL_PrivateGameControllerAddMapping(mappingString, NULL, SDL_CONTROLLER_MAPPING_PRIORITY_API);
 }
 
 /*
@@ -1223,6 +1553,9 @@ SDL_GameControllerMappingForIndex(int mapping_index)
             char pchGUID[33];
             size_t needed;
 
+            if (!SDL_PrivateParseControllerMapping(mapping)) {
+                return NULL;
+            }
             SDL_JoystickGetGUIDString(mapping->guid, pchGUID, sizeof(pchGUID));
             /* allocate enough memory for GUID + ',' + name + ',' + mapping + \0 */
             needed = SDL_strlen(pchGUID) + 1 + SDL_strlen(mapping->name) + 1 + SDL_strlen(mapping->mapping) + 1;
@@ -1247,7 +1580,7 @@ SDL_GameControllerMappingForGUID(SDL_JoystickGUID guid)
 {
     char *pMappingString = NULL;
     ControllerMapping_t *mapping = SDL_PrivateGetControllerMappingForGUID(&guid, SDL_FALSE);
-    if (mapping) {
+    if (mapping && SDL_PrivateParseControllerMapping(mapping)) {
         char pchGUID[33];
         size_t needed;
         SDL_JoystickGetGUIDString(guid, pchGUID, sizeof(pchGUID));
@@ -1293,7 +1626,7 @@ SDL_GameControllerLoadHints()
             if (pchNewLine)
                 *pchNewLine = '\0';
 
-            SDL_PrivateGameControllerAddMapping(pUserMappings, SDL_CONTROLLER_MAPPING_PRIORITY_USER);
+            SDL_PrivateGameControllerAddMapping(pUserMappings, NULL, SDL_CONTROLLER_MAPPING_PRIORITY_USER);
 
             if (pchNewLine) {
                 pUserMappings = pchNewLine + 1;
@@ -1333,14 +1666,15 @@ SDL_GameControllerInitMappings(void)
     const char *pMappingString = NULL;
     pMappingString = s_ControllerMappings[i];
     while (pMappingString) {
-        SDL_PrivateGameControllerAddMapping(pMappingString, SDL_CONTROLLER_MAPPING_PRIORITY_DEFAULT);
+        /* The built-in mappings are static, so they're parsed when used */
+        SDL_PrivateGameControllerAddMapping(pMappingString, pMappingString, SDL_CONTROLLER_MAPPING_PRIORITY_DEFAULT);
 
         i++;
         pMappingString = s_ControllerMappings[i];
     }
 
     if (SDL_GetControllerMappingFilePath(szControllerMapPath, sizeof(szControllerMapPath))) {
-        SDL_GameControllerAddMappingsFromFile(szControllerMapPath);        
+        SDL_GameControllerAddMappingsFromRW(SDL_RWFromFileMapped(szControllerMapPath), 1);
     }
 
     /* load in any user supplied config */
@@ -1360,7 +1694,7 @@ SDL_GameControllerInit(void)
     int i;
 
     /* watch for joy events and fire controller ones if needed */
-    SDL_AddEventWatch(SDL_GameControllerEventWatcher, NULL);
+    SDL_AddEventWatchRange(SDL_GameControllerEventWatcher, NULL, SDL_JOYAXISMOTION, SDL_JOYDEVICEREMOVED);
 
     /* Send added events for controllers currently attached */
     for (i = 0; i < SDL_NumJoysticks(); ++i) {
@@ -1519,22 +1853,17 @@ SDL_GameControllerOpen(int device_index)
 {
     SDL_JoystickID instance_id;
     SDL_GameController *gamecontroller;
-    SDL_GameController *gamecontrollerlist;
     ControllerMapping_t *pSupportedController = NULL;
 
     SDL_LockJoysticks();
 
-    gamecontrollerlist = SDL_gamecontrollers;
     /* If the controller is already open, return it */
     instance_id = SDL_JoystickGetDeviceInstanceID(device_index);
-    while (gamecontrollerlist) {
-        if (instance_id == gamecontrollerlist->joystick->instance_id) {
-                gamecontroller = gamecontrollerlist;
-                ++gamecontroller->ref_count;
-                SDL_UnlockJoysticks();
-                return (gamecontroller);
-        }
-        gamecontrollerlist = gamecontrollerlist->next;
+    gamecontroller = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, instance_id);
+    if (gamecontroller) {
+        ++gamecontroller->ref_count;
+        SDL_UnlockJoysticks();
+        return (gamecontroller);
     }
 
     /* Find a controller mapping */
@@ -1582,8 +1911,39 @@ SDL_GameControllerOpen(int device_index)
         }
     }
 
+    gamecontroller->axis_inputs = (SDL_GameControllerBindList *)SDL_calloc(gamecontroller->joystick->naxes + 1, sizeof(*gamecontroller->axis_inputs));
+    gamecontroller->button_inputs = (SDL_GameControllerBindList *)SDL_calloc(gamecontroller->joystick->nbuttons + 1, sizeof(*gamecontroller->button_inputs));
+    gamecontroller->hat_inputs = (SDL_GameControllerBindList *)SDL_calloc(gamecontroller->joystick->nhats + 1, sizeof(*gamecontroller->hat_inputs));
+    if (!gamecontroller->axis_inputs || !gamecontroller->button_inputs || !gamecontroller->hat_inputs) {
+        SDL_OutOfMemory();
+        SDL_JoystickClose(gamecontroller->joystick);
+        SDL_free(gamecontroller->axis_inputs);
+        SDL_free(gamecontroller->button_inputs);
+        SDL_free(gamecontroller->hat_inputs);
+        SDL_free(gamecontroller->last_match_axis);
+        SDL_free(gamecontroller->last_hat_mask);
+        SDL_free(gamecontroller);
+        SDL_UnlockJoysticks();
+        return NULL;
+    }
+
     SDL_PrivateLoadButtonMapping(gamecontroller, pSupportedController->name, pSupportedController->mapping);
 
+    if (SDL_PrivateJoystickRegistryAdd(&SDL_gamecontroller_registry, gamecontroller->joystick->instance_id, gamecontroller, NULL) < 0) {
+        SDL_JoystickClose(gamecontroller->joystick);
+        SDL_free(gamecontroller->bindings);
+        SDL_free(gamecontroller->compiled);
+        SDL_free(gamecontroller->bind_order);
+        SDL_free(gamecontroller->axis_inputs);
+        SDL_free(gamecontroller->button_inputs);
+        SDL_free(gamecontroller->hat_inputs);
+        SDL_free(gamecontroller->last_match_axis);
+        SDL_free(gamecontroller->last_hat_mask);
+        SDL_free(gamecontroller);
+        SDL_UnlockJoysticks();
+        return NULL;
+    }
+
     /* Add the controller to list */
     ++gamecontroller->ref_count;
     /* Link the controller in the list */
@@ -1612,52 +1972,38 @@ Sint16
 SDL_GameControllerGetAxis(SDL_GameController * gamecontroller, SDL_GameControllerAxis axis)
 {
     int i;
+    const SDL_GameControllerBindList *list;
 
-    if (!gamecontroller)
+    if (!gamecontroller || axis < 0 || axis >= SDL_CONTROLLER_AXIS_MAX)
         return 0;
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS && binding->output.axis.axis == axis) {
-            int value = 0;
-            SDL_bool valid_input_range;
-            SDL_bool valid_output_range;
-
-            if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                value = SDL_JoystickGetAxis(gamecontroller->joystick, binding->input.axis.axis);
-                if (binding->input.axis.axis_min < binding->input.axis.axis_max) {
-                    valid_input_range = (value >= binding->input.axis.axis_min && value <= binding->input.axis.axis_max);
-                } else {
-                    valid_input_range = (value >= binding->input.axis.axis_max && value <= binding->input.axis.axis_min);
-                }
-                if (valid_input_range) {
-                    if (binding->input.axis.axis_min != binding->output.axis.axis_min || binding->input.axis.axis_max != binding->output.axis.axis_max) {
-                        float normalized_value = (float)(value - binding->input.axis.axis_min) / (binding->input.axis.axis_max - binding->input.axis.axis_min);
-                        value = binding->output.axis.axis_min + (int)(normalized_value * (binding->output.axis.axis_max - binding->output.axis.axis_min));
-                    }
-                }
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
-                value = SDL_JoystickGetButton(gamecontroller->joystick, binding->input.button);
-                if (value == SDL_PRESSED) {
-                    value = binding->output.axis.axis_max;
-                }
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
-                int hat_mask = SDL_JoystickGetHat(gamecontroller->joystick, binding->input.hat.hat);
-                if (hat_mask & binding->input.hat.hat_mask) {
-                    value = binding->output.axis.axis_max;
-                }
-            }
+    list = &gamecontroller->axis_outputs[axis];
+    for (i = 0; i < list->count; ++i) {
+        const SDL_CompiledGameControllerBind *compiled = list->first[i];
+        SDL_ExtendedGameControllerBind *binding = compiled->binding;
+        int value = 0;
 
-            if (binding->output.axis.axis_min < binding->output.axis.axis_max) {
-                valid_output_range = (value >= binding->output.axis.axis_min && value <= binding->output.axis.axis_max);
-            } else {
-                valid_output_range = (value >= binding->output.axis.axis_max && value <= binding->output.axis.axis_min);
+        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            value = SDL_JoystickGetAxis(gamecontroller->joystick, binding->input.axis.axis);
+            if (InInputRange(compiled, value)) {
+                value = ScaleAxisValue(compiled, value);
+            }
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+            value = SDL_JoystickGetButton(gamecontroller->joystick, binding->input.button);
+            if (value == SDL_PRESSED) {
+                value = binding->output.axis.axis_max;
             }
-            /* If the value is zero, there might be another binding that makes it non-zero */
-            if (value != 0 && valid_output_range) {
-                return (Sint16)value;
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
+            int hat_mask = SDL_JoystickGetHat(gamecontroller->joystick, binding->input.hat.hat);
+            if (hat_mask & binding->input.hat.hat_mask) {
+                value = binding->output.axis.axis_max;
             }
         }
+
+        /* If the value is zero, there might be another binding that makes it non-zero */
+        if (value != 0 && value >= compiled->output_min && value <= compiled->output_max) {
+            return (Sint16)value;
+        }
     }
     return 0;
 }
@@ -1669,35 +2015,26 @@ Uint8
 SDL_GameControllerGetButton(SDL_GameController * gamecontroller, SDL_GameControllerButton button)
 {
     int i;
+    const SDL_GameControllerBindList *list;
 
-    if (!gamecontroller)
+    if (!gamecontroller || button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX)
         return 0;
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_BUTTON && binding->output.button == button) {
-            if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                SDL_bool valid_input_range;
-
-                int value = SDL_JoystickGetAxis(gamecontroller->joystick, binding->input.axis.axis);
-                int threshold = binding->input.axis.axis_min + (binding->input.axis.axis_max - binding->input.axis.axis_min) / 2;
-                if (binding->input.axis.axis_min < binding->input.axis.axis_max) {
-                    valid_input_range = (value >= binding->input.axis.axis_min && value <= binding->input.axis.axis_max);
-                    if (valid_input_range) {
-                        return (value >= threshold) ? SDL_PRESSED : SDL_RELEASED;
-                    }
-                } else {
-                    valid_input_range = (value >= binding->input.axis.axis_max && value <= binding->input.axis.axis_min);
-                    if (valid_input_range) {
-                        return (value <= threshold) ? SDL_PRESSED : SDL_RELEASED;
-                    }
-                }
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
-                return SDL_JoystickGetButton(gamecontroller->joystick, binding->input.button);
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
-                int hat_mask = SDL_JoystickGetHat(gamecontroller->joystick, binding->input.hat.hat);
-                return (hat_mask & binding->input.hat.hat_mask) ? SDL_PRESSED : SDL_RELEASED;
+    list = &gamecontroller->button_outputs[button];
+    for (i = 0; i < list->count; ++i) {
+        const SDL_CompiledGameControllerBind *compiled = list->first[i];
+        SDL_ExtendedGameControllerBind *binding = compiled->binding;
+
+        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            int value = SDL_JoystickGetAxis(gamecontroller->joystick, binding->input.axis.axis);
+            if (InInputRange(compiled, value)) {
+                return AxisButtonState(compiled, value);
             }
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+            return SDL_JoystickGetButton(gamecontroller->joystick, binding->input.button);
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
+            int hat_mask = SDL_JoystickGetHat(gamecontroller->joystick, binding->input.hat.hat);
+            return (hat_mask & binding->input.hat.hat_mask) ? SDL_PRESSED : SDL_RELEASED;
         }
     }
     return SDL_RELEASED;
@@ -1774,16 +2111,9 @@ SDL_GameControllerFromInstanceID(SDL_JoystickID joyid)
     SDL_GameController *gamecontroller;
 
     SDL_LockJoysticks();
-    gamecontroller = SDL_gamecontrollers;
-    while (gamecontroller) {
-        if (gamecontroller->joystick->instance_id == joyid) {
-            SDL_UnlockJoysticks();
-            return gamecontroller;
-        }
-        gamecontroller = gamecontroller->next;
-    }
+    gamecontroller = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, joyid);
     SDL_UnlockJoysticks();
-    return NULL;
+    return gamecontroller;
 }
 
 
@@ -1792,27 +2122,24 @@ SDL_GameControllerFromInstanceID(SDL_JoystickID joyid)
  */
 SDL_GameControllerButtonBind SDL_GameControllerGetBindForAxis(SDL_GameController * gamecontroller, SDL_GameControllerAxis axis)
 {
-    int i;
     SDL_GameControllerButtonBind bind;
     SDL_zero(bind);
 
-    if (!gamecontroller || axis == SDL_CONTROLLER_AXIS_INVALID)
+    if (!gamecontroller || axis < 0 || axis >= SDL_CONTROLLER_AXIS_MAX)
         return bind;
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_AXIS && binding->output.axis.axis == axis) {
-            bind.bindType = binding->inputType;
-            if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                /* FIXME: There might be multiple axes bound now that we have axis ranges... */
-                bind.value.axis = binding->input.axis.axis;
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
-                bind.value.button = binding->input.button;
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
-                bind.value.hat.hat = binding->input.hat.hat;
-                bind.value.hat.hat_mask = binding->input.hat.hat_mask;
-            }
-            break;
+    if (gamecontroller->axis_outputs[axis].count > 0) {
+        SDL_ExtendedGameControllerBind *binding = gamecontroller->axis_outputs[axis].first[0]->binding;
+
+        bind.bindType = binding->inputType;
+        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            /* FIXME: There might be multiple axes bound now that we have axis ranges... */
+            bind.value.axis = binding->input.axis.axis;
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+            bind.value.button = binding->input.button;
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
+            bind.value.hat.hat = binding->input.hat.hat;
+            bind.value.hat.hat_mask = binding->input.hat.hat_mask;
         }
     }
     return bind;
@@ -1824,26 +2151,23 @@ SDL_GameControllerButtonBind SDL_GameControllerGetBindForAxis(SDL_GameController
  */
 SDL_GameControllerButtonBind SDL_GameControllerGetBindForButton(SDL_GameController * gamecontroller, SDL_GameControllerButton button)
 {
-    int i;
     SDL_GameControllerButtonBind bind;
     SDL_zero(bind);
 
-    if (!gamecontroller || button == SDL_CONTROLLER_BUTTON_INVALID)
+    if (!gamecontroller || button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX)
         return bind;
 
-    for (i = 0; i < gamecontroller->num_bindings; ++i) {
-        SDL_ExtendedGameControllerBind *binding = &gamecontroller->bindings[i];
-        if (binding->outputType == SDL_CONTROLLER_BINDTYPE_BUTTON && binding->output.button == button) {
-            bind.bindType = binding->inputType;
-            if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
-                bind.value.axis = binding->input.axis.axis;
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
-                bind.value.button = binding->input.button;
-            } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
-                bind.value.hat.hat = binding->input.hat.hat;
-                bind.value.hat.hat_mask = binding->input.hat.hat_mask;
-            }
-            break;
+    if (gamecontroller->button_outputs[button].count > 0) {
+        SDL_ExtendedGameControllerBind *binding = gamecontroller->button_outputs[button].first[0]->binding;
+
+        bind.bindType = binding->inputType;
+        if (binding->inputType == SDL_CONTROLLER_BINDTYPE_AXIS) {
+            bind.value.axis = binding->input.axis.axis;
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_BUTTON) {
+            bind.value.button = binding->input.button;
+        } else if (binding->inputType == SDL_CONTROLLER_BINDTYPE_HAT) {
+            bind.value.hat.hat = binding->input.hat.hat;
+            bind.value.hat.hat_mask = binding->input.hat.hat_mask;
         }
     }
     return bind;
@@ -1872,6 +2196,7 @@ SDL_GameControllerClose(SDL_GameController * gamecontroller)
         return;
     }
 
+    SDL_PrivateJoystickRegistryRemove(&SDL_gamecontroller_registry, gamecontroller->joystick->instance_id, gamecontroller);
     SDL_JoystickClose(gamecontroller->joystick);
 
     gamecontrollerlist = SDL_gamecontrollers;
@@ -1891,6 +2216,11 @@ SDL_GameControllerClose(SDL_GameController * gamecontroller)
     }
 
     SDL_free(gamecontroller->bindings);
+    SDL_free(gamecontroller->compiled);
+    SDL_free(gamecontroller->bind_order);
+    SDL_free(gamecontroller->axis_inputs);
+    SDL_free(gamecontroller->button_inputs);
+    SDL_free(gamecontroller->hat_inputs);
     SDL_free(gamecontroller->last_match_axis);
     SDL_free(gamecontroller->last_hat_mask);
     SDL_free(gamecontroller);
@@ -1910,6 +2240,7 @@ SDL_GameControllerQuit(void)
         SDL_gamecontrollers->ref_count = 1;
         SDL_GameControllerClose(SDL_gamecontrollers);
     }
+    SDL_PrivateJoystickRegistryFree(&SDL_gamecontroller_registry);
     SDL_UnlockJoysticks();
 }
 
@@ -1917,6 +2248,7 @@ void
 SDL_GameControllerQuitMappings(void)
 {
     ControllerMapping_t *pControllerMap;
+    ControllerMappingDB_t *pMappingDB;
 
     while (s_pSupportedControllers) {
         pControllerMap = s_pSupportedControllers;
@@ -1925,6 +2257,21 @@ SDL_GameControllerQuitMappings(void)
         SDL_free(pControllerMap->mapping);
         SDL_free(pControllerMap);
     }
+    s_pLastController = NULL;
+    SDL_free(s_pMappingHash);
+    s_pMappingHash = NULL;
+    s_nMappingHashSize = 0;
+    s_nMappings = 0;
+
+    while (s_pMappingDBs) {
+        pMappingDB = s_pMappingDBs;
+        s_pMappingDBs = s_pMappingDBs->next;
+        if (pMappingDB->rw) {
+            SDL_RWclose(pMappingDB->rw);
+        }
+        SDL_free(pMappingDB->data);
+        SDL_free(pMappingDB);
+    }
 
     SDL_DelEventWatch(SDL_GameControllerEventWatcher, NULL);
 
@@ -2062,13 +2409,9 @@ SDL_GameControllerEventState(int state)
 void
 SDL_GameControllerHandleDelayedGuideButton(SDL_Joystick *joystick)
 {
-    SDL_GameController *controllerlist = SDL_gamecontrollers;
-    while (controllerlist) {
-        if (controllerlist->joystick == joystick) {
-            SDL_PrivateGameControllerButton(controllerlist, SDL_CONTROLLER_BUTTON_GUIDE, SDL_RELEASED);
-            break;
-        }
-        controllerlist = controllerlist->next;
+    SDL_GameController *controllerlist = (SDL_GameController *)SDL_PrivateJoystickRegistryFind(&SDL_gamecontroller_registry, joystick->instance_id);
+    if (controllerlist && controllerlist->joystick == joystick) {
+        SDL_PrivateGameControllerButton(controllerlist, SDL_CONTROLLER_BUTTON_GUIDE, SDL_RELEASED);
     }
 }
 
@@ -82,6 +82,7 @@ static SDL_JoystickDriver *SDL_joystick_drivers[] = {
 };
 static SDL_bool SDL_joystick_allows_background_events = SDL_FALSE;
 static SDL_Joystick *SDL_joysticks = NULL;
+static SDL_JoystickRegistry SDL_joystick_registry;
 static SDL_bool SDL_updating_joystick = SDL_FALSE;
 static SDL_mutex *SDL_joystick_lock = NULL; /* This needs to support recursive locks */
 static SDL_atomic_t SDL_next_joystick_instance_id;
@@ -168,6 +169,379 @@ SDL_JoystickID SDL_GetNextJoystickInstanceID()
     return SDL_AtomicIncRef(&SDL_next_joystick_instance_id);
 }
 
+#define SDL_JOYSTICK_REGISTRY_MIN   16
+
+/* Items live in slots that never move, so a handle can be checked without
+   looking anything up.  The generation is odd while the slot is in use, and
+   changes whenever an item is added or removed. */
+struct _SDL_JoystickRegistrySlot
+{
+    SDL_atomic_t generation;
+    SDL_JoystickID instance_id;
+    void *item;
+    int next_free;              /* Slot number + 1 of the next free slot, or 0 */
+};
+
+/* Maps instance IDs to slots.  An entry is 0 if it was never used, the slot
+   number + 1, or SDL_JOYSTICK_REGISTRY_REMOVED. */
+struct _SDL_JoystickRegistryTable
+{
+    int size;                   /* A power of two */
+    int used;                   /* The number of entries that aren't 0 */
+    int retired_epoch;          /* The epoch the table was replaced in */
+    SDL_JoystickRegistryTable *next_retired;
+    SDL_atomic_t entries[1];
+};
+
+#define SDL_JOYSTICK_REGISTRY_REMOVED   -1
+
+/* Each thread that looks things up has a record of its own saying which
+   epoch its lookup started in, so lookups don't write any shared memory.
+   A replaced table is freed once no lookup started before it was replaced.
+   Records are reused by new threads and kept until the program exits. */
+typedef struct _SDL_JoystickRegistryReader
+{
+    SDL_atomic_t epoch;         /* The epoch + 1 while looking something up, or 0 */
+    SDL_atomic_t in_use;        /* Set while a thread owns the record */
+    struct _SDL_JoystickRegistryReader *next;
+} SDL_JoystickRegistryReader;
+
+static SDL_SpinLock SDL_joystick_registry_readers_lock;
+static void *SDL_joystick_registry_readers = NULL;  /* SDL_JoystickRegistryReader, use atomics */
+static SDL_atomic_t SDL_joystick_registry_reader_tls;
+static SDL_atomic_t SDL_joystick_registry_epoch;
+
+static void SDLCALL
+SDL_PrivateJoystickRegistryReleaseReader(void *data)
+{
+    SDL_JoystickRegistryReader *reader = (SDL_JoystickRegistryReader *)data;
+
+    SDL_AtomicSet(&reader->epoch, 0);
+    SDL_AtomicSet(&reader->in_use, 0);
+}
+
+static SDL_JoystickRegistryReader *
+SDL_PrivateJoystickRegistryGetReader(void)
+{
+    SDL_TLSID tls = (SDL_TLSID)SDL_AtomicGet(&SDL_joystick_registry_reader_tls);
+    SDL_JoystickRegistryReader *reader;
+
+    if (tls) {
+        reader = (SDL_JoystickRegistryReader *)SDL_TLSGet(tls);
+        if (reader) {
+            return reader;
+        }
+    }
+
+    SDL_AtomicLock(&SDL_joystick_registry_readers_lock);
+    tls = (SDL_TLSID)SDL_AtomicGet(&SDL_joystick_registry_reader_tls);
+    if (!tls) {
+        tls = SDL_TLSCreate();
+        SDL_AtomicSet(&SDL_joystick_registry_reader_tls, (int)tls);
+    }
+    for (reader = (SDL_JoystickRegistryReader *)SDL_joystick_registry_readers; reader; reader = reader->next) {
+        if (SDL_AtomicCAS(&reader->in_use, 0, 1)) {
+            break;
+        }
+    }
+    if (!reader) {
+        reader = (SDL_JoystickRegistryReader *)SDL_calloc(1, sizeof(*reader));
+        if (reader) {
+            SDL_AtomicSet(&reader->in_use, 1);
+            reader->next = (SDL_JoystickRegistryReader *)SDL_joystick_registry_readers;
+            SDL_AtomicSetPtr(&SDL_joystick_registry_readers, reader);
+        }
+    }
+    SDL_AtomicUnlock(&SDL_joystick_registry_readers_lock);
+
+    if (reader && (!tls || SDL_TLSSet(tls, reader, SDL_PrivateJoystickRegistryReleaseReader) < 0)) {
+        SDL_PrivateJoystickRegistryReleaseReader(reader);
+        reader = NULL;
+    }
+    return reader;
+}
+
+/* Returns the record to pass to SDL_PrivateJoystickRegistryLeave(), or NULL
+   if there isn't one and the joysticks were locked instead */
+static SDL_JoystickRegistryReader *
+SDL_PrivateJoystickRegistryEnter(void)
+{
+    SDL_JoystickRegistryReader *reader = SDL_PrivateJoystickRegistryGetReader();
+
+    if (reader) {
+        SDL_AtomicSet(&reader->epoch, SDL_AtomicGet(&SDL_joystick_registry_epoch) + 1);
+    } else {
+        SDL_LockJoysticks();
+    }
+    return reader;
+}
+
+static void
+SDL_PrivateJoystickRegistryLeave(SDL_JoystickRegistryReader *reader)
+{
+    if (reader) {
+        SDL_AtomicSet(&reader->epoch, 0);
+    } else {
+        SDL_UnlockJoysticks();
+    }
+}
+
+static SDL_INLINE int
+SDL_PrivateJoystickRegistryHome(const SDL_JoystickRegistryTable *table, SDL_JoystickID instance_id)
+{
+    /* Instance IDs are sequential, so they spread out over the table as is */
+    return (int)((Uint32)instance_id & (Uint32)(table->size - 1));
+}
+
+static SDL_INLINE SDL_JoystickRegistrySlot *
+SDL_PrivateJoystickRegistrySlot(const SDL_JoystickRegistry *registry, int slot)
+{
+    return &registry->chunks[slot / SDL_JOYSTICK_REGISTRY_CHUNK_SIZE][slot % SDL_JOYSTICK_REGISTRY_CHUNK_SIZE];
+}
+
+/* Free the replaced tables if no lookup could still be using them */
+static void
+SDL_PrivateJoystickRegistryReclaim(SDL_JoystickRegistry *registry)
+{
+    SDL_JoystickRegistryTable *retired;
+    SDL_JoystickRegistryTable **prev;
+    SDL_JoystickRegistryReader *reader;
+    int oldest;
+
+    if (!registry->retired) {
+        return;
+    }
+
+    /* Lookups set their epoch before they load the table, so one that
+       started in a table's retired epoch or later can't be using it */
+    oldest = SDL_AtomicGet(&SDL_joystick_registry_epoch);
+    for (reader = (SDL_JoystickRegistryReader *)SDL_AtomicGetPtr(&SDL_joystick_registry_readers); reader; reader = reader->next) {
+        const int epoch = SDL_AtomicGet(&reader->epoch);
+        if (epoch && (epoch - 1) < oldest) {
+            oldest = epoch - 1;
+        }
+    }
+
+    prev = &registry->retired;
+    while (*prev) {
+        retired = *prev;
+        if (retired->retired_epoch <= oldest) {
+            *prev = retired->next_retired;
+            SDL_free(retired);
+        } else {
+            prev = &retired->next_retired;
+        }
+    }
+}
+
+static int
+SDL_PrivateJoystickRegistryRebuild(SDL_JoystickRegistry *registry, int count)
+{
+    SDL_JoystickRegistryTable *table = registry->table;
+    SDL_JoystickRegistryTable *new_table;
+    int size = SDL_JOYSTICK_REGISTRY_MIN;
+    int i, entry;
+
+    while (size < count * 2) {
+        size *= 2;
+    }
+
+    new_table = (SDL_JoystickRegistryTable *)SDL_calloc(1, sizeof(*new_table) + (size - 1) * sizeof(new_table->entries[0]));
+    if (!new_table) {
+        return SDL_OutOfMemory();
+    }
+    new_table->size = size;
+
+    if (table) {
+        for (i = 0; i < table->size; ++i) {
+            const int value = SDL_AtomicGet(&table->entries[i]);
+            if (value > 0) {
+                entry = SDL_PrivateJoystickRegistryHome(new_table, SDL_PrivateJoystickRegistrySlot(registry, value - 1)->instance_id);
+                while (SDL_AtomicGet(&new_table->entries[entry])) {
+                    entry = (entry + 1) & (size - 1);
+                }
+                SDL_AtomicSet(&new_table->entries[entry], value);
+                ++new_table->used;
+            }
+        }
+    }
+
+    SDL_AtomicSetPtr((void **)&registry->table, new_table);
+
+    /* The old table can't be freed while lookups might be running */
+    if (table) {
+        table->retired_epoch = SDL_AtomicAdd(&SDL_joystick_registry_epoch, 1) + 1;
+        table->next_retired = registry->retired;
+        registry->retired = table;
+    }
+    return 0;
+}
+
+int
+SDL_PrivateJoystickRegistryAdd(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id, void *item, SDL_JoystickRegistryHandle *handle)
+{
+    SDL_JoystickRegistryTable *table = registry->table;
+    SDL_JoystickRegistrySlot *slot;
+    int number, entry, value;
+
+    if (!registry->free_slot && registry->num_slots == SDL_JOYSTICK_REGISTRY_CHUNKS * SDL_JOYSTICK_REGISTRY_CHUNK_SIZE) {
+        return SDL_SetError("Too many devices are open");
+    }
+
+    if (!table || (table->used + 1) * 4 > table->size * 3) {
+        if (SDL_PrivateJoystickRegistryRebuild(registry, registry->count + 1) < 0) {
+            return -1;
+        }
+        table = registry->table;
+    }
+
+    if (registry->free_slot) {
+        number = registry->free_slot - 1;
+        slot = SDL_PrivateJoystickRegistrySlot(registry, number);
+        registry->free_slot = slot->next_free;
+    } else {
+        number = registry->num_slots;
+        if (!registry->chunks[number / SDL_JOYSTICK_REGISTRY_CHUNK_SIZE]) {
+            SDL_JoystickRegistrySlot *chunk = (SDL_JoystickRegistrySlot *)SDL_calloc(SDL_JOYSTICK_REGISTRY_CHUNK_SIZE, sizeof(*chunk));
+            if (!chunk) {
+                return SDL_OutOfMemory();
+            }
+            registry->chunks[number / SDL_JOYSTICK_REGISTRY_CHUNK_SIZE] = chunk;
+        }
+        ++registry->num_slots;
+        slot = SDL_PrivateJoystickRegistrySlot(registry, number);
+    }
+
+    /* The slot has to be filled in before it's marked as used */
+    slot->instance_id = instance_id;
+    SDL_AtomicSetPtr(&slot->item, item);
+    SDL_AtomicAdd(&slot->generation, 1);
+    if (handle) {
+        handle->slot = number;
+        handle->generation = SDL_AtomicGet(&slot->generation);
+    }
+
+    entry = SDL_PrivateJoystickRegistryHome(table, instance_id);
+    for ( ; ; ) {
+        value = SDL_AtomicGet(&table->entries[entry]);
+        if (value == 0 || value == SDL_JOYSTICK_REGISTRY_REMOVED) {
+            break;
+        }
+        entry = (entry + 1) & (table->size - 1);
+    }
+    if (value == 0) {
+        ++table->used;
+    }
+    SDL_AtomicSet(&table->entries[entry], number + 1);
+    ++registry->count;
+
+    SDL_PrivateJoystickRegistryReclaim(registry);
+    return 0;
+}
+
+void
+SDL_PrivateJoystickRegistryRemove(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id, void *item)
+{
+    SDL_JoystickRegistryTable *table = registry->table;
+    SDL_JoystickRegistrySlot *slot;
+    int i, entry, value;
+
+    if (!table) {
+        return;
+    }
+
+    entry = SDL_PrivateJoystickRegistryHome(table, instance_id);
+    for (i = 0; i < table->size; ++i) {
+        value = SDL_AtomicGet(&table->entries[entry]);
+        if (value == 0) {
+            break;
+        }
+        if (value > 0) {
+            slot = SDL_PrivateJoystickRegistrySlot(registry, value - 1);
+            if (slot->item == item) {
+                SDL_AtomicSet(&table->entries[entry], SDL_JOYSTICK_REGISTRY_REMOVED);
+                SDL_AtomicAdd(&slot->generation, 1);
+                SDL_AtomicSetPtr(&slot->item, NULL);
+                slot->next_free = registry->free_slot;
+                registry->free_slot = value;
+                --registry->count;
+                break;
+            }
+        }
+        entry = (entry + 1) & (table->size - 1);
+    }
+
+    SDL_PrivateJoystickRegistryReclaim(registry);
+}
+
+void *
+SDL_PrivateJoystickRegistryFind(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id)
+{
+    SDL_JoystickRegistryTable *table;
+    SDL_JoystickRegistrySlot *slot;
+    SDL_JoystickRegistryReader *reader;
+    void *found = NULL;
+    int i, entry, value, generation;
+
+    reader = SDL_PrivateJoystickRegistryEnter();
+    table = (SDL_JoystickRegistryTable *)SDL_AtomicGetPtr((void **)&registry->table);
+    if (table) {
+        entry = SDL_PrivateJoystickRegistryHome(table, instance_id);
+        for (i = 0; i < table->size; ++i) {
+            value = SDL_AtomicGet(&table->entries[entry]);
+            if (value == 0) {
+                break;
+            }
+            if (value > 0) {
+                slot = SDL_PrivateJoystickRegistrySlot(registry, value - 1);
+                generation = SDL_AtomicGet(&slot->generation);
+                if ((generation & 1) && slot->instance_id == instance_id) {
+                    void *item = SDL_AtomicGetPtr(&slot->item);
+
+                    /* Make sure the slot wasn't reused while it was being read */
+                    if (SDL_AtomicGet(&slot->generation) == generation) {
+                        found = item;
+                        break;
+                    }
+                }
+            }
+            entry = (entry + 1) & (table->size - 1);
+        }
+    }
+    SDL_PrivateJoystickRegistryLeave(reader);
+    return found;
+}
+
+SDL_bool
+SDL_PrivateJoystickRegistryValid(const SDL_JoystickRegistry *registry, const SDL_JoystickRegistryHandle *handle)
+{
+    const SDL_JoystickRegistrySlot *chunk;
+
+    if (!(handle->generation & 1) || (Uint32)handle->slot >= (Uint32)registry->num_slots) {
+        return SDL_FALSE;
+    }
+    chunk = registry->chunks[handle->slot / SDL_JOYSTICK_REGISTRY_CHUNK_SIZE];
+    return (SDL_AtomicGet((SDL_atomic_t *)&chunk[handle->slot % SDL_JOYSTICK_REGISTRY_CHUNK_SIZE].generation) == handle->generation);
+}
+
+void
+SDL_PrivateJoystickRegistryFree(SDL_JoystickRegistry *registry)
+{
+    SDL_JoystickRegistryTable *retired = registry->retired;
+    int i;
+
+    while (retired) {
+        SDL_JoystickRegistryTable *next = retired->next_retired;
+        SDL_free(retired);
+        retired = next;
+    }
+    SDL_free(registry->table);
+    for (i = 0; i < SDL_arraysize(registry->chunks); ++i) {
+        SDL_free(registry->chunks[i]);
+    }
+    SDL_zerop(registry);
+}
+
 /*
  * Get the driver and device index for an API device index
  * This should be called while the joystick lock is held, to prevent another thread from updating the list
@@ -277,6 +651,91 @@ SDL_JoystickAxesCenteredAtZero(SDL_Joystick *joystick)
     return SDL_FALSE;
 }
 
+/* The snapshot buffers share one allocation, starting with the axes */
+static int
+SDL_AllocJoystickSnapshots(SDL_Joystick * joystick)
+{
+    /* Round each buffer up to pointer alignment so the next one's axes are aligned */
+    const size_t align = sizeof(void *);
+    const size_t size = ((joystick->naxes * sizeof(Sint16) + joystick->nbuttons + joystick->nhats) + (align - 1)) & ~(align - 1);
+    Uint8 *data;
+    int i;
+
+    data = (Uint8 *) SDL_calloc(SDL_arraysize(joystick->snapshots), size ? size : 1);
+    if (!data) {
+        return -1;
+    }
+
+    for (i = 0; i < SDL_arraysize(joystick->snapshots); ++i) {
+        SDL_JoystickSnapshotBuffer *buffer = &joystick->snapshots[i];
+        Uint8 *ptr = data + i * size;
+
+        buffer->axes = (Sint16 *) ptr;
+        ptr += joystick->naxes * sizeof(Sint16);
+        buffer->buttons = ptr;
+        ptr += joystick->nbuttons;
+        buffer->hats = ptr;
+    }
+    joystick->snapshot_dirty = SDL_TRUE;
+    return 0;
+}
+
+static SDL_INLINE void
+SDL_MarkJoystickSnapshotDirty(SDL_Joystick * joystick)
+{
+    const Uint64 hardware_time = SDL_GetEventHardwareTime();
+
+    joystick->snapshot_dirty = SDL_TRUE;
+    if (hardware_time) {
+        joystick->snapshot_time = hardware_time;
+    }
+}
+
+/* Writes the back buffer like a seqlock, and then makes it the front one */
+static void
+SDL_PublishJoystickSnapshot(SDL_Joystick * joystick)
+{
+    const int back = !SDL_AtomicGet(&joystick->snapshot_front);
+    SDL_JoystickSnapshotBuffer *buffer = &joystick->snapshots[back];
+    int i;
+
+    if (!joystick->snapshot_dirty) {
+        return;
+    }
+
+    SDL_AtomicAdd(&buffer->lock, 1);
+    buffer->sequence = ++joystick->snapshot_sequence;
+    buffer->timestamp = joystick->snapshot_time ? joystick->snapshot_time : SDL_GetEventTimeNS();
+    for (i = 0; i < joystick->naxes; ++i) {
+        buffer->axes[i] = joystick->axes[i].value;
+    }
+    if (joystick->nbuttons > 0) {
+        SDL_memcpy(buffer->buttons, joystick->buttons, joystick->nbuttons);
+    }
+    if (joystick->nhats > 0) {
+        SDL_memcpy(buffer->hats, joystick->hats, joystick->nhats);
+    }
+    SDL_AtomicAdd(&buffer->lock, 1);
+
+    SDL_AtomicSet(&joystick->snapshot_front, back);
+    joystick->snapshot_dirty = SDL_FALSE;
+    joystick->snapshot_time = 0;
+}
+
+/* Free a joystick that failed to open before it was registered or linked in the list */
+static void
+SDL_FreeUnpublishedJoystick(SDL_Joystick * joystick)
+{
+    joystick->driver->Close(joystick);
+    SDL_free(joystick->name);
+    SDL_free(joystick->axes);
+    SDL_free(joystick->hats);
+    SDL_free(joystick->balls);
+    SDL_free(joystick->buttons);
+    SDL_free(joystick->snapshots[0].axes);
+    SDL_free(joystick);
+}
+
 /*
  * Open a joystick for use - the index passed as an argument refers to
  * the N'th joystick on the system.  This index is the value which will
@@ -290,7 +749,6 @@ SDL_JoystickOpen(int device_index)
     SDL_JoystickDriver *driver;
     SDL_JoystickID instance_id;
     SDL_Joystick *joystick;
-    SDL_Joystick *joysticklist;
     const char *joystickname = NULL;
 
     SDL_LockJoysticks();
@@ -300,19 +758,15 @@ SDL_JoystickOpen(int device_index)
         return NULL;
     }
 
-    joysticklist = SDL_joysticks;
     /* If the joystick is already open, return it
      * it is important that we have a single joystick * for each instance id
      */
     instance_id = driver->GetDeviceInstanceID(device_index);
-    while (joysticklist) {
-        if (instance_id == joysticklist->instance_id) {
-                joystick = joysticklist;
-                ++joystick->ref_count;
-                SDL_UnlockJoysticks();
-                return joystick;
-        }
-        joysticklist = joysticklist->next;
+    joystick = (SDL_Joystick *)SDL_PrivateJoystickRegistryFind(&SDL_joystick_registry, instance_id);
+    if (joystick) {
+        ++joystick->ref_count;
+        SDL_UnlockJoysticks();
+        return joystick;
     }
 
     /* Create and initialize the joystick */
@@ -354,12 +808,13 @@ SDL_JoystickOpen(int device_index)
     if (joystick->nbuttons > 0) {
         joystick->buttons = (Uint8 *) SDL_calloc(joystick->nbuttons, sizeof(Uint8));
     }
-    if (((joystick->naxes > 0) && !joystick->axes)
+    if (SDL_AllocJoystickSnapshots(joystick) < 0
+        || ((joystick->naxes > 0) && !joystick->axes)
         || ((joystick->nhats > 0) && !joystick->hats)
         || ((joystick->nballs > 0) && !joystick->balls)
         || ((joystick->nbuttons > 0) && !joystick->buttons)) {
         SDL_OutOfMemory();
-        SDL_JoystickClose(joystick);
+        SDL_FreeUnpublishedJoystick(joystick);
         SDL_UnlockJoysticks();
         return NULL;
     }
@@ -376,7 +831,13 @@ SDL_JoystickOpen(int device_index)
 
     joystick->is_game_controller = SDL_IsGameController(device_index);
 
-    /* Add joystick to list */
+    /* Publish the joystick only once it's complete, it can be updated and
+       looked up from now on */
+    if (SDL_PrivateJoystickRegistryAdd(&SDL_joystick_registry, instance_id, joystick, &joystick->registry_handle) < 0) {
+        SDL_FreeUnpublishedJoystick(joystick);
+        SDL_UnlockJoysticks();
+        return NULL;
+    }
     ++joystick->ref_count;
     /* Link the joystick in the list */
     joystick->next = SDL_joysticks;
@@ -401,6 +862,9 @@ SDL_PrivateJoystickValid(SDL_Joystick * joystick)
     if (joystick == NULL) {
         SDL_SetError("Joystick hasn't been opened yet");
         valid = 0;
+    } else if (!SDL_PrivateJoystickRegistryValid(&SDL_joystick_registry, &joystick->registry_handle)) {
+        SDL_SetError("Invalid joystick");
+        valid = 0;
     } else {
         valid = 1;
     }
@@ -563,6 +1027,50 @@ SDL_JoystickGetButton(SDL_Joystick * joystick, int button)
     return state;
 }
 
+/*
+ * Get a consistent copy of the joystick state
+ */
+int
+SDL_JoystickGetSnapshot(SDL_Joystick * joystick, SDL_JoystickSnapshot * snapshot)
+{
+    SDL_JoystickSnapshotBuffer *buffer;
+    int lock;
+
+    if (!SDL_PrivateJoystickValid(joystick)) {
+        return -1;
+    }
+    if (!snapshot) {
+        return SDL_InvalidParamError("snapshot");
+    }
+
+    /* Retry if the buffer was rewritten while it was copied, which takes
+       two updates while we're reading */
+    for (;;) {
+        buffer = &joystick->snapshots[SDL_AtomicGet(&joystick->snapshot_front)];
+        lock = SDL_AtomicGet(&buffer->lock);
+        if (lock & 1) {
+            continue;
+        }
+
+        snapshot->sequence = buffer->sequence;
+        snapshot->timestamp = buffer->timestamp;
+        if (snapshot->axes && joystick->naxes > 0) {
+            SDL_memcpy(snapshot->axes, buffer->axes, joystick->naxes * sizeof(Sint16));
+        }
+        if (snapshot->buttons && joystick->nbuttons > 0) {
+            SDL_memcpy(snapshot->buttons, buffer->buttons, joystick->nbuttons);
+        }
+        if (snapshot->hats && joystick->nhats > 0) {
+            SDL_memcpy(snapshot->hats, buffer->hats, joystick->nhats);
+        }
+
+        SDL_MemoryBarrierAcquire();
+        if (SDL_AtomicGet(&buffer->lock) == lock) {
+            return 0;
+        }
+    }
+}
+
 /*
  * Return if the joystick in question is currently attached to the system,
  *  \return SDL_FALSE if not plugged in, SDL_TRUE if still present.
@@ -599,11 +1107,7 @@ SDL_JoystickFromInstanceID(SDL_JoystickID joyid)
     SDL_Joystick *joystick;
 
     SDL_LockJoysticks();
-    for (joystick = SDL_joysticks; joystick; joystick = joystick->next) {
-        if (joystick->instance_id == joyid) {
-            break;
-        }
-    }
+    joystick = (SDL_Joystick *)SDL_PrivateJoystickRegistryFind(&SDL_joystick_registry, joyid);
     SDL_UnlockJoysticks();
     return joystick;
 }
@@ -668,6 +1172,8 @@ SDL_JoystickClose(SDL_Joystick * joystick)
     joystick->driver->Close(joystick);
     joystick->hwdata = NULL;
 
+    SDL_PrivateJoystickRegistryRemove(&SDL_joystick_registry, joystick->instance_id, joystick);
+
     joysticklist = SDL_joysticks;
     joysticklistprev = NULL;
     while (joysticklist) {
@@ -691,6 +1197,7 @@ SDL_JoystickClose(SDL_Joystick * joystick)
     SDL_free(joystick->hats);
     SDL_free(joystick->balls);
     SDL_free(joystick->buttons);
+    SDL_free(joystick->snapshots[0].axes);
     SDL_free(joystick);
 
     SDL_UnlockJoysticks();
@@ -711,6 +1218,7 @@ SDL_JoystickQuit(void)
         SDL_joysticks->ref_count = 1;
         SDL_JoystickClose(SDL_joysticks);
     }
+    SDL_PrivateJoystickRegistryFree(&SDL_joystick_registry);
 
     /* Quit the joystick setup */
     for (i = 0; i < SDL_arraysize(SDL_joystick_drivers); ++i) {
@@ -818,12 +1326,10 @@ void SDL_PrivateJoystickRemoved(SDL_JoystickID device_instance)
 #endif /* !SDL_EVENTS_DISABLED */
 
     /* Mark this joystick as no longer attached */
-    for (joystick = SDL_joysticks; joystick; joystick = joystick->next) {
-        if (joystick->instance_id == device_instance) {
-            joystick->attached = SDL_FALSE;
-            joystick->force_recentering = SDL_TRUE;
-            break;
-        }
+    joystick = (SDL_Joystick *)SDL_PrivateJoystickRegistryFind(&SDL_joystick_registry, device_instance);
+    if (joystick) {
+        joystick->attached = SDL_FALSE;
+        joystick->force_recentering = SDL_TRUE;
     }
 }
 
@@ -868,6 +1374,7 @@ SDL_PrivateJoystickAxis(SDL_Joystick * joystick, Uint8 axis, Sint16 value)
 
     /* Update internal joystick state */
     joystick->axes[axis].value = value;
+    SDL_MarkJoystickSnapshotDirty(joystick);
 
     /* Post the event, if desired */
     posted = 0;
@@ -908,6 +1415,7 @@ SDL_PrivateJoystickHat(SDL_Joystick * joystick, Uint8 hat, Uint8 value)
 
     /* Update internal joystick state */
     joystick->hats[hat] = value;
+    SDL_MarkJoystickSnapshotDirty(joystick);
 
     /* Post the event, if desired */
     posted = 0;
@@ -998,6 +1506,7 @@ SDL_PrivateJoystickButton(SDL_Joystick * joystick, Uint8 button, Uint8 state)
 
     /* Update internal joystick state */
     joystick->buttons[button] = state;
+    SDL_MarkJoystickSnapshotDirty(joystick);
 
     /* Post the event, if desired */
     posted = 0;
@@ -1058,6 +1567,8 @@ SDL_JoystickUpdate(void)
 
             joystick->force_recentering = SDL_FALSE;
         }
+
+        SDL_PublishJoystickSnapshot(joystick);
     }
 
     SDL_LockJoysticks();
@@ -25,6 +25,7 @@
 #include "../SDL_internal.h"
 
 /* Useful functions and variables from SDL_joystick.c */
+#include "SDL_atomic.h"
 #include "SDL_joystick.h"
 
 struct _SDL_JoystickDriver;
@@ -101,6 +102,41 @@ extern void SDL_PrivateJoystickBatteryLevel(SDL_Joystick * joystick,
 /* Internal sanity checking functions */
 extern int SDL_PrivateJoystickValid(SDL_Joystick * joystick);
 
+/* A table of open devices indexed by instance ID.  Items are only added and
+   removed with the joysticks locked, but can be looked up from any thread
+   without locking.  Each item gets a slot that doesn't move while it's
+   registered, and a handle to the slot checks that the item is still there
+   without touching the item.
+ */
+typedef struct _SDL_JoystickRegistrySlot SDL_JoystickRegistrySlot;
+typedef struct _SDL_JoystickRegistryTable SDL_JoystickRegistryTable;
+
+#define SDL_JOYSTICK_REGISTRY_CHUNK_SIZE    64
+#define SDL_JOYSTICK_REGISTRY_CHUNKS        64
+
+typedef struct _SDL_JoystickRegistryHandle
+{
+    int slot;
+    int generation;             /* Changes when the slot is reused */
+} SDL_JoystickRegistryHandle;
+
+typedef struct _SDL_JoystickRegistry
+{
+    SDL_JoystickRegistrySlot *chunks[SDL_JOYSTICK_REGISTRY_CHUNKS];
+    int num_slots;
+    int free_slot;              /* Slot number + 1 of the first free slot, or 0 */
+    SDL_JoystickRegistryTable *table;
+    SDL_JoystickRegistryTable *retired; /* Replaced tables, lookups might still be using them */
+    int count;
+} SDL_JoystickRegistry;
+
+/* The handle may be NULL if the caller doesn't need to check the item later */
+extern int SDL_PrivateJoystickRegistryAdd(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id, void *item, SDL_JoystickRegistryHandle *handle);
+extern void SDL_PrivateJoystickRegistryRemove(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id, void *item);
+extern void *SDL_PrivateJoystickRegistryFind(SDL_JoystickRegistry *registry, SDL_JoystickID instance_id);
+extern SDL_bool SDL_PrivateJoystickRegistryValid(const SDL_JoystickRegistry *registry, const SDL_JoystickRegistryHandle *handle);
+extern void SDL_PrivateJoystickRegistryFree(SDL_JoystickRegistry *registry);
+
 #endif /* SDL_joystick_c_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
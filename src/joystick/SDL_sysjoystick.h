@@ -25,6 +25,7 @@
 
 /* This is the system specific header for the SDL joystick API */
 
+#include "SDL_atomic.h"
 #include "SDL_joystick.h"
 #include "SDL_joystick_c.h"
 
@@ -38,9 +39,21 @@ typedef struct _SDL_JoystickAxisInfo
     SDL_bool sent_initial_value; /* Whether we've sent the initial axis value */
 } SDL_JoystickAxisInfo;
 
+/* A copy of the joystick state for SDL_JoystickGetSnapshot() */
+typedef struct _SDL_JoystickSnapshotBuffer
+{
+    SDL_atomic_t lock;          /* Odd while the buffer is being written */
+    Uint32 sequence;
+    Uint64 timestamp;
+    Sint16 *axes;
+    Uint8 *buttons;
+    Uint8 *hats;
+} SDL_JoystickSnapshotBuffer;
+
 struct _SDL_Joystick
 {
     SDL_JoystickID instance_id; /* Device instance, monotonically increasing from 0 */
+    SDL_JoystickRegistryHandle registry_handle; /* Checked by SDL_PrivateJoystickValid() */
     char *name;                 /* Joystick name - system dependent */
     int player_index;           /* Joystick player index, or -1 if unavailable */
     SDL_JoystickGUID guid;      /* Joystick guid */
@@ -71,6 +84,13 @@ struct _SDL_Joystick
 
     int ref_count;              /* Reference count for multiple opens */
 
+    /* Only the buffer that isn't the front one is written */
+    SDL_JoystickSnapshotBuffer snapshots[2];
+    SDL_atomic_t snapshot_front;
+    Uint32 snapshot_sequence;
+    Uint64 snapshot_time;       /* The hardware time of the latest change, or 0 */
+    SDL_bool snapshot_dirty;    /* The state changed since it was published */
+
     struct _SDL_Joystick *next; /* pointer to next joystick we have allocated */
 };
 
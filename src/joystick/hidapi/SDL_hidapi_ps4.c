@@ -514,7 +514,7 @@ HIDAPI_DriverPS4_Update(SDL_Joystick *joystick, hid_device *dev, void *context)
     Uint8 data[USB_PACKET_LENGTH];
     int size;
 
-    while ((size = hid_read_timeout(dev, data, sizeof(data), 0)) > 0) {
+    while ((size = HIDAPI_ReadReport(joystick, dev, data, sizeof(data))) > 0) {
         switch (data[0]) {
         case k_EPS4ReportIdUsbState:
             HIDAPI_DriverPS4_HandleStatePacket(joystick, dev, ctx, (PS4StatePacket_t *)&data[1]);
@@ -547,6 +547,32 @@ HIDAPI_DriverPS4_Quit(SDL_Joystick *joystick, hid_device *dev, void *context)
     SDL_free(context);
 }
 
+SDL_bool
+HIDAPI_DriverPS4_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size)
+{
+    int offset;
+
+    if (report[0] != next[0]) {
+        return SDL_FALSE;
+    }
+    if (report[0] == k_EPS4ReportIdUsbState) {
+        offset = 1;
+    } else if (report[0] == k_EPS4ReportIdBluetoothState) {
+        offset = 3;
+    } else {
+        return SDL_FALSE;
+    }
+    offset += 4;    /* rgucButtonsHatAndCounter follows the sticks */
+    if (size < offset + 3 || next_size < offset + 3) {
+        return SDL_FALSE;
+    }
+
+    /* The upper bits of the last byte are a counter */
+    return (report[offset] == next[offset] &&
+            report[offset + 1] == next[offset + 1] &&
+            (report[offset + 2] & 0x03) == (next[offset + 2] & 0x03));
+}
+
 SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverPS4 =
 {
     SDL_HINT_JOYSTICK_HIDAPI_PS4,
@@ -556,7 +582,8 @@ SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverPS4 =
     HIDAPI_DriverPS4_Init,
     HIDAPI_DriverPS4_Rumble,
     HIDAPI_DriverPS4_Update,
-    HIDAPI_DriverPS4_Quit
+    HIDAPI_DriverPS4_Quit,
+    HIDAPI_DriverPS4_IsReportSuperseded
 };
 
 #endif /* SDL_JOYSTICK_HIDAPI_PS4 */
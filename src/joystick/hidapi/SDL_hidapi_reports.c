@@ -0,0 +1,132 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifdef SDL_JOYSTICK_HIDAPI
+
+#include "SDL_hidapi_reports.h"
+
+#define HIDAPI_ReportQueueIsFull(queue, head) \
+    ((head) - (Uint32)SDL_AtomicGet(&(queue)->tail) >= HIDAPI_REPORT_QUEUE_SIZE)
+
+int
+HIDAPI_InitReportQueue(HIDAPI_ReportQueue *queue)
+{
+    SDL_zerop(queue);
+    queue->reports = (HIDAPI_Report *)SDL_malloc(HIDAPI_REPORT_QUEUE_SIZE * sizeof(*queue->reports));
+    if (!queue->reports) {
+        return SDL_OutOfMemory();
+    }
+    queue->space = SDL_CreateSemaphore(0);
+    if (!queue->space) {
+        SDL_free(queue->reports);
+        queue->reports = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void
+HIDAPI_QuitReportQueue(HIDAPI_ReportQueue *queue)
+{
+    SDL_free(queue->reports);
+    if (queue->space) {
+        SDL_DestroySemaphore(queue->space);
+    }
+    SDL_zerop(queue);
+}
+
+HIDAPI_Report *
+HIDAPI_GetFreeReport(HIDAPI_ReportQueue *queue)
+{
+    Uint32 head = (Uint32)SDL_AtomicGet(&queue->head);
+
+    if (HIDAPI_ReportQueueIsFull(queue, head)) {
+        return NULL;
+    }
+    return &queue->reports[head & (HIDAPI_REPORT_QUEUE_SIZE - 1)];
+}
+
+void
+HIDAPI_QueueReport(HIDAPI_ReportQueue *queue)
+{
+    SDL_AtomicAdd(&queue->head, 1);
+}
+
+void
+HIDAPI_WaitForFreeReport(HIDAPI_ReportQueue *queue)
+{
+    Uint32 head = (Uint32)SDL_AtomicGet(&queue->head);
+
+    /* Check again after saying we're waiting, in case a report was just taken */
+    SDL_AtomicSet(&queue->waiting, 1);
+    if (HIDAPI_ReportQueueIsFull(queue, head)) {
+        SDL_SemWait(queue->space);
+    }
+    SDL_AtomicSet(&queue->waiting, 0);
+}
+
+void
+HIDAPI_WakeReportQueue(HIDAPI_ReportQueue *queue)
+{
+    SDL_SemPost(queue->space);
+}
+
+int
+HIDAPI_TakeReport(HIDAPI_ReportQueue *queue, HIDAPI_IsReportSupersededFunc is_superseded, Uint8 *data, size_t size, Uint64 *timestamp)
+{
+    Uint32 head = (Uint32)SDL_AtomicGet(&queue->head);
+    Uint32 tail = (Uint32)SDL_AtomicGet(&queue->tail);
+    const HIDAPI_Report *report;
+    int report_size;
+
+    if (tail == head) {
+        return 0;
+    }
+
+    report = &queue->reports[tail & (HIDAPI_REPORT_QUEUE_SIZE - 1)];
+    if (is_superseded) {
+        while (tail + 1 != head) {
+            const HIDAPI_Report *next = &queue->reports[(tail + 1) & (HIDAPI_REPORT_QUEUE_SIZE - 1)];
+            if (!is_superseded(report->data, report->size, next->data, next->size)) {
+                break;
+            }
+            report = next;
+            ++tail;
+        }
+    }
+
+    report_size = (int)SDL_min((size_t)report->size, size);
+    SDL_memcpy(data, report->data, report_size);
+    if (timestamp) {
+        *timestamp = report->timestamp;
+    }
+
+    SDL_AtomicSet(&queue->tail, (int)(tail + 1));
+    if (SDL_AtomicCAS(&queue->waiting, 1, 0)) {
+        SDL_SemPost(queue->space);
+    }
+    return report_size;
+}
+
+#endif /* SDL_JOYSTICK_HIDAPI */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,105 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_JOYSTICK_HIDAPI_REPORTS_H
+#define SDL_JOYSTICK_HIDAPI_REPORTS_H
+
+/* The queue of input reports between a device's reader thread and the
+   joystick update.  This only uses the public SDL headers, so the queue
+   and the drivers' report checks can be tested on recorded reports. */
+
+#include "SDL_stdinc.h"
+#include "SDL_atomic.h"
+#include "SDL_mutex.h"
+
+/* This is the full set of HIDAPI drivers available */
+#define SDL_JOYSTICK_HIDAPI_PS4
+#define SDL_JOYSTICK_HIDAPI_SWITCH
+#define SDL_JOYSTICK_HIDAPI_XBOX360
+#define SDL_JOYSTICK_HIDAPI_XBOXONE
+
+#ifdef __WINDOWS__
+/* On Windows, Xbox One controllers are handled by the Xbox 360 driver */
+#undef SDL_JOYSTICK_HIDAPI_XBOXONE
+/* It turns out HIDAPI for Xbox controllers doesn't allow background input */
+#undef SDL_JOYSTICK_HIDAPI_XBOX360
+#endif
+
+#ifdef __MACOSX__
+/* On Mac OS X, Xbox One controllers are handled by the Xbox 360 driver */
+#undef SDL_JOYSTICK_HIDAPI_XBOXONE
+#endif
+
+#define HIDAPI_REPORT_QUEUE_SIZE    64      /* Must be a power of two */
+#define HIDAPI_REPORT_MAX_SIZE      128
+
+typedef struct _HIDAPI_Report
+{
+    Uint64 timestamp;
+    int size;
+    Uint8 data[HIDAPI_REPORT_MAX_SIZE];
+} HIDAPI_Report;
+
+/* Returns SDL_TRUE if a queued report can be skipped because the next one
+   replaces it without losing any button changes */
+typedef SDL_bool (*HIDAPI_IsReportSupersededFunc)(const Uint8 *report, int size, const Uint8 *next, int next_size);
+
+/* One thread adds reports and another takes them, without locking */
+typedef struct _HIDAPI_ReportQueue
+{
+    HIDAPI_Report *reports;
+    SDL_atomic_t head;          /* Only written when adding reports */
+    SDL_atomic_t tail;          /* Only written when taking reports */
+    SDL_atomic_t waiting;       /* Set while the queue is full and the adding thread waits */
+    SDL_sem *space;             /* Posted when a report is taken while it waits */
+} HIDAPI_ReportQueue;
+
+extern int HIDAPI_InitReportQueue(HIDAPI_ReportQueue *queue);
+extern void HIDAPI_QuitReportQueue(HIDAPI_ReportQueue *queue);
+
+/* Returns the report to fill in next, or NULL if the queue is full */
+extern HIDAPI_Report *HIDAPI_GetFreeReport(HIDAPI_ReportQueue *queue);
+/* Adds the report returned by HIDAPI_GetFreeReport() to the queue */
+extern void HIDAPI_QueueReport(HIDAPI_ReportQueue *queue);
+/* Waits until the queue has room, or HIDAPI_WakeReportQueue() is called */
+extern void HIDAPI_WaitForFreeReport(HIDAPI_ReportQueue *queue);
+extern void HIDAPI_WakeReportQueue(HIDAPI_ReportQueue *queue);
+
+/* Copies out the next report, skipping it for the one after if that
+   supersedes it.  Returns the size of the report, or 0 if there's none. */
+extern int HIDAPI_TakeReport(HIDAPI_ReportQueue *queue, HIDAPI_IsReportSupersededFunc is_superseded, Uint8 *data, size_t size, Uint64 *timestamp);
+
+#ifdef SDL_JOYSTICK_HIDAPI_PS4
+extern SDL_bool HIDAPI_DriverPS4_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size);
+#endif
+#ifdef SDL_JOYSTICK_HIDAPI_SWITCH
+extern SDL_bool HIDAPI_DriverSwitch_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size);
+#endif
+#ifdef SDL_JOYSTICK_HIDAPI_XBOX360
+extern SDL_bool HIDAPI_DriverXbox360_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size);
+#endif
+#ifdef SDL_JOYSTICK_HIDAPI_XBOXONE
+extern SDL_bool HIDAPI_DriverXboxOne_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size);
+#endif
+
+#endif /* SDL_JOYSTICK_HIDAPI_REPORTS_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -183,6 +183,7 @@ typedef struct
 #pragma pack()
 
 typedef struct {
+    SDL_Joystick *joystick;
     hid_device *dev;
     SDL_bool m_bIsUsingBluetooth;
     Uint8 m_nCommandNumber;
@@ -227,7 +228,7 @@ HIDAPI_DriverSwitch_GetDeviceName(Uint16 vendor_id, Uint16 product_id)
 
 static int ReadInput(SDL_DriverSwitch_Context *ctx)
 {
-    return hid_read_timeout(ctx->dev, ctx->m_rgucReadBuffer, sizeof(ctx->m_rgucReadBuffer), 0);
+    return HIDAPI_ReadReport(ctx->joystick, ctx->dev, ctx->m_rgucReadBuffer, sizeof(ctx->m_rgucReadBuffer));
 }
 
 static int WriteOutput(SDL_DriverSwitch_Context *ctx, Uint8 *data, int size)
@@ -580,6 +581,7 @@ HIDAPI_DriverSwitch_Init(SDL_Joystick *joystick, hid_device *dev, Uint16 vendor_
         SDL_OutOfMemory();
         return SDL_FALSE;
     }
+    ctx->joystick = joystick;
     ctx->dev = dev;
 
     *context = ctx;
@@ -886,6 +888,31 @@ HIDAPI_DriverSwitch_Quit(SDL_Joystick *joystick, hid_device *dev, void *context)
     SDL_free(context);
 }
 
+SDL_bool
+HIDAPI_DriverSwitch_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size)
+{
+    if (report[0] != next[0]) {
+        return SDL_FALSE;
+    }
+
+    switch (report[0]) {
+    case k_eSwitchInputReportIDs_SimpleControllerState:
+        /* The buttons and the stick hat */
+        if (size < 4 || next_size < 4) {
+            return SDL_FALSE;
+        }
+        return (SDL_memcmp(&report[1], &next[1], 3) == 0);
+    case k_eSwitchInputReportIDs_FullControllerState:
+        /* rgucButtons follows the counter and battery level */
+        if (size < 6 || next_size < 6) {
+            return SDL_FALSE;
+        }
+        return (SDL_memcmp(&report[3], &next[3], 3) == 0);
+    default:
+        return SDL_FALSE;
+    }
+}
+
 SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverSwitch =
 {
     SDL_HINT_JOYSTICK_HIDAPI_SWITCH,
@@ -895,7 +922,8 @@ SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverSwitch =
     HIDAPI_DriverSwitch_Init,
     HIDAPI_DriverSwitch_Rumble,
     HIDAPI_DriverSwitch_Update,
-    HIDAPI_DriverSwitch_Quit
+    HIDAPI_DriverSwitch_Quit,
+    HIDAPI_DriverSwitch_IsReportSuperseded
 };
 
 #endif /* SDL_JOYSTICK_HIDAPI_SWITCH */
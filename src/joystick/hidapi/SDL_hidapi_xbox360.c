@@ -711,7 +711,7 @@ HIDAPI_DriverXbox360_Update(SDL_Joystick *joystick, hid_device *dev, void *conte
     Uint8 data[USB_PACKET_LENGTH];
     int size;
 
-    while ((size = hid_read_timeout(dev, data, sizeof(data), 0)) > 0) {
+    while ((size = HIDAPI_ReadReport(joystick, dev, data, sizeof(data))) > 0) {
 #ifdef __WIN32__
         HIDAPI_DriverXbox360_HandleStatePacket(joystick, dev, ctx, data, size);
 #else
@@ -768,6 +768,31 @@ HIDAPI_DriverXbox360_Quit(SDL_Joystick *joystick, hid_device *dev, void *context
     SDL_free(context);
 }
 
+SDL_bool
+HIDAPI_DriverXbox360_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size)
+{
+#ifdef __WIN32__
+    /* State packets are matched up with XInput and Windows.Gaming.Input, keep them all */
+    return SDL_FALSE;
+#else
+    if (report[0] != next[0] || size != next_size) {
+        return SDL_FALSE;
+    }
+
+    switch (report[0]) {
+    case 0x00:
+        return (size >= 4 && report[2] == next[2] && report[3] == next[3]);
+#ifdef __MACOSX__
+    case 0x01:
+        /* The hat and the buttons */
+        return (size >= 17 && SDL_memcmp(&report[13], &next[13], 4) == 0);
+#endif
+    default:
+        return SDL_FALSE;
+    }
+#endif /* __WIN32__ */
+}
+
 SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverXbox360 =
 {
     SDL_HINT_JOYSTICK_HIDAPI_XBOX,
@@ -777,7 +802,8 @@ SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverXbox360 =
     HIDAPI_DriverXbox360_Init,
     HIDAPI_DriverXbox360_Rumble,
     HIDAPI_DriverXbox360_Update,
-    HIDAPI_DriverXbox360_Quit
+    HIDAPI_DriverXbox360_Quit,
+    HIDAPI_DriverXbox360_IsReportSuperseded
 };
 
 #endif /* SDL_JOYSTICK_HIDAPI_XBOX360 */
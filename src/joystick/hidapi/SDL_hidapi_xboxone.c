@@ -273,7 +273,7 @@ HIDAPI_DriverXboxOne_Update(SDL_Joystick *joystick, hid_device *dev, void *conte
     Uint8 data[USB_PACKET_LENGTH];
     int size;
 
-    while ((size = hid_read_timeout(dev, data, sizeof(data), 0)) > 0) {
+    while ((size = HIDAPI_ReadReport(joystick, dev, data, sizeof(data))) > 0) {
         switch (data[0]) {
         case 0x20:
             HIDAPI_DriverXboxOne_HandleStatePacket(joystick, dev, ctx, data, size);
@@ -305,6 +305,19 @@ HIDAPI_DriverXboxOne_Quit(SDL_Joystick *joystick, hid_device *dev, void *context
     SDL_free(context);
 }
 
+SDL_bool
+HIDAPI_DriverXboxOne_IsReportSuperseded(const Uint8 *report, int size, const Uint8 *next, int next_size)
+{
+    /* Mode packets carry the guide button and may need to be acked */
+    if (report[0] != 0x20 || next[0] != 0x20) {
+        return SDL_FALSE;
+    }
+    if (size < 6 || next_size < 6) {
+        return SDL_FALSE;
+    }
+    return (report[4] == next[4] && report[5] == next[5]);
+}
+
 SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverXboxOne =
 {
     SDL_HINT_JOYSTICK_HIDAPI_XBOX,
@@ -314,7 +327,8 @@ SDL_HIDAPI_DeviceDriver SDL_HIDAPI_DriverXboxOne =
     HIDAPI_DriverXboxOne_Init,
     HIDAPI_DriverXboxOne_Rumble,
     HIDAPI_DriverXboxOne_Update,
-    HIDAPI_DriverXboxOne_Quit
+    HIDAPI_DriverXboxOne_Quit,
+    HIDAPI_DriverXboxOne_IsReportSuperseded
 };
 
 #endif /* SDL_JOYSTICK_HIDAPI_XBOXONE */
@@ -31,6 +31,8 @@
 #include "SDL_joystick.h"
 #include "../SDL_sysjoystick.h"
 #include "SDL_hidapijoystick_c.h"
+#include "../../events/SDL_events_c.h"
+#include "../../thread/SDL_systhread.h"
 
 #if defined(__WIN32__)
 #include "../../core/windows/SDL_windows.h"
@@ -50,6 +52,8 @@
 #endif
 #endif
 
+#define HIDAPI_READER_TIMEOUT       50      /* How long closing the device can wait for the reader */
+
 struct joystick_hwdata
 {
     SDL_HIDAPI_DeviceDriver *driver;
@@ -57,6 +61,12 @@ struct joystick_hwdata
 
     SDL_mutex *mutex;
     hid_device *dev;
+
+    /* Reports queued by the reader thread, if there is one */
+    SDL_Thread *reader;
+    SDL_atomic_t reader_quit;
+    SDL_atomic_t reader_error;
+    HIDAPI_ReportQueue reports;
 };
 
 typedef struct _SDL_HIDAPI_Device
@@ -952,6 +962,81 @@ HIDAPI_JoystickGetDeviceInstanceID(int device_index)
     return HIDAPI_GetJoystickByIndex(device_index)->instance_id;
 }
 
+static int SDLCALL
+HIDAPI_ReaderThread(void *data)
+{
+    struct joystick_hwdata *hwdata = (struct joystick_hwdata *)data;
+
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    while (!SDL_AtomicGet(&hwdata->reader_quit)) {
+        HIDAPI_Report *report = HIDAPI_GetFreeReport(&hwdata->reports);
+        int size;
+
+        if (!report) {
+            /* The queue is full, leave reports with the device until there's room */
+            HIDAPI_WaitForFreeReport(&hwdata->reports);
+            continue;
+        }
+
+        size = hid_read_timeout(hwdata->dev, report->data, sizeof(report->data), HIDAPI_READER_TIMEOUT);
+        if (size < 0) {
+            SDL_AtomicSet(&hwdata->reader_error, 1);
+            break;
+        }
+        if (size > 0) {
+            report->size = size;
+            report->timestamp = SDL_GetEventTimeNS();
+            HIDAPI_QueueReport(&hwdata->reports);
+        }
+    }
+    return 0;
+}
+
+static void
+HIDAPI_StartReader(struct joystick_hwdata *hwdata)
+{
+    if (HIDAPI_InitReportQueue(&hwdata->reports) == 0) {
+        hwdata->reader = SDL_CreateThreadInternal(HIDAPI_ReaderThread, "SDLHIDAPIReader", 64 * 1024, hwdata);
+        if (!hwdata->reader) {
+            /* The device will be read when the joystick is updated */
+            HIDAPI_QuitReportQueue(&hwdata->reports);
+        }
+    }
+}
+
+static void
+HIDAPI_StopReader(struct joystick_hwdata *hwdata)
+{
+    if (hwdata->reader) {
+        SDL_AtomicSet(&hwdata->reader_quit, 1);
+        HIDAPI_WakeReportQueue(&hwdata->reports);
+        SDL_WaitThread(hwdata->reader, NULL);
+        hwdata->reader = NULL;
+        HIDAPI_QuitReportQueue(&hwdata->reports);
+    }
+}
+
+int
+HIDAPI_ReadReport(SDL_Joystick *joystick, hid_device *dev, Uint8 *data, size_t size)
+{
+    struct joystick_hwdata *hwdata = joystick->hwdata;
+    Uint64 timestamp;
+    int report_size;
+
+    /* Drivers also read replies while the device is being opened and closed */
+    if (!hwdata || !hwdata->reader) {
+        return hid_read_timeout(dev, data, size, 0);
+    }
+
+    report_size = HIDAPI_TakeReport(&hwdata->reports, hwdata->driver->IsReportSuperseded, data, size, &timestamp);
+    if (report_size == 0) {
+        return SDL_AtomicGet(&hwdata->reader_error) ? -1 : 0;
+    }
+    SDL_SetEventHardwareTime(timestamp);
+    return report_size;
+}
+
 static int
 HIDAPI_JoystickOpen(SDL_Joystick * joystick, int device_index)
 {
@@ -978,6 +1063,10 @@ HIDAPI_JoystickOpen(SDL_Joystick * joystick, int device_index)
     }
 
     joystick->hwdata = hwdata;
+
+    if (SDL_GetHintBoolean(SDL_HINT_JOYSTICK_HIDAPI_THREAD, SDL_FALSE)) {
+        HIDAPI_StartReader(hwdata);
+    }
     return 0;
 }
 
@@ -1004,6 +1093,10 @@ HIDAPI_JoystickUpdate(SDL_Joystick * joystick)
     SDL_LockMutex(hwdata->mutex);
     succeeded = driver->Update(joystick, hwdata->dev, hwdata->context);
     SDL_UnlockMutex(hwdata->mutex);
+
+    if (hwdata->reader) {
+        SDL_SetEventHardwareTime(0);
+    }
     
     if (!succeeded) {
         SDL_HIDAPI_Device *device;
@@ -1021,6 +1114,9 @@ HIDAPI_JoystickClose(SDL_Joystick * joystick)
 {
     struct joystick_hwdata *hwdata = joystick->hwdata;
     SDL_HIDAPI_DeviceDriver *driver = hwdata->driver;
+
+    /* Drivers may wait for replies when they shut down, so stop queuing reports first */
+    HIDAPI_StopReader(hwdata);
     driver->Quit(joystick, hwdata->dev, hwdata->context);
 
     hid_close(hwdata->dev);
@@ -24,24 +24,7 @@
 #define SDL_JOYSTICK_HIDAPI_H
 
 #include "../../hidapi/hidapi/hidapi.h"
-
-/* This is the full set of HIDAPI drivers available */
-#define SDL_JOYSTICK_HIDAPI_PS4
-#define SDL_JOYSTICK_HIDAPI_SWITCH
-#define SDL_JOYSTICK_HIDAPI_XBOX360
-#define SDL_JOYSTICK_HIDAPI_XBOXONE
-
-#ifdef __WINDOWS__
-/* On Windows, Xbox One controllers are handled by the Xbox 360 driver */
-#undef SDL_JOYSTICK_HIDAPI_XBOXONE
-/* It turns out HIDAPI for Xbox controllers doesn't allow background input */
-#undef SDL_JOYSTICK_HIDAPI_XBOX360
-#endif
-
-#ifdef __MACOSX__
-/* On Mac OS X, Xbox One controllers are handled by the Xbox 360 driver */
-#undef SDL_JOYSTICK_HIDAPI_XBOXONE
-#endif
+#include "SDL_hidapi_reports.h"
 
 typedef struct _SDL_HIDAPI_DeviceDriver
 {
@@ -54,6 +37,9 @@ typedef struct _SDL_HIDAPI_DeviceDriver
     SDL_bool (*Update)(SDL_Joystick *joystick, hid_device *dev, void *context);
     void (*Quit)(SDL_Joystick *joystick, hid_device *dev, void *context);
 
+    /* Optional, lets reports be skipped when they pile up */
+    HIDAPI_IsReportSupersededFunc IsReportSuperseded;
+
 } SDL_HIDAPI_DeviceDriver;
 
 /* HIDAPI device support */
@@ -69,6 +55,10 @@ extern SDL_bool HIDAPI_IsDevicePresent(Uint16 vendor_id, Uint16 product_id, Uint
 /* Return the name of an Xbox 360 or Xbox One controller */
 extern const char *HIDAPI_XboxControllerName(Uint16 vendor_id, Uint16 product_id);
 
+/* Read the next input report without blocking, drivers use this instead of
+   hid_read_timeout() so reports can come from the reader thread */
+extern int HIDAPI_ReadReport(SDL_Joystick *joystick, hid_device *dev, Uint8 *data, size_t size);
+
 #endif /* SDL_JOYSTICK_HIDAPI_H */
 
 /* vi: set ts=4 sw=4 expandtab: */
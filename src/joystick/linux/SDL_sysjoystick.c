@@ -45,6 +45,8 @@
 #include "../steam/SDL_steamcontroller.h"
 #include "SDL_sysjoystick_c.h"
 #include "../hidapi/SDL_hidapijoystick_c.h"
+#include "../../core/linux/SDL_evdev.h"
+#include "../../core/linux/SDL_evdev_thread.h"
 
 /* This isn't defined in older Linux kernel headers */
 #ifndef SYN_DROPPED
@@ -53,6 +55,9 @@
 
 #include "../../core/linux/SDL_udev.h"
 
+/* SDL_TRUE if joystick events are read by the input thread */
+static SDL_bool input_thread = SDL_FALSE;
+
 static int MaybeAddDevice(const char *path);
 #if SDL_USE_LIBUDEV
 static int MaybeRemoveDevice(const char *path);
@@ -515,6 +520,8 @@ static void SteamControllerDisconnectedCallback(int device_instance)
 static int
 LINUX_JoystickInit(void)
 {
+    int result;
+
     /* First see if the user specified one or more joysticks to use */
     if (SDL_getenv("SDL_JOYSTICK_DEVICE") != NULL) {
         char *envcopy, *envpath, *delim;
@@ -534,11 +541,21 @@ LINUX_JoystickInit(void)
     SDL_InitSteamControllers(SteamControllerConnectedCallback,
                              SteamControllerDisconnectedCallback);
 
+    input_thread = SDL_EVDEV_thread_init();
+
 #if SDL_USE_LIBUDEV
-    return JoystickInitWithUdev();
+    result = JoystickInitWithUdev();
 #else 
-    return JoystickInitWithoutUdev();
+    result = JoystickInitWithoutUdev();
 #endif
+    if (result < 0) {
+        if (input_thread) {
+            SDL_EVDEV_thread_quit();
+            input_thread = SDL_FALSE;
+        }
+        return -1;
+    }
+    return 0;
 }
 
 static int
@@ -804,6 +821,12 @@ LINUX_JoystickOpen(SDL_Joystick * joystick, int device_index)
 
         /* Get the number of buttons and axes on the joystick */
         ConfigJoystick(joystick, fd);
+
+        joystick->hwdata->hardware_timestamps = SDL_EVDEV_SetMonotonicClock(fd);
+
+        if (input_thread) {
+            joystick->hwdata->input = SDL_EVDEV_thread_add_device(fd);
+        }
     }
 
     SDL_assert(item->hwdata == NULL);
@@ -953,6 +976,22 @@ PollAllValues(SDL_Joystick * joystick)
     }
 }
 
+static SDL_INLINE int
+ReadInputEvents(SDL_Joystick * joystick, struct input_event *events, int maxevents)
+{
+    int len;
+
+    if (joystick->hwdata->input) {
+        return SDL_EVDEV_thread_read(joystick->hwdata->input, events, maxevents);
+    }
+
+    len = read(joystick->hwdata->fd, events, maxevents * sizeof(*events));
+    if (len <= 0) {
+        return 0;
+    }
+    return len / sizeof(*events);
+}
+
 static SDL_INLINE void
 HandleInputEvents(SDL_Joystick * joystick)
 {
@@ -965,9 +1004,11 @@ HandleInputEvents(SDL_Joystick * joystick)
         joystick->hwdata->fresh = 0;
     }
 
-    while ((len = read(joystick->hwdata->fd, events, (sizeof events))) > 0) {
-        len /= sizeof(events[0]);
+    while ((len = ReadInputEvents(joystick, events, SDL_arraysize(events))) > 0) {
         for (i = 0; i < len; ++i) {
+            if (joystick->hwdata->hardware_timestamps) {
+                SDL_SetEventHardwareTime(SDL_EVDEV_GetEventTime(&events[i]));
+            }
             code = events[i].code;
             switch (events[i].type) {
             case EV_KEY:
@@ -1024,6 +1065,8 @@ HandleInputEvents(SDL_Joystick * joystick)
             }
         }
     }
+
+    SDL_SetEventHardwareTime(0);
 }
 
 static void
@@ -1061,6 +1104,7 @@ LINUX_JoystickClose(SDL_Joystick * joystick)
             ioctl(joystick->hwdata->fd, EVIOCRMFF, joystick->hwdata->effect.id);
             joystick->hwdata->effect.id = -1;
         }
+        SDL_EVDEV_thread_remove_device(joystick->hwdata->input);
         if (joystick->hwdata->fd >= 0) {
             close(joystick->hwdata->fd);
         }
@@ -1097,6 +1141,11 @@ LINUX_JoystickQuit(void)
     SDL_UDEV_Quit();
 #endif
 
+    if (input_thread) {
+        SDL_EVDEV_thread_quit();
+        input_thread = SDL_FALSE;
+    }
+
     SDL_QuitSteamControllers();
 }
 
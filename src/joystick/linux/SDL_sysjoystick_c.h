@@ -25,11 +25,13 @@
 #include <linux/input.h>
 
 struct SDL_joylist_item;
+struct SDL_EVDEV_thread_device;
 
 /* The private structure used to keep track of a joystick */
 struct joystick_hwdata
 {
     int fd;
+    struct SDL_EVDEV_thread_device *input;  /* Set if the input thread reads fd */
     struct SDL_joylist_item *item;
     SDL_JoystickGUID guid;
     char *fname;                /* Used in haptic subsystem */
@@ -59,6 +61,7 @@ struct joystick_hwdata
     } abs_correct[ABS_MAX];
 
     int fresh;
+    SDL_bool hardware_timestamps;   /* The device reports CLOCK_MONOTONIC times */
 
     /* Steam Controller support */
     SDL_bool m_bSteamController;
@@ -28,6 +28,7 @@
 #include "SDL_render.h"
 #include "SDL_sysrender.h"
 #include "software/SDL_render_sw_c.h"
+#include "../SDL_framearena.h"
 
 
 #define SDL_WINDOWRENDERDATA    "_SDL_WindowRenderData"
@@ -886,14 +887,14 @@ SDL_UpdateTextureYUV(SDL_Texture * texture, const SDL_Rect * rect,
         const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
         const size_t alloclen = rect->h * temp_pitch;
         if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
+            void *temp_pixels = SDL_AllocFrameMemory(alloclen);
             if (!temp_pixels) {
                 return SDL_OutOfMemory();
             }
             SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
                                 rect->w, rect->h, temp_pixels, temp_pitch);
             SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
+            SDL_FreeFrameMemory(temp_pixels);
         }
     }
     return 0;
@@ -926,7 +927,7 @@ SDL_UpdateTextureNative(SDL_Texture * texture, const SDL_Rect * rect,
         const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
         const size_t alloclen = rect->h * temp_pitch;
         if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
+            void *temp_pixels = SDL_AllocFrameMemory(alloclen);
             if (!temp_pixels) {
                 return SDL_OutOfMemory();
             }
@@ -934,7 +935,7 @@ SDL_UpdateTextureNative(SDL_Texture * texture, const SDL_Rect * rect,
                               texture->format, pixels, pitch,
                               native->format, temp_pixels, temp_pitch);
             SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
+            SDL_FreeFrameMemory(temp_pixels);
         }
     }
     return 0;
@@ -1015,14 +1016,14 @@ SDL_UpdateTextureYUVPlanar(SDL_Texture * texture, const SDL_Rect * rect,
         const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
         const size_t alloclen = rect->h * temp_pitch;
         if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
+            void *temp_pixels = SDL_AllocFrameMemory(alloclen);
             if (!temp_pixels) {
                 return SDL_OutOfMemory();
             }
             SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
                                 rect->w, rect->h, temp_pixels, temp_pitch);
             SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
+            SDL_FreeFrameMemory(temp_pixels);
         }
     }
     return 0;
@@ -1631,7 +1632,7 @@ RenderDrawPointsWithRects(SDL_Renderer * renderer,
     int i;
     int status;
 
-    frects = SDL_stack_alloc(SDL_FRect, count);
+    frects = (SDL_FRect *)SDL_AllocFrameMemory(count * sizeof(SDL_FRect));
     if (!frects) {
         return SDL_OutOfMemory();
     }
@@ -1644,7 +1645,7 @@ RenderDrawPointsWithRects(SDL_Renderer * renderer,
 
     status = renderer->RenderFillRects(renderer, frects, count);
 
-    SDL_stack_free(frects);
+    SDL_FreeFrameMemory(frects);
 
     return status;
 }
@@ -1675,7 +1676,7 @@ SDL_RenderDrawPoints(SDL_Renderer * renderer,
         return RenderDrawPointsWithRects(renderer, points, count);
     }
 
-    fpoints = SDL_stack_alloc(SDL_FPoint, count);
+    fpoints = (SDL_FPoint *)SDL_AllocFrameMemory(count * sizeof(SDL_FPoint));
     if (!fpoints) {
         return SDL_OutOfMemory();
     }
@@ -1686,7 +1687,7 @@ SDL_RenderDrawPoints(SDL_Renderer * renderer,
 
     status = renderer->RenderDrawPoints(renderer, fpoints, count);
 
-    SDL_stack_free(fpoints);
+    SDL_FreeFrameMemory(fpoints);
 
     return status;
 }
@@ -1713,7 +1714,7 @@ RenderDrawLinesWithRects(SDL_Renderer * renderer,
     int i, nrects;
     int status;
 
-    frects = SDL_stack_alloc(SDL_FRect, count-1);
+    frects = (SDL_FRect *)SDL_AllocFrameMemory((count-1) * sizeof(SDL_FRect));
     if (!frects) {
         return SDL_OutOfMemory();
     }
@@ -1751,7 +1752,7 @@ RenderDrawLinesWithRects(SDL_Renderer * renderer,
 
     status += renderer->RenderFillRects(renderer, frects, nrects);
 
-    SDL_stack_free(frects);
+    SDL_FreeFrameMemory(frects);
 
     if (status < 0) {
         status = -1;
@@ -1785,7 +1786,7 @@ SDL_RenderDrawLines(SDL_Renderer * renderer,
         return RenderDrawLinesWithRects(renderer, points, count);
     }
 
-    fpoints = SDL_stack_alloc(SDL_FPoint, count);
+    fpoints = (SDL_FPoint *)SDL_AllocFrameMemory(count * sizeof(SDL_FPoint));
     if (!fpoints) {
         return SDL_OutOfMemory();
     }
@@ -1796,7 +1797,7 @@ SDL_RenderDrawLines(SDL_Renderer * renderer,
 
     status = renderer->RenderDrawLines(renderer, fpoints, count);
 
-    SDL_stack_free(fpoints);
+    SDL_FreeFrameMemory(fpoints);
 
     return status;
 }
@@ -1897,7 +1898,7 @@ SDL_RenderFillRects(SDL_Renderer * renderer,
         return 0;
     }
 
-    frects = SDL_stack_alloc(SDL_FRect, count);
+    frects = (SDL_FRect *)SDL_AllocFrameMemory(count * sizeof(SDL_FRect));
     if (!frects) {
         return SDL_OutOfMemory();
     }
@@ -1910,7 +1911,7 @@ SDL_RenderFillRects(SDL_Renderer * renderer,
 
     status = renderer->RenderFillRects(renderer, frects, count);
 
-    SDL_stack_free(frects);
+    SDL_FreeFrameMemory(frects);
 
     return status;
 }
@@ -2086,6 +2087,9 @@ SDL_RenderPresent(SDL_Renderer * renderer)
         return;
     }
     renderer->RenderPresent(renderer);
+
+    /* Any temporary memory used to build this frame can be reused */
+    SDL_ResetFrameArena();
 }
 
 void
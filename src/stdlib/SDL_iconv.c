@@ -29,6 +29,323 @@
 
 #include "SDL_stdinc.h"
 #include "SDL_endian.h"
+#include "SDL_cpuinfo.h"
+
+/* Fast path for the Unicode conversions SDL itself does all the time
+   (clipboard text, IME strings, window titles, SDL_iconv_utf8_ucs4).
+
+   SDL_iconv_fast() converts the longest prefix of the input that is
+   well-formed and unambiguous: every converter, SDL's own and the
+   system iconv(), produces the same output for it.  It stops in front
+   of anything else (malformed or truncated sequences, unpaired
+   surrogates, the noncharacters U+FFFE and U+FFFF, or not enough room
+   in the output buffer) and leaves that to the general converter, so
+   error handling and replacement characters stay exactly as before.
+
+   Runs of ASCII are converted 16 bytes at a time with SSE2, or a word
+   at a time everywhere else.
+*/
+enum
+{
+    SDL_ICONV_FAST_NONE,
+    SDL_ICONV_FAST_UTF8,
+    SDL_ICONV_FAST_UTF16LE,
+    SDL_ICONV_FAST_UTF32LE
+};
+
+#define SDL_ICONV_WORD_SIZE     sizeof(size_t)
+#define SDL_ICONV_WORD_HIGHS    ((~(size_t)0 / 0xFF) * 0x80)
+
+/* Widen a run of ASCII bytes into 16-bit or 32-bit little endian units */
+static size_t
+SDL_iconv_widen_ascii(const Uint8 *src, size_t srclen, Uint8 *dst, size_t dstlen, size_t unit)
+{
+    size_t n = 0;
+    size_t count = SDL_min(srclen, dstlen / unit);
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    while (count - n >= 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(src + n));
+        __m128i lo, hi;
+        if (_mm_movemask_epi8(v)) {
+            break;
+        }
+        lo = _mm_unpacklo_epi8(v, zero);
+        hi = _mm_unpackhi_epi8(v, zero);
+        if (unit == 2) {
+            _mm_storeu_si128((__m128i *)(dst + n * 2), lo);
+            _mm_storeu_si128((__m128i *)(dst + n * 2 + 16), hi);
+        } else {
+            _mm_storeu_si128((__m128i *)(dst + n * 4), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(dst + n * 4 + 16), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(dst + n * 4 + 32), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i *)(dst + n * 4 + 48), _mm_unpackhi_epi16(hi, zero));
+        }
+        n += 16;
+    }
+#endif
+    while (count - n >= SDL_ICONV_WORD_SIZE) {
+        size_t word, i;
+        SDL_memcpy(&word, src + n, sizeof(word));
+        if (word & SDL_ICONV_WORD_HIGHS) {
+            break;
+        }
+        if (unit == 2) {
+            for (i = 0; i < SDL_ICONV_WORD_SIZE; ++i) {
+                dst[(n + i) * 2 + 0] = src[n + i];
+                dst[(n + i) * 2 + 1] = 0;
+            }
+        } else {
+            for (i = 0; i < SDL_ICONV_WORD_SIZE; ++i) {
+                dst[(n + i) * 4 + 0] = src[n + i];
+                dst[(n + i) * 4 + 1] = 0;
+                dst[(n + i) * 4 + 2] = 0;
+                dst[(n + i) * 4 + 3] = 0;
+            }
+        }
+        n += SDL_ICONV_WORD_SIZE;
+    }
+    return n;
+}
+
+/* Narrow a run of 16-bit or 32-bit little endian ASCII units into bytes */
+static size_t
+SDL_iconv_narrow_ascii(const Uint8 *src, size_t srclen, Uint8 *dst, size_t dstlen, size_t unit)
+{
+    size_t n = 0;
+    size_t count = SDL_min(srclen / unit, dstlen);
+
+#ifdef __SSE2__
+    if (unit == 2) {
+        const __m128i mask = _mm_set1_epi16((short)0xFF80);
+        const __m128i zero = _mm_setzero_si128();
+        while (count - n >= 8) {
+            const __m128i v = _mm_loadu_si128((const __m128i *)(src + n * 2));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask), zero)) != 0xFFFF) {
+                break;
+            }
+            _mm_storel_epi64((__m128i *)(dst + n), _mm_packus_epi16(v, v));
+            n += 8;
+        }
+    } else {
+        const __m128i mask = _mm_set1_epi32((int)0xFFFFFF80);
+        const __m128i zero = _mm_setzero_si128();
+        while (count - n >= 4) {
+            const __m128i v = _mm_loadu_si128((const __m128i *)(src + n * 4));
+            int packed;
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, mask), zero)) != 0xFFFF) {
+                break;
+            }
+            packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(v, v), zero));
+            SDL_memcpy(dst + n, &packed, 4);
+            n += 4;
+        }
+    }
+#endif
+    if (unit == 2) {
+        while (n < count && src[n * 2] < 0x80 && src[n * 2 + 1] == 0) {
+            dst[n] = src[n * 2];
+            ++n;
+        }
+    } else {
+        while (n < count && src[n * 4] < 0x80 &&
+               (src[n * 4 + 1] | src[n * 4 + 2] | src[n * 4 + 3]) == 0) {
+            dst[n] = src[n * 4];
+            ++n;
+        }
+    }
+    return n;
+}
+
+static size_t
+SDL_iconv_fast(int src_fmt, int dst_fmt,
+               const char **inbuf, size_t * inbytesleft,
+               char **outbuf, size_t * outbytesleft)
+{
+    const Uint8 *src = (const Uint8 *) *inbuf;
+    Uint8 *dst = (Uint8 *) *outbuf;
+    size_t srclen = *inbytesleft;
+    size_t dstlen = *outbytesleft;
+    size_t total = 0;
+    size_t n, unit;
+    Uint32 ch;
+
+    if (src_fmt == SDL_ICONV_FAST_UTF8 &&
+        (dst_fmt == SDL_ICONV_FAST_UTF16LE || dst_fmt == SDL_ICONV_FAST_UTF32LE)) {
+        unit = (dst_fmt == SDL_ICONV_FAST_UTF16LE) ? 2 : 4;
+        while (srclen > 0) {
+            n = SDL_iconv_widen_ascii(src, srclen, dst, dstlen, unit);
+            src += n;
+            srclen -= n;
+            dst += n * unit;
+            dstlen -= n * unit;
+            total += n;
+            if (srclen == 0) {
+                break;
+            }
+
+            ch = src[0];
+            if (ch < 0x80) {
+                n = 1;
+            } else if (ch >= 0xC2 && ch <= 0xDF) {
+                if (srclen < 2 || (src[1] & 0xC0) != 0x80) {
+                    break;
+                }
+                ch = ((ch & 0x1F) << 6) | (src[1] & 0x3F);
+                n = 2;
+            } else if (ch >= 0xE0 && ch <= 0xEF) {
+                if (srclen < 3 ||
+                    (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80 ||
+                    (ch == 0xE0 && src[1] < 0xA0) ||   /* overlong */
+                    (ch == 0xED && src[1] > 0x9F)) {   /* surrogate */
+                    break;
+                }
+                ch = ((ch & 0x0F) << 12) | ((Uint32) (src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+                if (ch >= 0xFFFE) {
+                    break;
+                }
+                n = 3;
+            } else if (ch >= 0xF0 && ch <= 0xF4) {
+                if (srclen < 4 ||
+                    (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80 ||
+                    (src[3] & 0xC0) != 0x80 ||
+                    (ch == 0xF0 && src[1] < 0x90) ||   /* overlong */
+                    (ch == 0xF4 && src[1] > 0x8F)) {   /* > U+10FFFF */
+                    break;
+                }
+                ch = ((ch & 0x07) << 18) | ((Uint32) (src[1] & 0x3F) << 12) |
+                     ((Uint32) (src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+                n = 4;
+            } else {
+                break;
+            }
+
+            if (unit == 4) {
+                if (dstlen < 4) {
+                    break;
+                }
+                dst[0] = (Uint8) ch;
+                dst[1] = (Uint8) (ch >> 8);
+                dst[2] = (Uint8) (ch >> 16);
+                dst[3] = 0;
+                dst += 4;
+                dstlen -= 4;
+            } else if (ch < 0x10000) {
+                if (dstlen < 2) {
+                    break;
+                }
+                dst[0] = (Uint8) ch;
+                dst[1] = (Uint8) (ch >> 8);
+                dst += 2;
+                dstlen -= 2;
+            } else {
+                Uint16 W1, W2;
+                if (dstlen < 4) {
+                    break;
+                }
+                ch -= 0x10000;
+                W1 = 0xD800 | (Uint16) ((ch >> 10) & 0x3FF);
+                W2 = 0xDC00 | (Uint16) (ch & 0x3FF);
+                dst[0] = (Uint8) W1;
+                dst[1] = (Uint8) (W1 >> 8);
+                dst[2] = (Uint8) W2;
+                dst[3] = (Uint8) (W2 >> 8);
+                dst += 4;
+                dstlen -= 4;
+            }
+            src += n;
+            srclen -= n;
+            ++total;
+        }
+    } else if (dst_fmt == SDL_ICONV_FAST_UTF8 &&
+               (src_fmt == SDL_ICONV_FAST_UTF16LE || src_fmt == SDL_ICONV_FAST_UTF32LE)) {
+        unit = (src_fmt == SDL_ICONV_FAST_UTF16LE) ? 2 : 4;
+        while (srclen >= unit) {
+            n = SDL_iconv_narrow_ascii(src, srclen, dst, dstlen, unit);
+            src += n * unit;
+            srclen -= n * unit;
+            dst += n;
+            dstlen -= n;
+            total += n;
+            if (srclen < unit) {
+                break;
+            }
+
+            if (unit == 2) {
+                ch = (Uint32) src[0] | ((Uint32) src[1] << 8);
+                n = 2;
+                if (ch >= 0xD800 && ch <= 0xDFFF) {
+                    Uint32 W2;
+                    if (ch > 0xDBFF || srclen < 4) {
+                        break;
+                    }
+                    W2 = (Uint32) src[2] | ((Uint32) src[3] << 8);
+                    if (W2 < 0xDC00 || W2 > 0xDFFF) {
+                        break;
+                    }
+                    ch = (((ch & 0x3FF) << 10) | (W2 & 0x3FF)) + 0x10000;
+                    n = 4;
+                }
+            } else {
+                ch = (Uint32) src[0] | ((Uint32) src[1] << 8) |
+                     ((Uint32) src[2] << 16) | ((Uint32) src[3] << 24);
+                if ((ch >= 0xD800 && ch <= 0xDFFF) || ch > 0x10FFFF) {
+                    break;
+                }
+                n = 4;
+            }
+            if (ch == 0xFFFE || ch == 0xFFFF) {
+                break;
+            }
+
+            if (ch < 0x80) {
+                if (dstlen < 1) {
+                    break;
+                }
+                dst[0] = (Uint8) ch;
+                dst += 1;
+                dstlen -= 1;
+            } else if (ch < 0x800) {
+                if (dstlen < 2) {
+                    break;
+                }
+                dst[0] = 0xC0 | (Uint8) (ch >> 6);
+                dst[1] = 0x80 | (Uint8) (ch & 0x3F);
+                dst += 2;
+                dstlen -= 2;
+            } else if (ch < 0x10000) {
+                if (dstlen < 3) {
+                    break;
+                }
+                dst[0] = 0xE0 | (Uint8) (ch >> 12);
+                dst[1] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+                dst[2] = 0x80 | (Uint8) (ch & 0x3F);
+                dst += 3;
+                dstlen -= 3;
+            } else {
+                if (dstlen < 4) {
+                    break;
+                }
+                dst[0] = 0xF0 | (Uint8) (ch >> 18);
+                dst[1] = 0x80 | (Uint8) ((ch >> 12) & 0x3F);
+                dst[2] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+                dst[3] = 0x80 | (Uint8) (ch & 0x3F);
+                dst += 4;
+                dstlen -= 4;
+            }
+            src += n;
+            srclen -= n;
+            ++total;
+        }
+    }
+
+    *inbuf = (const char *) src;
+    *inbytesleft = srclen;
+    *outbuf = (char *) dst;
+    *outbytesleft = dstlen;
+    return total;
+}
 
 #if defined(HAVE_ICONV) && defined(HAVE_ICONV_H)
 #include <iconv.h>
@@ -132,6 +449,22 @@ struct _SDL_iconv_t
     int dst_fmt;
 };
 
+static int
+SDL_iconv_fast_format(int format)
+{
+    switch (format) {
+    case ENCODING_UTF8:
+        return SDL_ICONV_FAST_UTF8;
+    case ENCODING_UTF16LE:
+        return SDL_ICONV_FAST_UTF16LE;
+    case ENCODING_UTF32LE:
+    case ENCODING_UCS4LE:
+        return SDL_ICONV_FAST_UTF32LE;
+    default:
+        return SDL_ICONV_FAST_NONE;
+    }
+}
+
 static struct
 {
     const char *name;
@@ -255,6 +588,7 @@ SDL_iconv(SDL_iconv_t cd,
     size_t srclen, dstlen;
     Uint32 ch = 0;
     size_t total;
+    int fast_src, fast_dst;
 
     if (!inbuf || !*inbuf) {
         /* Reset the context */
@@ -340,8 +674,26 @@ SDL_iconv(SDL_iconv_t cd,
         break;
     }
 
+    fast_src = SDL_iconv_fast_format(cd->src_fmt);
+    fast_dst = SDL_iconv_fast_format(cd->dst_fmt);
+
     total = 0;
     while (srclen > 0) {
+        if (fast_src != SDL_ICONV_FAST_NONE && fast_dst != SDL_ICONV_FAST_NONE) {
+            size_t converted = SDL_iconv_fast(fast_src, fast_dst, &src, &srclen, &dst, &dstlen);
+            if (converted > 0) {
+                /* Update state */
+                *inbuf = src;
+                *inbytesleft = srclen;
+                *outbuf = dst;
+                *outbytesleft = dstlen;
+                total += converted;
+                if (srclen == 0) {
+                    break;
+                }
+            }
+        }
+
         /* Decode a character */
         switch (cd->src_fmt) {
         case ENCODING_ASCII:
@@ -861,6 +1213,30 @@ SDL_iconv_close(SDL_iconv_t cd)
 
 #endif /* !HAVE_ICONV */
 
+static int
+SDL_iconv_fast_code(const char *code)
+{
+    if (!code) {
+        return SDL_ICONV_FAST_NONE;
+    }
+    if (SDL_strcasecmp(code, "UTF-8") == 0 || SDL_strcasecmp(code, "UTF8") == 0) {
+        return SDL_ICONV_FAST_UTF8;
+    }
+    if (SDL_strcasecmp(code, "UTF-16LE") == 0 || SDL_strcasecmp(code, "UTF16LE") == 0) {
+        return SDL_ICONV_FAST_UTF16LE;
+    }
+    if (SDL_strcasecmp(code, "UTF-32LE") == 0 || SDL_strcasecmp(code, "UTF32LE") == 0 ||
+        SDL_strcasecmp(code, "UCS-4LE") == 0) {
+        return SDL_ICONV_FAST_UTF32LE;
+    }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    if (SDL_strcasecmp(code, "UCS-4-INTERNAL") == 0) {
+        return SDL_ICONV_FAST_UTF32LE;
+    }
+#endif
+    return SDL_ICONV_FAST_NONE;
+}
+
 char *
 SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
                  size_t inbytesleft)
@@ -871,6 +1247,7 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
     char *outbuf;
     size_t outbytesleft;
     size_t retCode = 0;
+    int fast_src, fast_dst;
 
     cd = SDL_iconv_open(tocode, fromcode);
     if (cd == (SDL_iconv_t) - 1) {
@@ -887,7 +1264,28 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
         return NULL;
     }
 
-    stringsize = inbytesleft > 4 ? inbytesleft : 4;
+    fast_src = SDL_iconv_fast_code(fromcode);
+    fast_dst = SDL_iconv_fast_code(tocode);
+    if (fast_src == SDL_ICONV_FAST_NONE || fast_dst == SDL_ICONV_FAST_NONE) {
+        fast_src = fast_dst = SDL_ICONV_FAST_NONE;
+    }
+
+    /* Size the output for the worst case of the common Unicode
+       conversions up front, so they never have to grow the buffer.
+       The extra 4 bytes leave room to terminate the string. */
+    if (fast_src == SDL_ICONV_FAST_UTF8 && fast_dst == SDL_ICONV_FAST_UTF16LE &&
+        inbytesleft < ((size_t) -1) / 4) {
+        stringsize = inbytesleft * 2 + 4;
+    } else if (fast_src == SDL_ICONV_FAST_UTF8 && fast_dst == SDL_ICONV_FAST_UTF32LE &&
+               inbytesleft < ((size_t) -1) / 8) {
+        stringsize = inbytesleft * 4 + 4;
+    } else if (fast_src == SDL_ICONV_FAST_UTF16LE && fast_dst == SDL_ICONV_FAST_UTF8 &&
+               inbytesleft < ((size_t) -1) / 4) {
+        stringsize = inbytesleft + inbytesleft / 2 + 4;
+    } else {
+        stringsize = inbytesleft;
+    }
+    stringsize = stringsize > 4 ? stringsize : 4;
     string = SDL_malloc(stringsize);
     if (!string) {
         SDL_iconv_close(cd);
@@ -898,6 +1296,15 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
     SDL_memset(outbuf, 0, 4);
 
     while (inbytesleft > 0) {
+#if defined(HAVE_ICONV) && defined(HAVE_ICONV_H)
+        /* The system iconv() only gets what the fast path can't handle */
+        if (fast_src != SDL_ICONV_FAST_NONE) {
+            SDL_iconv_fast(fast_src, fast_dst, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+            if (inbytesleft == 0) {
+                break;
+            }
+        }
+#endif
         retCode = SDL_iconv(cd, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
         switch (retCode) {
         case SDL_ICONV_E2BIG:
@@ -926,6 +1333,9 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
             break;
         }
     }
+    if (outbytesleft >= 4) {
+        SDL_memset(outbuf, 0, 4);
+    }
     SDL_iconv_close(cd);
 
     return string;
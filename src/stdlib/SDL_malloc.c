@@ -5250,7 +5250,187 @@ History:
 
 #endif /* !HAVE_MALLOC */
 
-#ifdef HAVE_MALLOC
+/* The thread cache sits in front of dlmalloc, since it needs to know the
+   usable size of a block when it is freed. It's only available when the
+   compiler gives us thread-local storage that doesn't allocate memory.
+ */
+#if defined(SDL_MALLOC_THREAD_CACHE) && !defined(HAVE_MALLOC) && !SDL_THREADS_DISABLED
+#if defined(_MSC_VER)
+#define SDL_MALLOC_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define SDL_MALLOC_THREAD_LOCAL __thread
+#endif
+#endif
+
+#ifdef SDL_MALLOC_THREAD_LOCAL
+
+#define SDL_MALLOC_NUM_SIZE_CLASSES 20
+#define SDL_MALLOC_MAX_CACHED_SIZE  1024
+#define SDL_MALLOC_MAX_CACHED_BYTES (16 * 1024)
+#define SDL_MALLOC_STATS_BATCH      256     /* Allocations counted per thread before they're shared */
+
+static const size_t s_size_classes[SDL_MALLOC_NUM_SIZE_CLASSES] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 512,
+    640, 768, 896, 1024
+};
+
+/* Blocks in a bin are linked through their first word */
+typedef struct SDL_MemoryCacheBin
+{
+    void *head;
+    int count;
+    int allocations;    /* Not yet added to s_cache_stats */
+    int cache_hits;
+} SDL_MemoryCacheBin;
+
+static SDL_MALLOC_THREAD_LOCAL SDL_MemoryCacheBin s_cache_bins[SDL_MALLOC_NUM_SIZE_CLASSES];
+
+/* Shared by all threads, so they're only updated in batches */
+static struct
+{
+    SDL_atomic_t allocations;
+    SDL_atomic_t cache_hits;
+} s_cache_stats[SDL_MALLOC_NUM_SIZE_CLASSES];
+
+static void
+SDL_PublishMemoryCacheStats(SDL_MemoryCacheBin *bin, int size_class)
+{
+    SDL_AtomicAdd(&s_cache_stats[size_class].allocations, bin->allocations);
+    SDL_AtomicAdd(&s_cache_stats[size_class].cache_hits, bin->cache_hits);
+    bin->allocations = 0;
+    bin->cache_hits = 0;
+}
+
+/* Returns the smallest size class that can hold 'size' bytes */
+static SDL_INLINE int
+SDL_MemorySizeClass(size_t size)
+{
+    if (size <= 128) {
+        return (size <= 16) ? 0 : (int)((size - 1) >> 4);
+    } else if (size <= 256) {
+        return 8 + (int)((size - 129) >> 5);
+    } else if (size <= 512) {
+        return 12 + (int)((size - 257) >> 6);
+    } else {
+        return 16 + (int)((size - 513) >> 7);
+    }
+}
+
+/* Returns the size class a freed block of 'usable' bytes can be cached in,
+   or -1 if it would waste too much memory sitting in a bin. */
+static SDL_INLINE int
+SDL_MemorySizeClassForBlock(size_t usable)
+{
+    int size_class;
+
+    if (usable < s_size_classes[0] || usable >= SDL_MALLOC_MAX_CACHED_SIZE + 16) {
+        return -1;
+    }
+    if (usable >= SDL_MALLOC_MAX_CACHED_SIZE) {
+        return SDL_MALLOC_NUM_SIZE_CLASSES - 1;
+    }
+    size_class = SDL_MemorySizeClass(usable);
+    if (s_size_classes[size_class] > usable) {
+        --size_class;
+    }
+    if ((usable - s_size_classes[size_class]) >= 16) {
+        return -1;
+    }
+    return size_class;
+}
+
+static void
+SDL_FlushMemoryCacheBin(SDL_MemoryCacheBin *bin, int keep)
+{
+    while (bin->count > keep) {
+        void *block = bin->head;
+        bin->head = *(void **)block;
+        --bin->count;
+        dlfree(block);
+    }
+}
+
+static void * SDLCALL
+SDL_cache_malloc(size_t size)
+{
+    SDL_MemoryCacheBin *bin;
+    int size_class;
+    void *mem;
+
+    if (size > SDL_MALLOC_MAX_CACHED_SIZE) {
+        return dlmalloc(size);
+    }
+
+    size_class = SDL_MemorySizeClass(size);
+    bin = &s_cache_bins[size_class];
+    if (++bin->allocations >= SDL_MALLOC_STATS_BATCH) {
+        SDL_PublishMemoryCacheStats(bin, size_class);
+    }
+
+    mem = bin->head;
+    if (mem) {
+        bin->head = *(void **)mem;
+        --bin->count;
+        ++bin->cache_hits;
+        return mem;
+    }
+    return dlmalloc(s_size_classes[size_class]);
+}
+
+static void * SDLCALL
+SDL_cache_calloc(size_t nmemb, size_t size)
+{
+    size_t total = nmemb * size;
+    void *mem;
+
+    if (size && (total / size) != nmemb) {
+        return NULL;
+    }
+    if (total > SDL_MALLOC_MAX_CACHED_SIZE) {
+        return dlcalloc(nmemb, size);
+    }
+
+    mem = SDL_cache_malloc(total);
+    if (mem) {
+        SDL_memset(mem, 0, total);
+    }
+    return mem;
+}
+
+static void SDLCALL
+SDL_cache_free(void *mem)
+{
+    SDL_MemoryCacheBin *bin;
+    int size_class;
+
+    if (!mem) {
+        return;
+    }
+
+    size_class = SDL_MemorySizeClassForBlock(dlmalloc_usable_size(mem));
+    if (size_class < 0) {
+        dlfree(mem);
+        return;
+    }
+
+    bin = &s_cache_bins[size_class];
+    if ((size_t)bin->count * s_size_classes[size_class] >= SDL_MALLOC_MAX_CACHED_BYTES) {
+        /* Hand half of the bin back to the shared heap */
+        SDL_FlushMemoryCacheBin(bin, bin->count / 2);
+    }
+    *(void **)mem = bin->head;
+    bin->head = mem;
+    ++bin->count;
+}
+
+#define real_malloc SDL_cache_malloc
+#define real_calloc SDL_cache_calloc
+#define real_realloc dlrealloc
+#define real_free SDL_cache_free
+
+#elif defined(HAVE_MALLOC)
 #define real_malloc malloc
 #define real_calloc calloc
 #define real_realloc realloc
@@ -5260,7 +5440,7 @@ History:
 #define real_calloc dlcalloc
 #define real_realloc dlrealloc
 #define real_free dlfree
-#endif
+#endif /* SDL_MALLOC_THREAD_LOCAL */
 
 /* Memory functions used by SDL that can be replaced by the application */
 static struct
@@ -5323,6 +5503,49 @@ int SDL_GetNumAllocations(void)
     return SDL_AtomicGet(&s_mem.num_allocations);
 }
 
+int SDL_GetNumMemorySizeClasses(void)
+{
+#ifdef SDL_MALLOC_THREAD_LOCAL
+    return SDL_MALLOC_NUM_SIZE_CLASSES;
+#else
+    return 0;
+#endif
+}
+
+int SDL_GetMemorySizeClassStats(int size_class, size_t *size, int *allocations, int *cache_hits)
+{
+#ifdef SDL_MALLOC_THREAD_LOCAL
+    if (size_class < 0 || size_class >= SDL_MALLOC_NUM_SIZE_CLASSES) {
+        return SDL_InvalidParamError("size_class");
+    }
+    if (size) {
+        *size = s_size_classes[size_class];
+    }
+    /* Other threads may still have up to SDL_MALLOC_STATS_BATCH uncounted allocations */
+    if (allocations) {
+        *allocations = SDL_AtomicGet(&s_cache_stats[size_class].allocations) + s_cache_bins[size_class].allocations;
+    }
+    if (cache_hits) {
+        *cache_hits = SDL_AtomicGet(&s_cache_stats[size_class].cache_hits) + s_cache_bins[size_class].cache_hits;
+    }
+    return 0;
+#else
+    return SDL_Unsupported();
+#endif
+}
+
+void SDL_FlushThreadMemoryCache(void)
+{
+#ifdef SDL_MALLOC_THREAD_LOCAL
+    int i;
+
+    for (i = 0; i < SDL_MALLOC_NUM_SIZE_CLASSES; ++i) {
+        SDL_FlushMemoryCacheBin(&s_cache_bins[i], 0);
+        SDL_PublishMemoryCacheStats(&s_cache_bins[i], i);
+    }
+#endif
+}
+
 void *SDL_malloc(size_t size)
 {
     void *mem;
@@ -26,509 +26,555 @@
 #include "../SDL_internal.h"
 
 #include "SDL_stdinc.h"
-#include "SDL_assert.h"
 
-#if defined(HAVE_QSORT)
-void
-SDL_qsort(void *base, size_t nmemb, size_t size, int (*compare) (const void *, const void *))
+/* This is a pattern-defeating quicksort, after Orson Peters' pdqsort
+   (https://github.com/orlp/pdqsort, zlib license). It's an introsort
+   that picks pivots from a median of three or a pseudomedian of nine,
+   finishes short ranges with insertion sort, recognizes already sorted
+   and all-equal runs in linear time, and shuffles or falls back to
+   heapsort when it sees adversarial input. Ranges of small elements are
+   partitioned with block partitioning, which keeps the result of the
+   comparison out of the branch predictor.
+
+   Elements are moved as 32-bit words, 64-bit words, native words or
+   bytes, whichever the element size and alignment allow.
+*/
+
+#define SDL_QSORT_INSERTION_THRESHOLD   24
+#define SDL_QSORT_NINTHER_THRESHOLD     128
+#define SDL_QSORT_PARTIAL_INSERTION_LIMIT 8
+#define SDL_QSORT_BLOCK_SIZE            64
+#define SDL_QSORT_BLOCK_MAX_ELEMENT     16
+#define SDL_QSORT_TEMP_SIZE             64
+
+typedef enum
 {
-    qsort(base, nmemb, size, compare);
+    SDL_QSORT_BYTES,
+    SDL_QSORT_WORDS,
+    SDL_QSORT_UINT32,
+    SDL_QSORT_UINT64
+} SDL_QSortElementKind;
+
+typedef struct
+{
+    size_t size;
+    SDL_QSortElementKind kind;
+    int (*compare) (const void *, const void *);
+    int (*compare_r) (void *, const void *, const void *);
+    void *userdata;
+    union {
+        Uint64 align;
+        Uint8 bytes[SDL_QSORT_TEMP_SIZE];
+    } temp;
+} SDL_QSortContext;
+
+#define QS_AT(ctx, p, n)    ((p) + (intptr_t)(n) * (intptr_t)(ctx)->size)
+#define QS_COUNT(ctx, a, b) ((size_t)((b) - (a)) / (ctx)->size)
+
+/* Returns non-zero if a sorts before b */
+static SDL_INLINE int
+SDL_QSortLess(const SDL_QSortContext *ctx, const Uint8 *a, const Uint8 *b)
+{
+    if (ctx->compare_r) {
+        return ctx->compare_r(ctx->userdata, a, b) < 0;
+    }
+    return ctx->compare(a, b) < 0;
 }
 
-#else
+static SDL_INLINE void
+SDL_QSortSwap(const SDL_QSortContext *ctx, Uint8 *a, Uint8 *b)
+{
+    switch (ctx->kind) {
+    case SDL_QSORT_UINT32: {
+        const Uint32 t = *(Uint32 *)a;
+        *(Uint32 *)a = *(Uint32 *)b;
+        *(Uint32 *)b = t;
+        break;
+    }
+    case SDL_QSORT_UINT64: {
+        const Uint64 t = *(Uint64 *)a;
+        *(Uint64 *)a = *(Uint64 *)b;
+        *(Uint64 *)b = t;
+        break;
+    }
+    case SDL_QSORT_WORDS: {
+        size_t *wa = (size_t *)a;
+        size_t *wb = (size_t *)b;
+        size_t n = ctx->size / sizeof(size_t);
+        while (n--) {
+            const size_t t = *wa;
+            *wa++ = *wb;
+            *wb++ = t;
+        }
+        break;
+    }
+    default: {
+        size_t n = ctx->size;
+        while (n--) {
+            const Uint8 t = *a;
+            *a++ = *b;
+            *b++ = t;
+        }
+        break;
+    }
+    }
+}
 
-#ifdef assert
-#undef assert
-#endif
-#define assert SDL_assert
-#ifdef malloc
-#undef malloc
-#endif
-#define malloc SDL_malloc
-#ifdef free
-#undef free
-#endif
-#define free SDL_free
-#ifdef memcpy
-#undef memcpy
-#endif
-#define memcpy SDL_memcpy
-#ifdef memmove
-#undef memmove
-#endif
-#define memmove SDL_memmove
-#ifdef qsortG
-#undef qsortG
-#endif
-#define qsortG SDL_qsort
+static SDL_INLINE void
+SDL_QSortCopy(const SDL_QSortContext *ctx, Uint8 *dst, const Uint8 *src)
+{
+    switch (ctx->kind) {
+    case SDL_QSORT_UINT32:
+        *(Uint32 *)dst = *(const Uint32 *)src;
+        break;
+    case SDL_QSORT_UINT64:
+        *(Uint64 *)dst = *(const Uint64 *)src;
+        break;
+    default:
+        SDL_memcpy(dst, src, ctx->size);
+        break;
+    }
+}
 
-/*
-This code came from Gareth McCaughan, under the zlib license.
-Specifically this: https://www.mccaughan.org.uk/software/qsort.c-1.14
+static SDL_INLINE void
+SDL_QSortSort2(const SDL_QSortContext *ctx, Uint8 *a, Uint8 *b)
+{
+    if (SDL_QSortLess(ctx, b, a)) {
+        SDL_QSortSwap(ctx, a, b);
+    }
+}
 
-Everything below this comment until the HAVE_QSORT #endif was from Gareth
-(any minor changes will be noted inline).
+static SDL_INLINE void
+SDL_QSortSort3(const SDL_QSortContext *ctx, Uint8 *a, Uint8 *b, Uint8 *c)
+{
+    SDL_QSortSort2(ctx, a, b);
+    SDL_QSortSort2(ctx, b, c);
+    SDL_QSortSort2(ctx, a, b);
+}
 
-Thank you to Gareth for relicensing this code under the zlib license for our
-benefit!
+/* Sorts [begin, end) with insertion sort. If 'guarded' is false, the
+   element before begin must not sort after anything in the range.
+   If 'limit' is non-zero, gives up and returns SDL_FALSE once more than
+   'limit' elements have been moved. */
+static SDL_bool
+SDL_QSortInsertion(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end, SDL_bool guarded, size_t limit)
+{
+    const size_t size = ctx->size;
+    size_t moved = 0;
+    Uint8 *cur;
 
---ryan.
-*/
+    if (begin == end) {
+        return SDL_TRUE;
+    }
 
-/* This is a drop-in replacement for the C library's |qsort()| routine.
- *
- * It is intended for use where you know or suspect that your
- * platform's qsort is bad. If that isn't the case, then you
- * should probably use the qsort your system gives you in preference
- * to mine -- it will likely have been tested and tuned better.
- *
- * Features:
- *   - Median-of-three pivoting (and more)
- *   - Truncation and final polishing by a single insertion sort
- *   - Early truncation when no swaps needed in pivoting step
- *   - Explicit recursion, guaranteed not to overflow
- *   - A few little wrinkles stolen from the GNU |qsort()|.
- *     (For the avoidance of doubt, no code was stolen, only
- *     broad ideas.)
- *   - separate code for non-aligned / aligned / word-size objects
- *
- * Earlier releases of this code used an idiosyncratic licence
- * I wrote myself, because I'm an idiot. The code is now released
- * under the "zlib/libpng licence"; you will find the actual
- * terms in the next comment. I request (but do not require)
- * that if you make any changes beyond the name of the exported
- * routine and reasonable tweaks to the TRUNC_* and
- * PIVOT_THRESHOLD values, you modify the _ID string so as
- * to make it clear that you have changed the code.
- *
- * If you find problems with this code, or find ways of
- * making it significantly faster, please let me know!
- * My e-mail address, valid as of early 2016 and for the
- * foreseeable future, is
- *    gareth.mccaughan@pobox.com
- * Thanks!
- *
- * Gareth McCaughan
- */
-
-/* Copyright (c) 1998-2016 Gareth McCaughan
- *
- * This software is provided 'as-is', without any express or implied
- * warranty. In no event will the authors be held liable for any
- * damages arising from the use of this software.
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented;
- *    you must not claim that you wrote the original software.
- *    If you use this software in a product, an acknowledgment
- *    in the product documentation would be appreciated but
- *    is not required.
- *
- * 2. Altered source versions must be plainly marked as such,
- *    and must not be misrepresented as being the original software.
- *
- * 3. This notice may not be removed or altered from any source
- *    distribution.
- */
-
-/* Revision history since release:
- *   1998-03-19 v1.12 First release I have any records of.
- *   2007-09-02 v1.13 Fix bug kindly reported by Dan Bodoh
- *                    (premature termination of recursion).
- *                    Add a few clarifying comments.
- *                    Minor improvements to debug output.
- *   2016-02-21 v1.14 Replace licence with 2-clause BSD,
- *                    and clarify a couple of things in
- *                    comments. No code changes.
- */
-
-/* BEGIN SDL CHANGE ... commented this out with an #if 0 block. --ryan. */
-#if 0
-#include <assert.h>
-#include <stdlib.h>
-#include <string.h>
-
-#define DEBUG_QSORT
-
-static char _ID[]="<qsort.c gjm 1.14 2016-02-21>";
-#endif
-/* END SDL CHANGE ... commented this out with an #if 0 block. --ryan. */
-
-/* How many bytes are there per word? (Must be a power of 2,
- * and must in fact equal sizeof(int).)
- */
-#define WORD_BYTES sizeof(int)
-
-/* How big does our stack need to be? Answer: one entry per
- * bit in a |size_t|.
- */
-#define STACK_SIZE (8*sizeof(size_t))
-
-/* Different situations have slightly different requirements,
- * and we make life epsilon easier by using different truncation
- * points for the three different cases.
- * So far, I have tuned TRUNC_words and guessed that the same
- * value might work well for the other two cases. Of course
- * what works well on my machine might work badly on yours.
- */
-#define TRUNC_nonaligned	12
-#define TRUNC_aligned		12
-#define TRUNC_words		12*WORD_BYTES	/* nb different meaning */
-
-/* We use a simple pivoting algorithm for shortish sub-arrays
- * and a more complicated one for larger ones. The threshold
- * is PIVOT_THRESHOLD.
- */
-#define PIVOT_THRESHOLD 40
-
-typedef struct { char * first; char * last; } stack_entry;
-#define pushLeft {stack[stacktop].first=ffirst;stack[stacktop++].last=last;}
-#define pushRight {stack[stacktop].first=first;stack[stacktop++].last=llast;}
-#define doLeft {first=ffirst;llast=last;continue;}
-#define doRight {ffirst=first;last=llast;continue;}
-#define pop {if (--stacktop<0) break;\
-  first=ffirst=stack[stacktop].first;\
-  last=llast=stack[stacktop].last;\
-  continue;}
-
-/* Some comments on the implementation.
- * 1. When we finish partitioning the array into "low"
- *    and "high", we forget entirely about short subarrays,
- *    because they'll be done later by insertion sort.
- *    Doing lots of little insertion sorts might be a win
- *    on large datasets for locality-of-reference reasons,
- *    but it makes the code much nastier and increases
- *    bookkeeping overhead.
- * 2. We always save the shorter and get to work on the
- *    longer. This guarantees that every time we push
- *    an item onto the stack its size is <= 1/2 of that
- *    of its parent; so the stack can't need more than
- *    log_2(max-array-size) entries.
- * 3. We choose a pivot by looking at the first, last
- *    and middle elements. We arrange them into order
- *    because it's easy to do that in conjunction with
- *    choosing the pivot, and it makes things a little
- *    easier in the partitioning step. Anyway, the pivot
- *    is the middle of these three. It's still possible
- *    to construct datasets where the algorithm takes
- *    time of order n^2, but it simply never happens in
- *    practice.
- * 3' Newsflash: On further investigation I find that
- *    it's easy to construct datasets where median-of-3
- *    simply isn't good enough. So on large-ish subarrays
- *    we do a more sophisticated pivoting: we take three
- *    sets of 3 elements, find their medians, and then
- *    take the median of those.
- * 4. We copy the pivot element to a separate place
- *    because that way we can always do our comparisons
- *    directly against a pointer to that separate place,
- *    and don't have to wonder "did we move the pivot
- *    element?". This makes the inner loop better.
- * 5. It's possible to make the pivoting even more
- *    reliable by looking at more candidates when n
- *    is larger. (Taking this to its logical conclusion
- *    results in a variant of quicksort that doesn't
- *    have that n^2 worst case.) However, the overhead
- *    from the extra bookkeeping means that it's just
- *    not worth while.
- * 6. This is pretty clean and portable code. Here are
- *    all the potential portability pitfalls and problems
- *    I know of:
- *      - In one place (the insertion sort) I construct
- *        a pointer that points just past the end of the
- *        supplied array, and assume that (a) it won't
- *        compare equal to any pointer within the array,
- *        and (b) it will compare equal to a pointer
- *        obtained by stepping off the end of the array.
- *        These might fail on some segmented architectures.
- *      - I assume that there are 8 bits in a |char| when
- *        computing the size of stack needed. This would
- *        fail on machines with 9-bit or 16-bit bytes.
- *      - I assume that if |((int)base&(sizeof(int)-1))==0|
- *        and |(size&(sizeof(int)-1))==0| then it's safe to
- *        get at array elements via |int*|s, and that if
- *        actually |size==sizeof(int)| as well then it's
- *        safe to treat the elements as |int|s. This might
- *        fail on systems that convert pointers to integers
- *        in non-standard ways.
- *      - I assume that |8*sizeof(size_t)<=INT_MAX|. This
- *        would be false on a machine with 8-bit |char|s,
- *        16-bit |int|s and 4096-bit |size_t|s. :-)
- */
-
-/* The recursion logic is the same in each case.
- * We keep chopping up until we reach subarrays of size
- * strictly less than Trunc; we leave these unsorted. */
-#define Recurse(Trunc)				\
-      { size_t l=last-ffirst,r=llast-first;	\
-        if (l<Trunc) {				\
-          if (r>=Trunc) doRight			\
-          else pop				\
-        }					\
-        else if (l<=r) { pushLeft; doRight }	\
-        else if (r>=Trunc) { pushRight; doLeft }\
-        else doLeft				\
-      }
-
-/* and so is the pivoting logic (note: last is inclusive): */
-#define Pivot(swapper,sz)			\
-  if ((size_t)(last-first)>PIVOT_THRESHOLD*sz) mid=pivot_big(first,mid,last,sz,compare);\
-  else {	\
-    if (compare(first,mid)<0) {			\
-      if (compare(mid,last)>0) {		\
-        swapper(mid,last);			\
-        if (compare(first,mid)>0) swapper(first,mid);\
-      }						\
-    }						\
-    else {					\
-      if (compare(mid,last)>0) swapper(first,last)\
-      else {					\
-        swapper(first,mid);			\
-        if (compare(mid,last)>0) swapper(mid,last);\
-      }						\
-    }						\
-    first+=sz; last-=sz;			\
-  }
-
-#ifdef DEBUG_QSORT
-#include <stdio.h>
-#endif
+    for (cur = begin + size; cur < end; cur += size) {
+        Uint8 *sift = cur;
+
+        if (!SDL_QSortLess(ctx, sift, sift - size)) {
+            continue;
+        }
+
+        if (size <= SDL_QSORT_TEMP_SIZE) {
+            Uint8 *tmp = ctx->temp.bytes;
+            SDL_QSortCopy(ctx, tmp, sift);
+            do {
+                SDL_QSortCopy(ctx, sift, sift - size);
+                sift -= size;
+            } while ((!guarded || sift != begin) && SDL_QSortLess(ctx, tmp, sift - size));
+            SDL_QSortCopy(ctx, sift, tmp);
+        } else {
+            do {
+                SDL_QSortSwap(ctx, sift, sift - size);
+                sift -= size;
+            } while ((!guarded || sift != begin) && SDL_QSortLess(ctx, sift, sift - size));
+        }
+
+        if (limit) {
+            moved += QS_COUNT(ctx, sift, cur);
+            if (moved > limit) {
+                return SDL_FALSE;
+            }
+        }
+    }
+    return SDL_TRUE;
+}
 
-/* and so is the partitioning logic: */
-#define Partition(swapper,sz) {			\
-  do {						\
-    while (compare(first,pivot)<0) first+=sz;	\
-    while (compare(pivot,last)<0) last-=sz;	\
-    if (first<last) {				\
-      swapper(first,last);			\
-      first+=sz; last-=sz; }			\
-    else if (first==last) { first+=sz; last-=sz; break; }\
-  } while (first<=last);			\
+static void
+SDL_QSortSiftDown(SDL_QSortContext *ctx, Uint8 *base, size_t root, size_t count)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && SDL_QSortLess(ctx, QS_AT(ctx, base, child), QS_AT(ctx, base, child + 1))) {
+            ++child;
+        }
+        if (!SDL_QSortLess(ctx, QS_AT(ctx, base, root), QS_AT(ctx, base, child))) {
+            break;
+        }
+        SDL_QSortSwap(ctx, QS_AT(ctx, base, root), QS_AT(ctx, base, child));
+        root = child;
+    }
 }
 
-/* and so is the pre-insertion-sort operation of putting
- * the smallest element into place as a sentinel.
- * Doing this makes the inner loop nicer. I got this
- * idea from the GNU implementation of qsort().
- * We find the smallest element from the first |nmemb|,
- * or the first |limit|, whichever is smaller;
- * therefore we must have ensured that the globally smallest
- * element is in the first |limit|.
- */
-#define PreInsertion(swapper,limit,sz)		\
-  first=base;					\
-  last=first + ((nmemb>limit ? limit : nmemb)-1)*sz;\
-  while (last!=base) {				\
-    if (compare(first,last)>0) first=last;	\
-    last-=sz; }					\
-  if (first!=base) swapper(first,(char*)base);
-
-/* and so is the insertion sort, in the first two cases: */
-#define Insertion(swapper)			\
-  last=((char*)base)+nmemb*size;		\
-  for (first=((char*)base)+size;first!=last;first+=size) {	\
-    char *test;					\
-    /* Find the right place for |first|.	\
-     * My apologies for var reuse. */		\
-    for (test=first-size;compare(test,first)>0;test-=size) ;	\
-    test+=size;					\
-    if (test!=first) {				\
-      /* Shift everything in [test,first)	\
-       * up by one, and place |first|		\
-       * where |test| is. */			\
-      memcpy(pivot,first,size);			\
-      memmove(test+size,test,first-test);	\
-      memcpy(test,pivot,size);			\
-    }						\
-  }
-
-#define SWAP_nonaligned(a,b) { \
-  register char *aa=(a),*bb=(b); \
-  register size_t sz=size; \
-  do { register char t=*aa; *aa++=*bb; *bb++=t; } while (--sz); }
-
-#define SWAP_aligned(a,b) { \
-  register int *aa=(int*)(a),*bb=(int*)(b); \
-  register size_t sz=size; \
-  do { register int t=*aa;*aa++=*bb; *bb++=t; } while (sz-=WORD_BYTES); }
-
-#define SWAP_words(a,b) { \
-  register int t=*((int*)a); *((int*)a)=*((int*)b); *((int*)b)=t; }
-
-/* ---------------------------------------------------------------------- */
-
-static char * pivot_big(char *first, char *mid, char *last, size_t size,
-                        int compare(const void *, const void *)) {
-  size_t d=(((last-first)/size)>>3)*size;
-#ifdef DEBUG_QSORT
-fprintf(stderr, "pivot_big: first=%p last=%p size=%lu n=%lu\n", first, (unsigned long)last, size, (unsigned long)((last-first+1)/size));
-#endif
-  char *m1,*m2,*m3;
-  { char *a=first, *b=first+d, *c=first+2*d;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"< %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m1 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-  { char *a=mid-d, *b=mid, *c=mid+d;
-#ifdef DEBUG_QSORT
-fprintf(stderr,". %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m2 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-  { char *a=last-2*d, *b=last-d, *c=last;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"> %d %d %d @ %p %p %p\n",*(int*)a,*(int*)b,*(int*)c, a,b,c);
-#endif
-    m3 = compare(a,b)<0 ?
-           (compare(b,c)<0 ? b : (compare(a,c)<0 ? c : a))
-         : (compare(a,c)<0 ? a : (compare(b,c)<0 ? c : b));
-  }
-#ifdef DEBUG_QSORT
-fprintf(stderr,"-> %d %d %d @ %p %p %p\n",*(int*)m1,*(int*)m2,*(int*)m3, m1,m2,m3);
-#endif
-  return compare(m1,m2)<0 ?
-           (compare(m2,m3)<0 ? m2 : (compare(m1,m3)<0 ? m3 : m1))
-         : (compare(m1,m3)<0 ? m1 : (compare(m2,m3)<0 ? m3 : m2));
+static void
+SDL_QSortHeap(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end)
+{
+    size_t count = QS_COUNT(ctx, begin, end);
+    size_t i;
+
+    for (i = count / 2; i-- > 0; ) {
+        SDL_QSortSiftDown(ctx, begin, i, count);
+    }
+    while (count > 1) {
+        --count;
+        SDL_QSortSwap(ctx, begin, QS_AT(ctx, begin, count));
+        SDL_QSortSiftDown(ctx, begin, 0, count);
+    }
 }
 
-/* ---------------------------------------------------------------------- */
-
-static void qsort_nonaligned(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
-
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(size);
-  size_t trunc=TRUNC_nonaligned*size;
-  assert(pivot!=0);
-
-  first=(char*)base; last=first+(nmemb-1)*size;
-
-  if ((size_t)(last-first)>=trunc) {
-    char *ffirst=first, *llast=last;
-    while (1) {
-      /* Select pivot */
-      { char * mid=first+size*((last-first)/size >> 1);
-        Pivot(SWAP_nonaligned,size);
-        memcpy(pivot,mid,size);
-      }
-      /* Partition. */
-      Partition(SWAP_nonaligned,size);
-      /* Prepare to recurse/iterate. */
-      Recurse(trunc)
+/* Partitions [begin, end) around the pivot at *begin, putting elements
+   equal to the pivot on the right. Returns the new pivot position and
+   whether the range was already partitioned. */
+static Uint8 *
+SDL_QSortPartitionRight(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end, SDL_bool *already_partitioned)
+{
+    const size_t size = ctx->size;
+    const Uint8 *pivot = begin;
+    Uint8 *first = begin;
+    Uint8 *last = end;
+
+    /* Find the first element not less than the pivot; the median of three
+       guarantees one exists. */
+    do {
+        first += size;
+    } while (SDL_QSortLess(ctx, first, pivot));
+
+    /* Find the first element less than the pivot from the right, guarded
+       if nothing was less than the pivot on the left. */
+    if (first - size == begin) {
+        while (first < last) {
+            last -= size;
+            if (SDL_QSortLess(ctx, last, pivot)) {
+                break;
+            }
+        }
+    } else {
+        do {
+            last -= size;
+        } while (!SDL_QSortLess(ctx, last, pivot));
+    }
+
+    *already_partitioned = (first >= last);
+
+    while (first < last) {
+        SDL_QSortSwap(ctx, first, last);
+        do {
+            first += size;
+        } while (SDL_QSortLess(ctx, first, pivot));
+        do {
+            last -= size;
+        } while (!SDL_QSortLess(ctx, last, pivot));
     }
-  }
-  PreInsertion(SWAP_nonaligned,TRUNC_nonaligned,size);
-  Insertion(SWAP_nonaligned);
-  free(pivot);
+
+    first -= size;
+    SDL_QSortSwap(ctx, begin, first);
+    return first;
 }
 
-static void qsort_aligned(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
-
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(size);
-  size_t trunc=TRUNC_aligned*size;
-  assert(pivot!=0);
-
-  first=(char*)base; last=first+(nmemb-1)*size;
-
-  if ((size_t)(last-first)>=trunc) {
-    char *ffirst=first,*llast=last;
-    while (1) {
-      /* Select pivot */
-      { char * mid=first+size*((last-first)/size >> 1);
-        Pivot(SWAP_aligned,size);
-        memcpy(pivot,mid,size);
-      }
-      /* Partition. */
-      Partition(SWAP_aligned,size);
-      /* Prepare to recurse/iterate. */
-      Recurse(trunc)
+/* Same as above, but classifies blocks of elements into offset buffers
+   before swapping, so the comparison results never decide a branch. */
+static Uint8 *
+SDL_QSortPartitionRightBlock(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end, SDL_bool *already_partitioned)
+{
+    const size_t size = ctx->size;
+    const Uint8 *pivot = begin;
+    Uint8 *first = begin;
+    Uint8 *last = end;
+
+    do {
+        first += size;
+    } while (SDL_QSortLess(ctx, first, pivot));
+
+    if (first - size == begin) {
+        while (first < last) {
+            last -= size;
+            if (SDL_QSortLess(ctx, last, pivot)) {
+                break;
+            }
+        }
+    } else {
+        do {
+            last -= size;
+        } while (!SDL_QSortLess(ctx, last, pivot));
     }
-  }
-  PreInsertion(SWAP_aligned,TRUNC_aligned,size);
-  Insertion(SWAP_aligned);
-  free(pivot);
+
+    *already_partitioned = (first >= last);
+
+    if (!*already_partitioned) {
+        Uint8 offsets_l[SDL_QSORT_BLOCK_SIZE];
+        Uint8 offsets_r[SDL_QSORT_BLOCK_SIZE];
+        Uint8 *offsets_l_base;
+        Uint8 *offsets_r_base;
+        size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        SDL_QSortSwap(ctx, first, last);
+        first += size;
+
+        offsets_l_base = first;
+        offsets_r_base = last;
+
+        while (first < last) {
+            const size_t num_unknown = QS_COUNT(ctx, first, last);
+            const size_t left_split = (num_l == 0) ? ((num_r == 0) ? num_unknown / 2 : num_unknown) : 0;
+            const size_t right_split = (num_r == 0) ? (num_unknown - left_split) : 0;
+            size_t i, num;
+
+            /* Record the offsets of elements that belong on the other side */
+            for (i = 0; i < SDL_min(left_split, SDL_QSORT_BLOCK_SIZE); ++i) {
+                offsets_l[num_l] = (Uint8)i;
+                num_l += !SDL_QSortLess(ctx, first, pivot);
+                first += size;
+            }
+            for (i = 0; i < SDL_min(right_split, SDL_QSORT_BLOCK_SIZE); ) {
+                last -= size;
+                offsets_r[num_r] = (Uint8)++i;
+                num_r += SDL_QSortLess(ctx, last, pivot);
+            }
+
+            /* Swap as many misplaced pairs as we found on both sides */
+            num = SDL_min(num_l, num_r);
+            for (i = 0; i < num; ++i) {
+                SDL_QSortSwap(ctx, QS_AT(ctx, offsets_l_base, offsets_l[start_l + i]),
+                                   QS_AT(ctx, offsets_r_base, -(intptr_t)offsets_r[start_r + i]));
+            }
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+
+            if (num_l == 0) {
+                start_l = 0;
+                offsets_l_base = first;
+            }
+            if (num_r == 0) {
+                start_r = 0;
+                offsets_r_base = last;
+            }
+        }
+
+        /* At most one side has leftovers, move them to the middle */
+        if (num_l) {
+            while (num_l--) {
+                last -= size;
+                SDL_QSortSwap(ctx, QS_AT(ctx, offsets_l_base, offsets_l[start_l + num_l]), last);
+            }
+            first = last;
+        }
+        if (num_r) {
+            while (num_r--) {
+                SDL_QSortSwap(ctx, QS_AT(ctx, offsets_r_base, -(intptr_t)offsets_r[start_r + num_r]), first);
+                first += size;
+            }
+        }
+    }
+
+    first -= size;
+    SDL_QSortSwap(ctx, begin, first);
+    return first;
 }
 
-static void qsort_words(void *base, size_t nmemb,
-           int (*compare)(const void *, const void *)) {
+/* Partitions [begin, end) around the pivot at *begin, putting elements
+   equal to the pivot on the left. Used when the pivot is known to equal
+   the element before the range, which happens with many duplicates. */
+static Uint8 *
+SDL_QSortPartitionLeft(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end)
+{
+    const size_t size = ctx->size;
+    const Uint8 *pivot = begin;
+    Uint8 *first = begin;
+    Uint8 *last = end;
+
+    do {
+        last -= size;
+    } while (SDL_QSortLess(ctx, pivot, last));
+
+    if (last + size == end) {
+        while (first < last) {
+            first += size;
+            if (SDL_QSortLess(ctx, pivot, first)) {
+                break;
+            }
+        }
+    } else {
+        do {
+            first += size;
+        } while (!SDL_QSortLess(ctx, pivot, first));
+    }
 
-  stack_entry stack[STACK_SIZE];
-  int stacktop=0;
-  char *first,*last;
-  char *pivot=malloc(WORD_BYTES);
-  assert(pivot!=0);
+    while (first < last) {
+        SDL_QSortSwap(ctx, first, last);
+        do {
+            last -= size;
+        } while (SDL_QSortLess(ctx, pivot, last));
+        do {
+            first += size;
+        } while (!SDL_QSortLess(ctx, pivot, first));
+    }
 
-  first=(char*)base; last=first+(nmemb-1)*WORD_BYTES;
+    SDL_QSortSwap(ctx, begin, last);
+    return last;
+}
 
-  if (last-first>=TRUNC_words) {
-    char *ffirst=first, *llast=last;
-    while (1) {
-#ifdef DEBUG_QSORT
-fprintf(stderr,"Doing %d:%d: ",
-        (first-(char*)base)/WORD_BYTES,
-        (last-(char*)base)/WORD_BYTES);
-#endif
-      /* Select pivot */
-      { char * mid=first+WORD_BYTES*((last-first) / (2*WORD_BYTES));
-        Pivot(SWAP_words,WORD_BYTES);
-        *(int*)pivot=*(int*)mid;
-#ifdef DEBUG_QSORT
-fprintf(stderr,"pivot = %p = #%lu = %d\n", mid, (unsigned long)(((int*)mid)-((int*)base)), *(int*)mid);
-#endif
-      }
-      /* Partition. */
-      Partition(SWAP_words,WORD_BYTES);
-#ifdef DEBUG_QSORT
-fprintf(stderr, "after partitioning first=#%lu last=#%lu\n", (first-(char*)base)/4lu, (last-(char*)base)/4lu);
-#endif
-      /* Prepare to recurse/iterate. */
-      Recurse(TRUNC_words)
+static void
+SDL_QSortLoop(SDL_QSortContext *ctx, Uint8 *begin, Uint8 *end, int bad_allowed, SDL_bool leftmost)
+{
+    const size_t esize = ctx->size;
+
+    for (;;) {
+        const size_t size = QS_COUNT(ctx, begin, end);
+        const size_t s2 = size / 2;
+        size_t l_size, r_size;
+        SDL_bool already_partitioned;
+        Uint8 *pivot_pos;
+
+        if (size < SDL_QSORT_INSERTION_THRESHOLD) {
+            SDL_QSortInsertion(ctx, begin, end, leftmost, 0);
+            return;
+        }
+
+        /* Move the median of three, or the pseudomedian of nine, to begin */
+        if (size > SDL_QSORT_NINTHER_THRESHOLD) {
+            SDL_QSortSort3(ctx, begin, QS_AT(ctx, begin, s2), end - esize);
+            SDL_QSortSort3(ctx, begin + esize, QS_AT(ctx, begin, s2 - 1), end - 2 * esize);
+            SDL_QSortSort3(ctx, begin + 2 * esize, QS_AT(ctx, begin, s2 + 1), end - 3 * esize);
+            SDL_QSortSort3(ctx, QS_AT(ctx, begin, s2 - 1), QS_AT(ctx, begin, s2), QS_AT(ctx, begin, s2 + 1));
+            SDL_QSortSwap(ctx, begin, QS_AT(ctx, begin, s2));
+        } else {
+            SDL_QSortSort3(ctx, QS_AT(ctx, begin, s2), begin, end - esize);
+        }
+
+        /* If the pivot equals the element before this range, everything
+           equal to it is already in place; skip over all of it. */
+        if (!leftmost && !SDL_QSortLess(ctx, begin - esize, begin)) {
+            begin = SDL_QSortPartitionLeft(ctx, begin, end) + esize;
+            continue;
+        }
+
+        if (esize <= SDL_QSORT_BLOCK_MAX_ELEMENT) {
+            pivot_pos = SDL_QSortPartitionRightBlock(ctx, begin, end, &already_partitioned);
+        } else {
+            pivot_pos = SDL_QSortPartitionRight(ctx, begin, end, &already_partitioned);
+        }
+
+        l_size = QS_COUNT(ctx, begin, pivot_pos);
+        r_size = QS_COUNT(ctx, pivot_pos + esize, end);
+
+        if (l_size < size / 8 || r_size < size / 8) {
+            /* Too many bad partitions, this input defeats the pivoting */
+            if (--bad_allowed == 0) {
+                SDL_QSortHeap(ctx, begin, end);
+                return;
+            }
+
+            /* Shuffle some elements around to break up patterns */
+            if (l_size >= SDL_QSORT_INSERTION_THRESHOLD) {
+                SDL_QSortSwap(ctx, begin, QS_AT(ctx, begin, l_size / 4));
+                SDL_QSortSwap(ctx, pivot_pos - esize, QS_AT(ctx, pivot_pos, -(intptr_t)(l_size / 4)));
+                if (l_size > SDL_QSORT_NINTHER_THRESHOLD) {
+                    SDL_QSortSwap(ctx, begin + esize, QS_AT(ctx, begin, l_size / 4 + 1));
+                    SDL_QSortSwap(ctx, begin + 2 * esize, QS_AT(ctx, begin, l_size / 4 + 2));
+                    SDL_QSortSwap(ctx, pivot_pos - 2 * esize, QS_AT(ctx, pivot_pos, -(intptr_t)(l_size / 4 + 1)));
+                    SDL_QSortSwap(ctx, pivot_pos - 3 * esize, QS_AT(ctx, pivot_pos, -(intptr_t)(l_size / 4 + 2)));
+                }
+            }
+            if (r_size >= SDL_QSORT_INSERTION_THRESHOLD) {
+                SDL_QSortSwap(ctx, pivot_pos + esize, QS_AT(ctx, pivot_pos, 1 + r_size / 4));
+                SDL_QSortSwap(ctx, end - esize, QS_AT(ctx, end, -(intptr_t)(r_size / 4)));
+                if (r_size > SDL_QSORT_NINTHER_THRESHOLD) {
+                    SDL_QSortSwap(ctx, pivot_pos + 2 * esize, QS_AT(ctx, pivot_pos, 2 + r_size / 4));
+                    SDL_QSortSwap(ctx, pivot_pos + 3 * esize, QS_AT(ctx, pivot_pos, 3 + r_size / 4));
+                    SDL_QSortSwap(ctx, end - 2 * esize, QS_AT(ctx, end, -(intptr_t)(1 + r_size / 4)));
+                    SDL_QSortSwap(ctx, end - 3 * esize, QS_AT(ctx, end, -(intptr_t)(2 + r_size / 4)));
+                }
+            }
+        } else if (already_partitioned &&
+                   SDL_QSortInsertion(ctx, begin, pivot_pos, leftmost, SDL_QSORT_PARTIAL_INSERTION_LIMIT) &&
+                   SDL_QSortInsertion(ctx, pivot_pos + esize, end, SDL_FALSE, SDL_QSORT_PARTIAL_INSERTION_LIMIT)) {
+            /* The range was already sorted, or very nearly */
+            return;
+        }
+
+        /* Recurse into the smaller side so the stack stays logarithmic */
+        if (l_size < r_size) {
+            SDL_QSortLoop(ctx, begin, pivot_pos, bad_allowed, leftmost);
+            begin = pivot_pos + esize;
+            leftmost = SDL_FALSE;
+        } else {
+            SDL_QSortLoop(ctx, pivot_pos + esize, end, bad_allowed, SDL_FALSE);
+            end = pivot_pos;
+        }
     }
-  }
-  PreInsertion(SWAP_words,(TRUNC_words/WORD_BYTES),WORD_BYTES);
-  /* Now do insertion sort. */
-  last=((char*)base)+nmemb*WORD_BYTES;
-  for (first=((char*)base)+WORD_BYTES;first!=last;first+=WORD_BYTES) {
-    /* Find the right place for |first|. My apologies for var reuse */
-    int *pl=(int*)(first-WORD_BYTES),*pr=(int*)first;
-    *(int*)pivot=*(int*)first;
-    for (;compare(pl,pivot)>0;pr=pl,--pl) {
-      *pr=*pl; }
-    if (pr!=(int*)first) *pr=*(int*)pivot;
-  }
-  free(pivot);
 }
 
-/* ---------------------------------------------------------------------- */
+static void
+SDL_QSortRun(SDL_QSortContext *ctx, void *base, size_t nmemb)
+{
+    Uint8 *begin = (Uint8 *)base;
+    int log2 = 0;
+    size_t n;
+
+    if (nmemb <= 1 || ctx->size == 0) {
+        return;
+    }
 
-extern void qsortG(void *base, size_t nmemb, size_t size,
-           int (*compare)(const void *, const void *)) {
+    if (((uintptr_t)base & 3) == 0 && ctx->size == 4) {
+        ctx->kind = SDL_QSORT_UINT32;
+    } else if (((uintptr_t)base & 7) == 0 && ctx->size == 8) {
+        ctx->kind = SDL_QSORT_UINT64;
+    } else if ((((uintptr_t)base | ctx->size) & (sizeof(size_t) - 1)) == 0) {
+        ctx->kind = SDL_QSORT_WORDS;
+    } else {
+        ctx->kind = SDL_QSORT_BYTES;
+    }
 
-  if (nmemb<=1) return;
-  if (((size_t)base|size)&(WORD_BYTES-1))
-    qsort_nonaligned(base,nmemb,size,compare);
-  else if (size!=WORD_BYTES)
-    qsort_aligned(base,nmemb,size,compare);
-  else
-    qsort_words(base,nmemb,compare);
+    for (n = nmemb; n > 1; n >>= 1) {
+        ++log2;
+    }
+    SDL_QSortLoop(ctx, begin, QS_AT(ctx, begin, nmemb), log2, SDL_TRUE);
 }
 
+void
+SDL_qsort_r(void *base, size_t nmemb, size_t size, int (*compare) (void *, const void *, const void *), void *userdata)
+{
+    SDL_QSortContext ctx;
+
+    ctx.size = size;
+    ctx.compare = NULL;
+    ctx.compare_r = compare;
+    ctx.userdata = userdata;
+    SDL_QSortRun(&ctx, base, nmemb);
+}
+
+#if defined(HAVE_QSORT)
+void
+SDL_qsort(void *base, size_t nmemb, size_t size, int (*compare) (const void *, const void *))
+{
+    qsort(base, nmemb, size, compare);
+}
+#else
+void
+SDL_qsort(void *base, size_t nmemb, size_t size, int (*compare) (const void *, const void *))
+{
+    SDL_QSortContext ctx;
 
+    ctx.size = size;
+    ctx.compare = compare;
+    ctx.compare_r = NULL;
+    ctx.userdata = NULL;
+    SDL_QSortRun(&ctx, base, nmemb);
+}
 #endif /* HAVE_QSORT */
 
 /* vi: set ts=4 sw=4 expandtab: */
-
@@ -27,6 +27,47 @@
 /* This file contains portable string manipulation functions for SDL */
 
 #include "SDL_stdinc.h"
+#include "SDL_cpuinfo.h"
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(SDL_DISABLE_ARM_NEON_H)
+#include <arm_neon.h>
+#define SDL_STRING_NEON 1
+#endif
+
+/* Helpers for working on a machine word at a time.
+   SDL_WORD_HAS_ZERO() is non-zero if any byte in the word is zero. */
+#define SDL_WORD_SIZE           sizeof(size_t)
+#define SDL_WORD_ONES           (~(size_t)0 / 0xFF)
+#define SDL_WORD_HIGHS          (SDL_WORD_ONES * 0x80)
+#define SDL_WORD_HAS_ZERO(x)    (((x) - SDL_WORD_ONES) & ~(x) & SDL_WORD_HIGHS)
+#define SDL_WORD_ALIGNED(p)     (((uintptr_t)(p) & (SDL_WORD_SIZE - 1)) == 0)
+
+#ifdef __SSE2__
+/* Index of the lowest set bit in a non-zero movemask result */
+static SDL_INLINE int
+SDL_FirstBitIndex(unsigned int mask)
+{
+#if defined(__GNUC__) && (__GNUC__ >= 4)
+    return __builtin_ctz(mask);
+#else
+    int index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+static SDL_INLINE int
+SDL_CountBits16(unsigned int mask)
+{
+    mask = mask - ((mask >> 1) & 0x5555);
+    mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+    mask = (mask + (mask >> 4)) & 0x0F0F;
+    return (int)((mask + (mask >> 8)) & 0x1F);
+}
+#endif /* __SSE2__ */
 
 #if !defined(HAVE_VSSCANF) || !defined(HAVE_STRTOL) || !defined(HAVE_STRTOUL)  || !defined(HAVE_STRTOLL) || !defined(HAVE_STRTOULL) || !defined(HAVE_STRTOD)
 #define SDL_isupperhex(X)   (((X) >= 'A') && ((X) <= 'F'))
@@ -268,42 +309,65 @@ SDL_memset(SDL_OUT_BYTECAP(len) void *dst, int c, size_t len)
 #if defined(HAVE_MEMSET)
     return memset(dst, c, len);
 #else
-    size_t left;
-    Uint32 *dstp4;
     Uint8 *dstp1 = (Uint8 *) dst;
     Uint8 value1;
-    Uint32 value4;
+    size_t value;
 
     /* The value used in memset() is a byte, passed as an int */
     c &= 0xff;
-
-    /* The destination pointer needs to be aligned on a 4-byte boundary to
-     * execute a 32-bit set. Set first bytes manually if needed until it is
-     * aligned. */
     value1 = (Uint8)c;
-    while ((intptr_t)dstp1 & 0x3) {
-        if (len--) {
+
+#if defined(__SSE2__)
+    if (len >= 64) {
+        const __m128i value16 = _mm_set1_epi8((char)value1);
+
+        while ((uintptr_t)dstp1 & 15) {
             *dstp1++ = value1;
-        } else {
+            --len;
+        }
+        while (len >= 64) {
+            _mm_store_si128((__m128i *)(dstp1 + 0), value16);
+            _mm_store_si128((__m128i *)(dstp1 + 16), value16);
+            _mm_store_si128((__m128i *)(dstp1 + 32), value16);
+            _mm_store_si128((__m128i *)(dstp1 + 48), value16);
+            dstp1 += 64;
+            len -= 64;
+        }
+    }
+#elif defined(SDL_STRING_NEON)
+    if (len >= 64) {
+        const uint8x16_t value16 = vdupq_n_u8(value1);
+
+        while (len >= 64) {
+            vst1q_u8(dstp1 + 0, value16);
+            vst1q_u8(dstp1 + 16, value16);
+            vst1q_u8(dstp1 + 32, value16);
+            vst1q_u8(dstp1 + 48, value16);
+            dstp1 += 64;
+            len -= 64;
+        }
+    }
+#endif
+
+    /* The destination pointer needs to be aligned on a word boundary to
+     * execute a word sized set. Set first bytes manually if needed until
+     * it is aligned. */
+    while (!SDL_WORD_ALIGNED(dstp1)) {
+        if (!len) {
             return dst;
         }
+        *dstp1++ = value1;
+        --len;
     }
 
-    value4 = (c | (c << 8) | (c << 16) | (c << 24));
-    dstp4 = (Uint32 *) dstp1;
-    left = (len % 4);
-    len /= 4;
-    while (len--) {
-        *dstp4++ = value4;
+    value = SDL_WORD_ONES * value1;
+    while (len >= SDL_WORD_SIZE) {
+        *(size_t *)dstp1 = value;
+        dstp1 += SDL_WORD_SIZE;
+        len -= SDL_WORD_SIZE;
     }
 
-    dstp1 = (Uint8 *) dstp4;
-    switch (left) {
-    case 3:
-        *dstp1++ = value1;
-    case 2:
-        *dstp1++ = value1;
-    case 1:
+    while (len--) {
         *dstp1++ = value1;
     }
 
@@ -314,7 +378,7 @@ SDL_memset(SDL_OUT_BYTECAP(len) void *dst, int c, size_t len)
 void *
 SDL_memcpy(SDL_OUT_BYTECAP(len) void *dst, SDL_IN_BYTECAP(len) const void *src, size_t len)
 {
-#ifdef __GNUC__
+#if defined(HAVE_MEMCPY) && defined(__GNUC__)
     /* Presumably this is well tuned for speed.
        On my machine this is twice as fast as the C code below.
      */
@@ -325,43 +389,72 @@ SDL_memcpy(SDL_OUT_BYTECAP(len) void *dst, SDL_IN_BYTECAP(len) const void *src,
     bcopy(src, dst, len);
     return dst;
 #else
+    /* Without a C library __builtin_memcpy() may turn into a call to a
+       memcpy() we don't have, so do the work ourselves. */
+    const Uint8 *srcp1 = (const Uint8 *)src;
+    Uint8 *dstp1 = (Uint8 *)dst;
+
+#if defined(__SSE2__)
+    if (len >= 64) {
+        /* Align the destination, the source may stay unaligned */
+        while ((uintptr_t)dstp1 & 15) {
+            *dstp1++ = *srcp1++;
+            --len;
+        }
+        while (len >= 64) {
+            __m128i values[4];
+            values[0] = _mm_loadu_si128((const __m128i *)(srcp1 + 0));
+            values[1] = _mm_loadu_si128((const __m128i *)(srcp1 + 16));
+            values[2] = _mm_loadu_si128((const __m128i *)(srcp1 + 32));
+            values[3] = _mm_loadu_si128((const __m128i *)(srcp1 + 48));
+            _mm_store_si128((__m128i *)(dstp1 + 0), values[0]);
+            _mm_store_si128((__m128i *)(dstp1 + 16), values[1]);
+            _mm_store_si128((__m128i *)(dstp1 + 32), values[2]);
+            _mm_store_si128((__m128i *)(dstp1 + 48), values[3]);
+            srcp1 += 64;
+            dstp1 += 64;
+            len -= 64;
+        }
+    }
+#elif defined(SDL_STRING_NEON)
+    while (len >= 64) {
+        uint8x16_t values[4];
+        values[0] = vld1q_u8(srcp1 + 0);
+        values[1] = vld1q_u8(srcp1 + 16);
+        values[2] = vld1q_u8(srcp1 + 32);
+        values[3] = vld1q_u8(srcp1 + 48);
+        vst1q_u8(dstp1 + 0, values[0]);
+        vst1q_u8(dstp1 + 16, values[1]);
+        vst1q_u8(dstp1 + 32, values[2]);
+        vst1q_u8(dstp1 + 48, values[3]);
+        srcp1 += 64;
+        dstp1 += 64;
+        len -= 64;
+    }
+#endif
+
     /* GCC 4.9.0 with -O3 will generate movaps instructions with the loop
-       using Uint32* pointers, so we need to make sure the pointers are
+       using word pointers, so we need to make sure the pointers are
        aligned before we loop using them.
      */
-    if (((intptr_t)src & 0x3) || ((intptr_t)dst & 0x3)) {
-        /* Do an unaligned byte copy */
-        Uint8 *srcp1 = (Uint8 *)src;
-        Uint8 *dstp1 = (Uint8 *)dst;
-
-        while (len--) {
+    if (((uintptr_t)srcp1 & (SDL_WORD_SIZE - 1)) == ((uintptr_t)dstp1 & (SDL_WORD_SIZE - 1))) {
+        while (len && !SDL_WORD_ALIGNED(dstp1)) {
             *dstp1++ = *srcp1++;
+            --len;
         }
-    } else {
-        size_t left = (len % 4);
-        Uint32 *srcp4, *dstp4;
-        Uint8 *srcp1, *dstp1;
-
-        srcp4 = (Uint32 *) src;
-        dstp4 = (Uint32 *) dst;
-        len /= 4;
-        while (len--) {
-            *dstp4++ = *srcp4++;
+        while (len >= SDL_WORD_SIZE) {
+            *(size_t *)dstp1 = *(const size_t *)srcp1;
+            srcp1 += SDL_WORD_SIZE;
+            dstp1 += SDL_WORD_SIZE;
+            len -= SDL_WORD_SIZE;
         }
+    }
 
-        srcp1 = (Uint8 *) srcp4;
-        dstp1 = (Uint8 *) dstp4;
-        switch (left) {
-        case 3:
-            *dstp1++ = *srcp1++;
-        case 2:
-            *dstp1++ = *srcp1++;
-        case 1:
-            *dstp1++ = *srcp1++;
-        }
+    while (len--) {
+        *dstp1++ = *srcp1++;
     }
     return dst;
-#endif /* __GNUC__ */
+#endif /* HAVE_MEMCPY */
 }
 
 void *
@@ -394,8 +487,41 @@ SDL_memcmp(const void *s1, const void *s2, size_t len)
 #if defined(HAVE_MEMCMP)
     return memcmp(s1, s2, len);
 #else
-    char *s1p = (char *) s1;
-    char *s2p = (char *) s2;
+    const Uint8 *s1p = (const Uint8 *) s1;
+    const Uint8 *s2p = (const Uint8 *) s2;
+
+#if defined(__SSE2__)
+    while (len >= 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i *)s1p);
+        const __m128i b = _mm_loadu_si128((const __m128i *)s2p);
+        const unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+        if (mask != 0xFFFF) {
+            const int i = SDL_FirstBitIndex(~mask & 0xFFFF);
+            return (s1p[i] - s2p[i]);
+        }
+        s1p += 16;
+        s2p += 16;
+        len -= 16;
+    }
+#else
+    /* Skip over the matching words, the byte loop below finds the difference */
+    if (((uintptr_t)s1p & (SDL_WORD_SIZE - 1)) == ((uintptr_t)s2p & (SDL_WORD_SIZE - 1))) {
+        while (len && !SDL_WORD_ALIGNED(s1p)) {
+            if (*s1p != *s2p) {
+                return (*s1p - *s2p);
+            }
+            ++s1p;
+            ++s2p;
+            --len;
+        }
+        while (len >= SDL_WORD_SIZE && *(const size_t *)s1p == *(const size_t *)s2p) {
+            s1p += SDL_WORD_SIZE;
+            s2p += SDL_WORD_SIZE;
+            len -= SDL_WORD_SIZE;
+        }
+    }
+#endif
+
     while (len--) {
         if (*s1p != *s2p) {
             return (*s1p - *s2p);
@@ -413,11 +539,42 @@ SDL_strlen(const char *string)
 #if defined(HAVE_STRLEN)
     return strlen(string);
 #else
-    size_t len = 0;
-    while (*string++) {
-        ++len;
+    /* Aligned loads never cross into a page the string doesn't touch */
+    const char *p = string;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const int offset = (int)((uintptr_t)p & 15);
+    unsigned int mask;
+
+    p -= offset;
+    mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero));
+    mask >>= offset;
+    if (mask) {
+        return SDL_FirstBitIndex(mask);
     }
-    return len;
+    for (;;) {
+        p += 16;
+        mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero));
+        if (mask) {
+            return (size_t)(p - string) + SDL_FirstBitIndex(mask);
+        }
+    }
+#else
+    while (!SDL_WORD_ALIGNED(p)) {
+        if (!*p) {
+            return (size_t)(p - string);
+        }
+        ++p;
+    }
+    while (!SDL_WORD_HAS_ZERO(*(const size_t *)p)) {
+        p += SDL_WORD_SIZE;
+    }
+    while (*p) {
+        ++p;
+    }
+    return (size_t)(p - string);
+#endif
 #endif /* HAVE_STRLEN */
 }
 
@@ -549,13 +706,63 @@ SDL_utf8strlen(const char *str)
     const char *p = str;
     char ch;
 
+    /* Count whole blocks of non-zero bytes at once. This is the number of
+       bytes minus the number of continuation bytes, which have their top
+       two bits set to 1 and 0. Loads are aligned so they never cross into
+       a page the string doesn't touch. */
+#if defined(__SSE2__)
+    while ((uintptr_t)p & 15) {
+        if (!(ch = *(p++))) {
+            return retval;
+        }
+        if ((ch & 0xc0) != 0x80) {
+            retval++;
+        }
+    }
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i top2 = _mm_set1_epi8((char)0xc0);
+        const __m128i cont = _mm_set1_epi8((char)0x80);
+        for (;;) {
+            const __m128i bytes = _mm_load_si128((const __m128i *)p);
+            unsigned int mask;
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero))) {
+                break;
+            }
+            mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bytes, top2), cont));
+            retval += 16 - SDL_CountBits16(mask);
+            p += 16;
+        }
+    }
+#else
+    while (!SDL_WORD_ALIGNED(p)) {
+        if (!(ch = *(p++))) {
+            return retval;
+        }
+        if ((ch & 0xc0) != 0x80) {
+            retval++;
+        }
+    }
+    for (;;) {
+        const size_t bytes = *(const size_t *)p;
+        size_t conts;
+        if (SDL_WORD_HAS_ZERO(bytes)) {
+            break;
+        }
+        /* bit 7 set and bit 6 clear, one bit per continuation byte */
+        conts = (bytes & ~(bytes << 1) & SDL_WORD_HIGHS) >> 7;
+        retval += SDL_WORD_SIZE - (size_t)((conts * SDL_WORD_ONES) >> ((SDL_WORD_SIZE - 1) * 8));
+        p += SDL_WORD_SIZE;
+    }
+#endif
+
     while ((ch = *(p++))) {
         /* if top two bits are 1 and 0, it's a continuation byte. */
         if ((ch & 0xc0) != 0x80) {
             retval++;
         }
     }
-    
+
     return retval;
 }
 
@@ -642,13 +849,36 @@ SDL_strchr(const char *string, int c)
 #elif defined(HAVE_INDEX)
     return SDL_const_cast(char*,index(string, c));
 #else
+    const char ch = (char) c;
+    size_t pattern;
+
+    while (!SDL_WORD_ALIGNED(string)) {
+        if (*string == ch) {
+            return (char *) string;
+        }
+        if (!*string) {
+            return NULL;
+        }
+        ++string;
+    }
+
+    /* Skip words that contain neither the terminator nor the character */
+    pattern = SDL_WORD_ONES * (Uint8) ch;
+    for (;;) {
+        const size_t bytes = *(const size_t *)string;
+        if (SDL_WORD_HAS_ZERO(bytes) || SDL_WORD_HAS_ZERO(bytes ^ pattern)) {
+            break;
+        }
+        string += SDL_WORD_SIZE;
+    }
+
     while (*string) {
-        if (*string == c) {
+        if (*string == ch) {
             return (char *) string;
         }
         ++string;
     }
-    return NULL;
+    return (ch == '\0') ? (char *) string : NULL;
 #endif /* HAVE_STRCHR */
 }
 
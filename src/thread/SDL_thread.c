@@ -295,6 +295,9 @@ SDL_RunThread(void *data)
             SDL_free(thread);
         }
     }
+
+    /* Give any memory this thread cached back to the other threads */
+    SDL_FlushThreadMemoryCache();
 }
 
 #ifdef SDL_CreateThread
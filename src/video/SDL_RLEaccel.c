@@ -112,22 +112,59 @@
  * This can be used for any RGB permutation of course.
  */
 #define ALPHA_BLIT32_888(to, from, length, bpp, alpha)      \
-    do {                                                    \
-        int i;                                              \
-        Uint32 *src = (Uint32 *)(from);                     \
-        Uint32 *dst = (Uint32 *)(to);                       \
-        for (i = 0; i < (int)(length); i++) {               \
-            Uint32 s = *src++;                              \
-            Uint32 d = *dst;                                \
-            Uint32 s1 = s & 0xff00ff;                       \
-            Uint32 d1 = d & 0xff00ff;                       \
-            d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff; \
-            s &= 0xff00;                                    \
-            d &= 0xff00;                                    \
-            d = (d + ((s - d) * alpha >> 8)) & 0xff00;      \
-            *dst++ = d1 | d;                                \
-        }                                                   \
-    } while (0)
+    AlphaBlitRun888((Uint32 *)(to), (const Uint32 *)(from), (int)(length), alpha)
+
+#ifdef __SSE2__
+/*
+ * Blend the 8 components unpacked into the 16-bit lanes of s and d, given
+ * alpha * 128 in the lanes of a.  Each component becomes
+ * d + ((s - d) * alpha >> 8), which is exactly what the packed arithmetic
+ * of the scalar 888 blitters works out to, so both give the same result.
+ */
+static SDL_INLINE __m128i
+Blend888SSE2(__m128i s, __m128i d, __m128i a)
+{
+    __m128i diff = _mm_slli_epi16(_mm_sub_epi16(s, d), 1);
+    return _mm_add_epi16(d, _mm_mulhi_epi16(diff, a));
+}
+#endif
+
+static void
+AlphaBlitRun888(Uint32 * dst, const Uint32 * src, int length, unsigned alpha)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbmask = _mm_set1_epi32(0x00ffffff);
+        const __m128i a = _mm_set1_epi16((short)(alpha << 7));
+
+        for (; i + 4 <= length; i += 4) {
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+            __m128i lo = Blend888SSE2(_mm_unpacklo_epi8(s, zero),
+                                      _mm_unpacklo_epi8(d, zero), a);
+            __m128i hi = Blend888SSE2(_mm_unpackhi_epi8(s, zero),
+                                      _mm_unpackhi_epi8(d, zero), a);
+            _mm_storeu_si128((__m128i *)(dst + i),
+                             _mm_and_si128(_mm_packus_epi16(lo, hi), rgbmask));
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        Uint32 s = src[i];
+        Uint32 d = dst[i];
+        Uint32 s1 = s & 0xff00ff;
+        Uint32 d1 = d & 0xff00ff;
+        d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+        s &= 0xff00;
+        d &= 0xff00;
+        d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+        dst[i] = d1 | d;
+    }
+}
 
 /*
  * For 16bpp pixels we can go a step further: put the middle component
@@ -610,6 +647,61 @@ SDL_RLEBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
     dst = (Uint16)(d | d >> 16);            \
     } while(0)
 
+/*
+ * Blend a run of translucent pixels.  The 32bpp case does four pixels at a
+ * time when it can, taking the alpha of each from its top byte.
+ */
+#define BLIT_TRANSL_RUN(do_blend, dst, src, length)     \
+    do {                                                \
+        int i;                                          \
+        for (i = 0; i < (int)(length); i++)             \
+            do_blend((src)[i], (dst)[i]);               \
+    } while(0)
+
+#define BLIT_TRANSL_RUN_565(dst, src, length)   \
+    BLIT_TRANSL_RUN(BLIT_TRANSL_565, dst, src, length)
+
+#define BLIT_TRANSL_RUN_555(dst, src, length)   \
+    BLIT_TRANSL_RUN(BLIT_TRANSL_555, dst, src, length)
+
+#define BLIT_TRANSL_RUN_888(dst, src, length)   \
+    BlitTranslRun888(dst, src, (int)(length))
+
+static void
+BlitTranslRun888(Uint32 * dst, const Uint32 * src, int length)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i amask = _mm_set1_epi32(0xff000000);
+
+        for (; i + 4 <= length; i += 4) {
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+            __m128i slo = _mm_unpacklo_epi8(s, zero);
+            __m128i shi = _mm_unpackhi_epi8(s, zero);
+            __m128i alo, ahi, lo, hi;
+
+            /* spread the alpha of each pixel over its components */
+            alo = _mm_shufflelo_epi16(slo, _MM_SHUFFLE(3, 3, 3, 3));
+            alo = _mm_shufflehi_epi16(alo, _MM_SHUFFLE(3, 3, 3, 3));
+            ahi = _mm_shufflelo_epi16(shi, _MM_SHUFFLE(3, 3, 3, 3));
+            ahi = _mm_shufflehi_epi16(ahi, _MM_SHUFFLE(3, 3, 3, 3));
+            lo = Blend888SSE2(slo, _mm_unpacklo_epi8(d, zero), _mm_slli_epi16(alo, 7));
+            hi = Blend888SSE2(shi, _mm_unpackhi_epi8(d, zero), _mm_slli_epi16(ahi, 7));
+            _mm_storeu_si128((__m128i *)(dst + i),
+                             _mm_or_si128(_mm_packus_epi16(lo, hi), amask));
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        BLIT_TRANSL_888(src[i], dst[i]);
+    }
+}
+
 /* used to save the destination format in the encoding. Designed to be
    macro-compatible with SDL_PixelFormat but without the unneeded fields */
 typedef struct
@@ -638,10 +730,10 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
     SDL_PixelFormat *df = surf_dst->format;
     /*
      * clipped blitter: Ptype is the destination pixel type,
-     * Ctype the translucent count type, and do_blend the macro
-     * to blend one pixel.
+     * Ctype the translucent count type, and do_blend_run the macro
+     * to blend a run of pixels.
      */
-#define RLEALPHACLIPBLIT(Ptype, Ctype, do_blend)              \
+#define RLEALPHACLIPBLIT(Ptype, Ctype, do_blend_run)          \
     do {                                  \
     int linecount = srcrect->h;                   \
     int left = srcrect->x;                        \
@@ -694,13 +786,9 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
             }                             \
             if(crun > right - cofs)               \
             crun = right - cofs;                  \
-            if(crun > 0) {                    \
-            Ptype *dst = (Ptype *)dstbuf + cofs;          \
-            Uint32 *src = (Uint32 *)srcbuf + (cofs - ofs);    \
-            int i;                        \
-            for(i = 0; i < crun; i++)             \
-                do_blend(src[i], dst[i]);             \
-            }                             \
+            if(crun > 0)                      \
+            do_blend_run((Ptype *)dstbuf + cofs,          \
+                     (Uint32 *)srcbuf + (cofs - ofs), crun);  \
             srcbuf += run * 4;                    \
             ofs += run;                       \
         }                             \
@@ -712,12 +800,12 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
     switch (df->BytesPerPixel) {
     case 2:
         if (df->Gmask == 0x07e0 || df->Rmask == 0x07e0 || df->Bmask == 0x07e0)
-            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_565);
+            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_RUN_565);
         else
-            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_555);
+            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_RUN_555);
         break;
     case 4:
-        RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_888);
+        RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888);
         break;
     }
 }
@@ -807,10 +895,10 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
 
         /*
          * non-clipped blitter. Ptype is the destination pixel type,
-         * Ctype the translucent count type, and do_blend the
-         * macro to blend one pixel.
+         * Ctype the translucent count type, and do_blend_run the
+         * macro to blend a run of pixels.
          */
-#define RLEALPHABLIT(Ptype, Ctype, do_blend)                 \
+#define RLEALPHABLIT(Ptype, Ctype, do_blend_run)          \
     do {                                 \
         int linecount = srcrect->h;                  \
         do {                             \
@@ -840,14 +928,9 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
             run = ((Uint16 *)srcbuf)[1];             \
             srcbuf += 4;                     \
             if(run) {                        \
-            Ptype *dst = (Ptype *)dstbuf + ofs;      \
-            unsigned i;                  \
-            for(i = 0; i < run; i++) {           \
-                Uint32 src = *(Uint32 *)srcbuf;      \
-                do_blend(src, *dst);             \
-                srcbuf += 4;                 \
-                dst++;                   \
-            }                        \
+            do_blend_run((Ptype *)dstbuf + ofs,      \
+                     (Uint32 *)srcbuf, run);     \
+            srcbuf += run * 4;               \
             ofs += run;                  \
             }                            \
         } while(ofs < w);                    \
@@ -859,12 +942,12 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
         case 2:
             if (df->Gmask == 0x07e0 || df->Rmask == 0x07e0
                 || df->Bmask == 0x07e0)
-                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_565);
+                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_RUN_565);
             else
-                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_555);
+                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_RUN_555);
             break;
         case 4:
-            RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_888);
+            RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888);
             break;
         }
     }
@@ -1536,46 +1619,91 @@ UnRLEAlpha(SDL_Surface * surface)
     return (SDL_TRUE);
 }
 
+/* re-create the original pixels of an encoded surface */
+static SDL_bool
+UnRLEPixels(SDL_Surface * surface)
+{
+    if (surface->map->info.flags & SDL_COPY_RLE_COLORKEY) {
+        SDL_Rect full;
+
+        surface->pixels = SDL_malloc(surface->h * surface->pitch);
+        if (!surface->pixels) {
+            return SDL_FALSE;
+        }
+
+        /* fill it with the background color */
+        SDL_FillRect(surface, NULL, surface->map->info.colorkey);
+
+        /* now render the encoded surface */
+        full.x = full.y = 0;
+        full.w = surface->w;
+        full.h = surface->h;
+        SDL_RLEBlit(surface, &full, surface, &full);
+        return SDL_TRUE;
+    }
+    return UnRLEAlpha(surface);
+}
+
 void
 SDL_UnRLESurface(SDL_Surface * surface, int recode)
 {
     if (surface->flags & SDL_RLEACCEL) {
         surface->flags &= ~SDL_RLEACCEL;
 
-        if (recode && !(surface->flags & SDL_PREALLOC)) {
-            if (surface->map->info.flags & SDL_COPY_RLE_COLORKEY) {
-                SDL_Rect full;
-
-                /* re-create the original surface */
-                surface->pixels = SDL_malloc(surface->h * surface->pitch);
-                if (!surface->pixels) {
-                    /* Oh crap... */
-                    surface->flags |= SDL_RLEACCEL;
-                    return;
-                }
-
-                /* fill it with the background color */
-                SDL_FillRect(surface, NULL, surface->map->info.colorkey);
-
-                /* now render the encoded surface */
-                full.x = full.y = 0;
-                full.w = surface->w;
-                full.h = surface->h;
-                SDL_RLEBlit(surface, &full, surface, &full);
-            } else {
-                if (!UnRLEAlpha(surface)) {
-                    /* Oh crap... */
-                    surface->flags |= SDL_RLEACCEL;
-                    return;
-                }
+        /* the pixels may already have been decoded for reading */
+        if (recode && !(surface->flags & SDL_PREALLOC) &&
+            !(surface->map->info.flags & SDL_COPY_RLE_DECODED)) {
+            if (!UnRLEPixels(surface)) {
+                /* Oh crap... */
+                surface->flags |= SDL_RLEACCEL;
+                return;
             }
         }
         surface->map->info.flags &=
-            ~(SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY);
+            ~(SDL_COPY_RLE_COLORKEY | SDL_COPY_RLE_ALPHAKEY |
+              SDL_COPY_RLE_DECODED);
 
         SDL_free(surface->map->data);
         surface->map->data = NULL;
     }
 }
 
+/*
+ * Make the pixels of an encoded surface available for reading, keeping the
+ * encoding so the surface doesn't have to be encoded again afterwards.
+ */
+int
+SDL_RLEDecodePixels(SDL_Surface * surface)
+{
+    if ((surface->flags & SDL_RLEACCEL) &&
+        !(surface->map->info.flags & SDL_COPY_RLE_DECODED)) {
+        if (!(surface->flags & SDL_PREALLOC)) {
+            SDL_bool decoded;
+
+            /* don't let the blit try to lock the surface */
+            surface->flags &= ~SDL_RLEACCEL;
+            decoded = UnRLEPixels(surface);
+            surface->flags |= SDL_RLEACCEL;
+            if (!decoded) {
+                return SDL_OutOfMemory();
+            }
+        }
+        surface->map->info.flags |= SDL_COPY_RLE_DECODED;
+    }
+    return 0;
+}
+
+/* Release the pixels made by SDL_RLEDecodePixels() */
+void
+SDL_RLEDiscardPixels(SDL_Surface * surface)
+{
+    if (surface->map->info.flags & SDL_COPY_RLE_DECODED) {
+        if (!(surface->flags & SDL_PREALLOC)) {
+            SDL_free(surface->pixels);
+            surface->pixels = NULL;
+        }
+        surface->map->info.flags &= ~SDL_COPY_RLE_DECODED;
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
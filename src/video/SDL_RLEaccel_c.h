@@ -32,6 +32,8 @@ extern int SDLCALL SDL_RLEBlit     (SDL_Surface * src, SDL_Rect * srcrect,
 extern int SDLCALL SDL_RLEAlphaBlit(SDL_Surface * src, SDL_Rect * srcrect,
                                     SDL_Surface * dst, SDL_Rect * dstrect);
 extern void SDL_UnRLESurface(SDL_Surface * surface, int recode);
+extern int SDL_RLEDecodePixels(SDL_Surface * surface);
+extern void SDL_RLEDiscardPixels(SDL_Surface * surface);
 
 #endif /* SDL_RLEaccel_c_h_ */
 
@@ -211,6 +211,71 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
     return NULL;
 }
 
+/* The blit functions chosen so far.  The choice only depends on the pixel
+   formats, the copy flags and whether the mapping is an identity, so it can
+   be shared by every surface instead of searching the tables again. */
+#define SDL_BLIT_CACHE_SIZE 64
+
+typedef struct
+{
+    Uint32 src_format;
+    Uint32 dst_format;
+    int flags;
+    int identity;
+    SDL_BlitFunc func;
+} SDL_BlitCacheEntry;
+
+static SDL_BlitCacheEntry SDL_blit_cache[SDL_BLIT_CACHE_SIZE];
+static SDL_SpinLock SDL_blit_cache_lock;
+
+static SDL_BlitCacheEntry *
+SDL_GetBlitCacheEntry(Uint32 src_format, Uint32 dst_format, int flags,
+                      int identity)
+{
+    Uint32 hash = src_format;
+
+    hash = hash * 31 + dst_format;
+    hash = hash * 31 + (Uint32) flags;
+    hash = hash * 31 + (Uint32) identity;
+    hash ^= hash >> 16;
+    return &SDL_blit_cache[hash & (SDL_BLIT_CACHE_SIZE - 1)];
+}
+
+static SDL_BlitFunc
+SDL_LookupBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
+                   int identity)
+{
+    SDL_BlitCacheEntry *entry;
+    SDL_BlitFunc func = NULL;
+
+    SDL_AtomicLock(&SDL_blit_cache_lock);
+    entry = SDL_GetBlitCacheEntry(src_format, dst_format, flags, identity);
+    if (entry->func &&
+        entry->src_format == src_format && entry->dst_format == dst_format &&
+        entry->flags == flags && entry->identity == identity) {
+        func = entry->func;
+    }
+    SDL_AtomicUnlock(&SDL_blit_cache_lock);
+
+    return func;
+}
+
+static void
+SDL_CacheBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
+                  int identity, SDL_BlitFunc func)
+{
+    SDL_BlitCacheEntry *entry;
+
+    SDL_AtomicLock(&SDL_blit_cache_lock);
+    entry = SDL_GetBlitCacheEntry(src_format, dst_format, flags, identity);
+    entry->src_format = src_format;
+    entry->dst_format = dst_format;
+    entry->flags = flags;
+    entry->identity = identity;
+    entry->func = func;
+    SDL_AtomicUnlock(&SDL_blit_cache_lock);
+}
+
 /* Figure out which of many blit routines to set up on a surface */
 int
 SDL_CalculateBlit(SDL_Surface * surface)
@@ -218,6 +283,10 @@ SDL_CalculateBlit(SDL_Surface * surface)
     SDL_BlitFunc blit = NULL;
     SDL_BlitMap *map = surface->map;
     SDL_Surface *dst = map->dst;
+    Uint32 src_format = surface->format->format;
+    Uint32 dst_format = dst->format->format;
+    int flags;
+    SDL_bool cacheable;
 
     /* We don't currently support blitting to < 8 bpp surfaces */
     if (dst->format->BitsPerPixel < 8) {
@@ -242,6 +311,18 @@ SDL_CalculateBlit(SDL_Surface * surface)
         }
     }
 
+    /* Use the blit function chosen last time, if any */
+    flags = map->info.flags & ~SDL_COPY_RLE_MASK;
+    cacheable = (src_format != SDL_PIXELFORMAT_UNKNOWN &&
+                 dst_format != SDL_PIXELFORMAT_UNKNOWN);
+    if (cacheable) {
+        blit = SDL_LookupBlitFunc(src_format, dst_format, flags, map->identity);
+        if (blit) {
+            map->data = blit;
+            return 0;
+        }
+    }
+
     /* Choose a standard blit function */
     if (map->identity && !(map->info.flags & ~SDL_COPY_RLE_DESIRED)) {
         blit = SDL_BlitCopy;
@@ -261,9 +342,6 @@ SDL_CalculateBlit(SDL_Surface * surface)
         blit = SDL_CalculateBlitN(surface);
     }
     if (blit == NULL) {
-        Uint32 src_format = surface->format->format;
-        Uint32 dst_format = dst->format->format;
-
         blit =
             SDL_ChooseBlitFunc(src_format, dst_format, map->info.flags,
                                SDL_GeneratedBlitFuncTable);
@@ -272,9 +350,6 @@ SDL_CalculateBlit(SDL_Surface * surface)
     if (blit == NULL)
 #endif
     {
-        Uint32 src_format = surface->format->format;
-        Uint32 dst_format = dst->format->format;
-
         if (!SDL_ISPIXELFORMAT_INDEXED(src_format) &&
             !SDL_ISPIXELFORMAT_FOURCC(src_format) &&
             !SDL_ISPIXELFORMAT_INDEXED(dst_format) &&
@@ -290,6 +365,9 @@ SDL_CalculateBlit(SDL_Surface * surface)
         return SDL_SetError("Blit combination not supported");
     }
 
+    if (cacheable) {
+        SDL_CacheBlitFunc(src_format, dst_format, flags, map->identity, blit);
+    }
     return 0;
 }
 
@@ -41,7 +41,8 @@ extern Uint8* SDL_expand_byte[9];
 #define SDL_COPY_RLE_DESIRED        0x00001000
 #define SDL_COPY_RLE_COLORKEY       0x00002000
 #define SDL_COPY_RLE_ALPHAKEY       0x00004000
-#define SDL_COPY_RLE_MASK           (SDL_COPY_RLE_DESIRED|SDL_COPY_RLE_COLORKEY|SDL_COPY_RLE_ALPHAKEY)
+#define SDL_COPY_RLE_DECODED        0x00008000
+#define SDL_COPY_RLE_MASK           (SDL_COPY_RLE_DESIRED|SDL_COPY_RLE_COLORKEY|SDL_COPY_RLE_ALPHAKEY|SDL_COPY_RLE_DECODED)
 
 /* SDL blit CPU flags */
 #define SDL_CPU_ANY                 0x00000000
@@ -25,6 +25,49 @@
 #include "SDL_blit_copy.h"
 
 
+/* Copies bigger than this go around the cache with non-temporal stores,
+   smaller ones are likely to be read again soon and stay cached. */
+#define SDL_BLIT_COPY_STREAM_THRESHOLD  (256 * 1024)
+
+#ifdef __SSE2__
+/* This only needs dst to be 16-byte aligned, src can be anywhere */
+static SDL_INLINE void
+SDL_memcpySSE2(Uint8 * dst, const Uint8 * src, int len)
+{
+    int i;
+    const int head = (int)((16 - ((uintptr_t) dst & 15)) & 15);
+
+    if (head) {
+        if (head >= len) {
+            SDL_memcpy(dst, src, len);
+            return;
+        }
+        SDL_memcpy(dst, src, head);
+        dst += head;
+        src += head;
+        len -= head;
+    }
+
+    for (i = len / 64; i--;) {
+        __m128i values[4];
+        _mm_prefetch((const char *) src + 256, _MM_HINT_NTA);
+        values[0] = _mm_loadu_si128((const __m128i *) (src + 0));
+        values[1] = _mm_loadu_si128((const __m128i *) (src + 16));
+        values[2] = _mm_loadu_si128((const __m128i *) (src + 32));
+        values[3] = _mm_loadu_si128((const __m128i *) (src + 48));
+        _mm_stream_si128((__m128i *) (dst + 0), values[0]);
+        _mm_stream_si128((__m128i *) (dst + 16), values[1]);
+        _mm_stream_si128((__m128i *) (dst + 32), values[2]);
+        _mm_stream_si128((__m128i *) (dst + 48), values[3]);
+        src += 64;
+        dst += 64;
+    }
+
+    if (len & 63)
+        SDL_memcpy(dst, src, len & 63);
+}
+#endif /* __SSE2__ */
+
 #ifdef __SSE__
 /* This assumes 16-byte aligned src and dst */
 static SDL_INLINE void
@@ -127,6 +170,28 @@ SDL_BlitCopy(SDL_BlitInfo * info)
         return;
     }
 
+    if ((size_t) w * h < SDL_BLIT_COPY_STREAM_THRESHOLD) {
+        while (h--) {
+            SDL_memcpy(dst, src, w);
+            src += srcskip;
+            dst += dstskip;
+        }
+        return;
+    }
+
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        while (h--) {
+            SDL_memcpySSE2(dst, src, w);
+            src += srcskip;
+            dst += dstskip;
+        }
+        /* Make the streamed stores visible before anyone reads the pixels */
+        _mm_sfence();
+        return;
+    }
+#endif
+
 #ifdef __SSE__
     if (SDL_HasSSE() &&
         !((uintptr_t) src & 15) && !(srcskip & 15) &&
@@ -136,6 +201,7 @@ SDL_BlitCopy(SDL_BlitInfo * info)
             src += srcskip;
             dst += dstskip;
         }
+        _mm_sfence();
         return;
     }
 #endif
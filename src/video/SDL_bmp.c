@@ -54,33 +54,90 @@
 #define LCS_WINDOWS_COLOR_SPACE    0x57696E20
 #endif
 
+/* Each 4 bit nibble of a 1 bpp image expanded to one byte per pixel */
+static const Uint8 expand1bpp[16][4] = {
+    { 0, 0, 0, 0 }, { 0, 0, 0, 1 }, { 0, 0, 1, 0 }, { 0, 0, 1, 1 },
+    { 0, 1, 0, 0 }, { 0, 1, 0, 1 }, { 0, 1, 1, 0 }, { 0, 1, 1, 1 },
+    { 1, 0, 0, 0 }, { 1, 0, 0, 1 }, { 1, 0, 1, 0 }, { 1, 0, 1, 1 },
+    { 1, 1, 0, 0 }, { 1, 1, 0, 1 }, { 1, 1, 1, 0 }, { 1, 1, 1, 1 }
+};
+
+static void ExpandBMPRow(Uint8 *dst, const Uint8 *src, int width, int bits)
+{
+    int i;
+
+    if (bits == 1) {
+        for (i = 0; i + 8 <= width; i += 8) {
+            const Uint8 pixel = *src++;
+            SDL_memcpy(dst + i, expand1bpp[pixel >> 4], 4);
+            SDL_memcpy(dst + i + 4, expand1bpp[pixel & 0x0F], 4);
+        }
+        if (i < width) {
+            Uint8 pixel = *src;
+            for (; i < width; ++i) {
+                dst[i] = (pixel >> 7);
+                pixel <<= 1;
+            }
+        }
+    } else {
+        for (i = 0; i + 2 <= width; i += 2) {
+            const Uint8 pixel = *src++;
+            dst[i] = (pixel >> 4);
+            dst[i + 1] = (pixel & 0x0F);
+        }
+        if (i < width) {
+            dst[i] = (*src >> 4);
+        }
+    }
+}
+
 static void CorrectAlphaChannel(SDL_Surface *surface)
 {
+    /* The surface is 32 bpp with alpha in the top byte and no row padding */
+    Uint32 *pixels = (Uint32 *)surface->pixels;
+    const int count = (surface->h * surface->pitch) / 4;
+    const Uint32 Amask = 0xFF000000;
+    int i = 0;
+
     /* Check to see if there is any alpha channel data */
-    SDL_bool hasAlpha = SDL_FALSE;
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    int alphaChannelOffset = 0;
-#else
-    int alphaChannelOffset = 3;
+#ifdef __SSE2__
+    {
+        const __m128i mask = _mm_set1_epi32((int)Amask);
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i + 16 <= count; i += 16) {
+            __m128i alpha = _mm_loadu_si128((const __m128i *)&pixels[i]);
+            alpha = _mm_or_si128(alpha, _mm_loadu_si128((const __m128i *)&pixels[i + 4]));
+            alpha = _mm_or_si128(alpha, _mm_loadu_si128((const __m128i *)&pixels[i + 8]));
+            alpha = _mm_or_si128(alpha, _mm_loadu_si128((const __m128i *)&pixels[i + 12]));
+            alpha = _mm_and_si128(alpha, mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) != 0xFFFF) {
+                return;
+            }
+        }
+    }
 #endif
-    Uint8 *alpha = ((Uint8*)surface->pixels) + alphaChannelOffset;
-    Uint8 *end = alpha + surface->h * surface->pitch;
-
-    while (alpha < end) {
-        if (*alpha != 0) {
-            hasAlpha = SDL_TRUE;
-            break;
+    for (; i < count; ++i) {
+        if (pixels[i] & Amask) {
+            return;
         }
-        alpha += 4;
     }
 
-    if (!hasAlpha) {
-        alpha = ((Uint8*)surface->pixels) + alphaChannelOffset;
-        while (alpha < end) {
-            *alpha = SDL_ALPHA_OPAQUE;
-            alpha += 4;
+    /* There isn't, so the image is opaque */
+    i = 0;
+#ifdef __SSE2__
+    {
+        const __m128i mask = _mm_set1_epi32((int)Amask);
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128i pixel = _mm_loadu_si128((const __m128i *)&pixels[i]);
+            _mm_storeu_si128((__m128i *)&pixels[i], _mm_or_si128(pixel, mask));
         }
     }
+#endif
+    for (; i < count; ++i) {
+        pixels[i] |= Amask;
+    }
 }
 
 SDL_Surface *
@@ -103,6 +160,8 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     SDL_bool haveRGBMasks = SDL_FALSE;
     SDL_bool haveAlphaMask = SDL_FALSE;
     SDL_bool correctAlpha = SDL_FALSE;
+    Uint8 *row = NULL;
+    int entrySize;
 
     /* The Win32 BMP file header (14 bytes) */
     char magic[2];
@@ -135,6 +194,15 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         goto done;
     }
 
+    /* The header is read a few bytes at a time */
+    if (!SDL_RWGetPointer(src, NULL)) {
+        SDL_RWops *buffered = SDL_RWFromBuffered(src, 0, freesrc);
+        if (buffered) {
+            src = buffered;
+            freesrc = 1;
+        }
+    }
+
     /* Read in the BMP file header */
     fp_offset = SDL_RWtell(src);
     SDL_ClearError();
@@ -331,25 +399,27 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         } else if ((int) biClrUsed < palette->ncolors) {
             palette->ncolors = biClrUsed;
         }
-        if (biSize == 12) {
-            for (i = 0; i < (int) biClrUsed; ++i) {
-                SDL_RWread(src, &palette->colors[i].b, 1, 1);
-                SDL_RWread(src, &palette->colors[i].g, 1, 1);
-                SDL_RWread(src, &palette->colors[i].r, 1, 1);
-                palette->colors[i].a = SDL_ALPHA_OPAQUE;
+        /* Read the entries in blocks and unpack them from BGR(X) order.
+           According to Microsoft documentation, the fourth element of
+           each entry is reserved and must be zero, so we shouldn't treat
+           it as alpha.
+        */
+        entrySize = (biSize == 12) ? 3 : 4;
+        for (i = 0; i < (int) biClrUsed; ) {
+            Uint8 entries[256 * 4];
+            const Uint8 *entry = entries;
+            int count = SDL_min((int) biClrUsed - i, 256);
+
+            count = (int) SDL_RWread(src, entries, entrySize, count);
+            if (count == 0) {
+                break;
             }
-        } else {
-            for (i = 0; i < (int) biClrUsed; ++i) {
-                SDL_RWread(src, &palette->colors[i].b, 1, 1);
-                SDL_RWread(src, &palette->colors[i].g, 1, 1);
-                SDL_RWread(src, &palette->colors[i].r, 1, 1);
-                SDL_RWread(src, &palette->colors[i].a, 1, 1);
-
-                /* According to Microsoft documentation, the fourth element
-                   is reserved and must be zero, so we shouldn't treat it as
-                   alpha.
-                */
+            for (; count--; ++i) {
+                palette->colors[i].b = entry[0];
+                palette->colors[i].g = entry[1];
+                palette->colors[i].r = entry[2];
                 palette->colors[i].a = SDL_ALPHA_OPAQUE;
+                entry += entrySize;
             }
         }
     }
@@ -372,69 +442,47 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         pad = (((bmpPitch) % 4) ? (4 - ((bmpPitch) % 4)) : 0);
         break;
     default:
-        pad = ((surface->pitch % 4) ? (4 - (surface->pitch % 4)) : 0);
+        /* BMP rows are padded to 4 bytes, just like surface rows */
+        bmpPitch = surface->pitch;
+        pad = 0;
         break;
     }
+    if (ExpandBMP) {
+        /* Read each packed row with its padding, then expand it */
+        row = (Uint8 *) SDL_malloc(bmpPitch + pad);
+        if (!row) {
+            SDL_OutOfMemory();
+            was_error = SDL_TRUE;
+            goto done;
+        }
+    }
     if (topDown) {
         bits = top;
     } else {
         bits = end - surface->pitch;
     }
+    if (topDown && !row) {
+        /* The rows are already in order, read them all at once */
+        if (SDL_RWread(src, top, 1, end - top) != (size_t) (end - top)) {
+            SDL_Error(SDL_EFREAD);
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        bits = end;
+    }
     while (bits >= top && bits < end) {
-        switch (ExpandBMP) {
-        case 1:
-        case 4:{
-                Uint8 pixel = 0;
-                int shift = (8 - ExpandBMP);
-                for (i = 0; i < surface->w; ++i) {
-                    if (i % (8 / ExpandBMP) == 0) {
-                        if (!SDL_RWread(src, &pixel, 1, 1)) {
-                            SDL_SetError("Error reading from BMP");
-                            was_error = SDL_TRUE;
-                            goto done;
-                        }
-                    }
-                    *(bits + i) = (pixel >> shift);
-                    pixel <<= ExpandBMP;
-                }
-            }
-            break;
-
-        default:
-            if (SDL_RWread(src, bits, 1, surface->pitch)
-                != surface->pitch) {
-                SDL_Error(SDL_EFREAD);
+        if (row) {
+            /* The padding of the last row may be missing, that's fine */
+            if (SDL_RWread(src, row, 1, bmpPitch + pad) < (size_t) bmpPitch) {
+                SDL_SetError("Error reading from BMP");
                 was_error = SDL_TRUE;
                 goto done;
             }
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-            /* Byte-swap the pixels if needed. Note that the 24bpp
-               case has already been taken care of above. */
-            switch (biBitCount) {
-            case 15:
-            case 16:{
-                    Uint16 *pix = (Uint16 *) bits;
-                    for (i = 0; i < surface->w; i++)
-                        pix[i] = SDL_Swap16(pix[i]);
-                    break;
-                }
-
-            case 32:{
-                    Uint32 *pix = (Uint32 *) bits;
-                    for (i = 0; i < surface->w; i++)
-                        pix[i] = SDL_Swap32(pix[i]);
-                    break;
-                }
-            }
-#endif
-            break;
-        }
-        /* Skip padding bytes, ugh */
-        if (pad) {
-            Uint8 padbyte;
-            for (i = 0; i < pad; ++i) {
-                SDL_RWread(src, &padbyte, 1, 1);
-            }
+            ExpandBMPRow(bits, row, surface->w, ExpandBMP);
+        } else if (SDL_RWread(src, bits, 1, surface->pitch) != (size_t) surface->pitch) {
+            SDL_Error(SDL_EFREAD);
+            was_error = SDL_TRUE;
+            goto done;
         }
         if (topDown) {
             bits += surface->pitch;
@@ -442,10 +490,33 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
             bits -= surface->pitch;
         }
     }
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    /* Byte-swap the pixels if needed. Note that the 24bpp
+       case has already been taken care of above. */
+    switch (biBitCount) {
+    case 15:
+    case 16:{
+            Uint16 *pix = (Uint16 *) surface->pixels;
+            const int count = (surface->h * surface->pitch) / 2;
+            for (i = 0; i < count; i++)
+                pix[i] = SDL_Swap16(pix[i]);
+            break;
+        }
+
+    case 32:{
+            Uint32 *pix = (Uint32 *) surface->pixels;
+            const int count = (surface->h * surface->pitch) / 4;
+            for (i = 0; i < count; i++)
+                pix[i] = SDL_Swap32(pix[i]);
+            break;
+        }
+    }
+#endif
     if (correctAlpha) {
         CorrectAlphaChannel(surface);
     }
   done:
+    SDL_free(row);
     if (was_error) {
         if (src) {
             SDL_RWseek(src, fp_offset, RW_SEEK_SET);
@@ -468,6 +539,9 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
     Uint8 *bits;
     SDL_bool save32bit = SDL_FALSE;
     SDL_bool saveLegacyBMP = SDL_FALSE;
+    Uint32 convert_format = SDL_PIXELFORMAT_UNKNOWN;
+    int bpp = 0;
+    int bw;
 
     /* The Win32 BMP file header (14 bytes) */
     char magic[2] = { 'B', 'M' };
@@ -540,10 +614,21 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
             } else {
                 SDL_InitFormat(&format, SDL_PIXELFORMAT_BGR24);
             }
-            surface = SDL_ConvertSurface(saveme, &format, 0);
-            if (!surface) {
-                SDL_SetError("Couldn't convert image to %d bpp",
-                             format.BitsPerPixel);
+            if (!saveme->format->palette &&
+                saveme->format->format != SDL_PIXELFORMAT_UNKNOWN &&
+                !(saveme->map->info.flags & SDL_COPY_COLORKEY)) {
+                /* Convert the rows as they're written, no copy needed */
+                surface = saveme;
+                if (saveme->format->format != format.format) {
+                    convert_format = format.format;
+                }
+                bpp = format.BitsPerPixel;
+            } else {
+                surface = SDL_ConvertSurface(saveme, &format, 0);
+                if (!surface) {
+                    SDL_SetError("Couldn't convert image to %d bpp",
+                                 format.BitsPerPixel);
+                }
             }
         }
     } else {
@@ -557,7 +642,11 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
     }
 
     if (surface && (SDL_LockSurface(surface) == 0)) {
-        const int bw = surface->w * surface->format->BytesPerPixel;
+        if (!bpp) {
+            bpp = surface->format->BitsPerPixel;
+        }
+        bw = surface->w * (bpp / 8);
+        pad = ((bw % 4) ? (4 - (bw % 4)) : 0);
 
         /* Set the BMP file header values */
         bfSize = 0;             /* We'll write this when we're done */
@@ -565,6 +654,15 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
         bfReserved2 = 0;
         bfOffBits = 0;          /* We'll write this when we're done */
 
+        /* The headers are written a few bytes at a time */
+        if (!SDL_RWGetPointer(dst, NULL)) {
+            SDL_RWops *buffered = SDL_RWFromBuffered(dst, 0, freedst);
+            if (buffered) {
+                dst = buffered;
+                freedst = 1;
+            }
+        }
+
         /* Write the BMP file header values */
         fp_offset = SDL_RWtell(dst);
         SDL_ClearError();
@@ -579,9 +677,9 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
         biWidth = surface->w;
         biHeight = surface->h;
         biPlanes = 1;
-        biBitCount = surface->format->BitsPerPixel;
+        biBitCount = bpp;
         biCompression = BI_RGB;
-        biSizeImage = surface->h * surface->pitch;
+        biSizeImage = surface->h * (bw + pad);
         biXPelsPerMeter = 0;
         biYPelsPerMeter = 0;
         if (surface->format->palette) {
@@ -636,16 +734,26 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
 
         /* Write the palette (in BGR color order) */
         if (surface->format->palette) {
-            SDL_Color *colors;
-            int ncolors;
-
-            colors = surface->format->palette->colors;
-            ncolors = surface->format->palette->ncolors;
-            for (i = 0; i < ncolors; ++i) {
-                SDL_RWwrite(dst, &colors[i].b, 1, 1);
-                SDL_RWwrite(dst, &colors[i].g, 1, 1);
-                SDL_RWwrite(dst, &colors[i].r, 1, 1);
-                SDL_RWwrite(dst, &colors[i].a, 1, 1);
+            const SDL_Color *colors = surface->format->palette->colors;
+            const int ncolors = surface->format->palette->ncolors;
+
+            for (i = 0; i < ncolors; ) {
+                Uint8 entries[256 * 4];
+                Uint8 *entry = entries;
+                const int count = SDL_min(ncolors - i, 256);
+                int j;
+
+                for (j = 0; j < count; ++j, ++i) {
+                    entry[0] = colors[i].b;
+                    entry[1] = colors[i].g;
+                    entry[2] = colors[i].r;
+                    entry[3] = colors[i].a;
+                    entry += 4;
+                }
+                if (SDL_RWwrite(dst, entries, 4, count) != (size_t) count) {
+                    SDL_Error(SDL_EFWRITE);
+                    break;
+                }
             }
         }
 
@@ -660,18 +768,50 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
         }
 
         /* Write the bitmap image upside down */
-        bits = (Uint8 *) surface->pixels + (surface->h * surface->pitch);
-        pad = ((bw % 4) ? (4 - (bw % 4)) : 0);
-        while (bits > (Uint8 *) surface->pixels) {
-            bits -= surface->pitch;
-            if (SDL_RWwrite(dst, bits, 1, bw) != bw) {
-                SDL_Error(SDL_EFWRITE);
-                break;
+        if (convert_format) {
+            /* Convert a block of rows at a time into a buffer that already
+               has the row padding, and write those rows from the bottom up */
+            const int rowsize = bw + pad;
+            int rows = SDL_max(1, (64 * 1024) / rowsize);
+            int y = surface->h;
+            Uint8 *buffer;
+
+            rows = SDL_min(rows, surface->h);
+            buffer = (Uint8 *) SDL_calloc(rows, rowsize);
+            if (!buffer) {
+                SDL_OutOfMemory();
+                y = 0;
+            }
+            while (y > 0) {
+                const int count = SDL_min(rows, y);
+
+                y -= count;
+                bits = (Uint8 *) surface->pixels + y * surface->pitch;
+                if (SDL_ConvertPixels(surface->w, count,
+                                      surface->format->format, bits,
+                                      surface->pitch, convert_format,
+                                      buffer, rowsize) < 0) {
+                    break;
+                }
+                for (i = count; i--; ) {
+                    if (SDL_RWwrite(dst, buffer + i * rowsize, 1, rowsize) != (size_t) rowsize) {
+                        SDL_Error(SDL_EFWRITE);
+                        y = 0;
+                        break;
+                    }
+                }
             }
-            if (pad) {
-                const Uint8 padbyte = 0;
-                for (i = 0; i < pad; ++i) {
-                    SDL_RWwrite(dst, &padbyte, 1, 1);
+            SDL_free(buffer);
+        } else {
+            static const Uint8 padding[3] = { 0, 0, 0 };
+
+            bits = (Uint8 *) surface->pixels + (surface->h * surface->pitch);
+            while (bits > (Uint8 *) surface->pixels) {
+                bits -= surface->pitch;
+                if (SDL_RWwrite(dst, bits, 1, bw) != (size_t) bw ||
+                    (pad && SDL_RWwrite(dst, padding, 1, pad) != (size_t) pad)) {
+                    SDL_Error(SDL_EFWRITE);
+                    break;
                 }
             }
         }
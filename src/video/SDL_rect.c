@@ -528,4 +528,80 @@ SDL_GetSpanEnclosingRect(int width, int height,
     return SDL_FALSE;
 }
 
+/* The cost of updating a rect is its area plus this many pixels, which
+   stands for the fixed overhead of each separate copy or upload. */
+#define SDL_RECT_UPDATE_OVERHEAD    4096
+
+/* Rects are merged pairwise up to this many, past that it's all or nothing */
+#define SDL_MAX_COALESCED_RECTS     128
+
+static Sint64
+SDL_RectUpdateCost(const SDL_Rect * rect)
+{
+    return (Sint64) rect->w * rect->h + SDL_RECT_UPDATE_OVERHEAD;
+}
+
+int
+SDL_CoalesceRects(int width, int height,
+                  int numrects, const SDL_Rect * rects, SDL_Rect *result)
+{
+    SDL_Rect bounds, merged;
+    SDL_bool merging;
+    Sint64 cost;
+    int count;
+    int i, j;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = width;
+    bounds.h = height;
+
+    /* Clip the rects to the window, dropping any that end up empty */
+    count = 0;
+    for (i = 0; i < numrects; ++i) {
+        if (SDL_IntersectRect(&rects[i], &bounds, &result[count])) {
+            ++count;
+        }
+    }
+    if (count <= 1) {
+        return count;
+    }
+
+    /* Merge overlapping, adjacent and nearby rects, whenever updating
+       their union costs no more than updating them separately */
+    if (count <= SDL_MAX_COALESCED_RECTS) {
+        do {
+            merging = SDL_FALSE;
+            for (i = 0; i < count; ++i) {
+                for (j = i + 1; j < count; ) {
+                    SDL_UnionRect(&result[i], &result[j], &merged);
+                    if (SDL_RectUpdateCost(&merged) <=
+                        SDL_RectUpdateCost(&result[i]) + SDL_RectUpdateCost(&result[j])) {
+                        result[i] = merged;
+                        result[j] = result[--count];
+                        merging = SDL_TRUE;
+                    } else {
+                        ++j;
+                    }
+                }
+            }
+        } while (merging && count > 1);
+    }
+
+    /* If what's left costs as much as the enclosing rect, use that */
+    if (count > 1) {
+        cost = 0;
+        merged = result[0];
+        for (i = 0; i < count; ++i) {
+            cost += SDL_RectUpdateCost(&result[i]);
+            SDL_UnionRect(&merged, &result[i], &merged);
+        }
+        if (cost >= SDL_RectUpdateCost(&merged)) {
+            result[0] = merged;
+            count = 1;
+        }
+    }
+    return count;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -25,6 +25,9 @@
 #include "../SDL_internal.h"
 
 extern SDL_bool SDL_GetSpanEnclosingRect(int width, int height, int numrects, const SDL_Rect * rects, SDL_Rect *span);
+/* Clips rects to a width x height area and merges them where fewer, larger
+   updates are cheaper.  result needs room for numrects rects. */
+extern int SDL_CoalesceRects(int width, int height, int numrects, const SDL_Rect * rects, SDL_Rect *result);
 
 #endif /* SDL_rect_c_h_ */
 
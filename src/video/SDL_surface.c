@@ -890,9 +890,10 @@ SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
 int
 SDL_LockSurface(SDL_Surface * surface)
 {
-    if (!surface->locked) {
-        /* Perform the lock */
-        if (surface->flags & SDL_RLEACCEL) {
+    /* Perform the lock, unless the surface is already locked for writing */
+    if (surface->flags & SDL_RLEACCEL) {
+        if (!surface->locked ||
+            (surface->map->info.flags & SDL_COPY_RLE_DECODED)) {
             SDL_UnRLESurface(surface, 1);
             surface->flags |= SDL_RLEACCEL;     /* save accel'd state */
         }
@@ -905,6 +906,28 @@ SDL_LockSurface(SDL_Surface * surface)
     return (0);
 }
 
+/*
+ * Lock a surface to directly read its pixels
+ */
+int
+SDL_LockSurfaceReadOnly(SDL_Surface * surface)
+{
+    if (!surface->locked) {
+        /* Decode the pixels, keeping the RLE encoding */
+        if (surface->flags & SDL_RLEACCEL) {
+            if (SDL_RLEDecodePixels(surface) < 0) {
+                return (-1);
+            }
+        }
+    }
+
+    /* Increment the surface lock count, for recursive locks */
+    ++surface->locked;
+
+    /* Ready to go.. */
+    return (0);
+}
+
 /*
  * Unlock a previously locked surface
  */
@@ -918,8 +941,13 @@ SDL_UnlockSurface(SDL_Surface * surface)
 
     /* Update RLE encoded surface with new data */
     if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
-        surface->flags &= ~SDL_RLEACCEL;        /* stop lying */
-        SDL_RLESurface(surface);
+        if (surface->map->info.flags & SDL_COPY_RLE_DECODED) {
+            /* Only locked for reading, the encoding is still good */
+            SDL_RLEDiscardPixels(surface);
+        } else {
+            surface->flags &= ~SDL_RLEACCEL;        /* stop lying */
+            SDL_RLESurface(surface);
+        }
     }
 }
 
@@ -1014,7 +1042,7 @@ SDL_ConvertSurface(SDL_Surface * surface, const SDL_PixelFormat * format,
         (copy_flags &
          ~(SDL_COPY_COLORKEY | SDL_COPY_BLEND
            | SDL_COPY_RLE_DESIRED | SDL_COPY_RLE_COLORKEY |
-           SDL_COPY_RLE_ALPHAKEY));
+           SDL_COPY_RLE_ALPHAKEY | SDL_COPY_RLE_DECODED));
     surface->map->info.r = copy_color.r;
     surface->map->info.g = copy_color.g;
     surface->map->info.b = copy_color.b;
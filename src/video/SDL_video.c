@@ -115,6 +115,9 @@ static VideoBootStrap *bootstrap[] = {
 #if SDL_VIDEO_DRIVER_WIIU
     &WIIU_bootstrap,
 #endif
+#if SDL_VIDEO_DRIVER_SHM
+    &SHM_bootstrap,
+#endif
 #if SDL_VIDEO_DRIVER_DUMMY
     &DUMMY_bootstrap,
 #endif
@@ -372,21 +375,24 @@ static int
 SDL_UpdateWindowTexture(SDL_VideoDevice *unused, SDL_Window * window, const SDL_Rect * rects, int numrects)
 {
     SDL_WindowTextureData *data;
-    SDL_Rect rect;
     void *src;
+    int i;
 
     data = SDL_GetWindowData(window, SDL_WINDOWTEXTUREDATA);
     if (!data || !data->texture) {
         return SDL_SetError("No window texture data");
     }
 
-    /* Update a single rect that contains subrects for best DMA performance */
-    if (SDL_GetSpanEnclosingRect(window->w, window->h, numrects, rects, &rect)) {
-        src = (void *)((Uint8 *)data->pixels +
-                        rect.y * data->pitch +
-                        rect.x * data->bytes_per_pixel);
-        if (SDL_UpdateTexture(data->texture, &rect, src, data->pitch) < 0) {
-            return -1;
+    /* The rects have already been merged wherever a single larger upload
+       is cheaper, so upload them as they are */
+    if (numrects > 0) {
+        for (i = 0; i < numrects; ++i) {
+            src = (void *)((Uint8 *)data->pixels +
+                            rects[i].y * data->pitch +
+                            rects[i].x * data->bytes_per_pixel);
+            if (SDL_UpdateTexture(data->texture, &rects[i], src, data->pitch) < 0) {
+                return -1;
+            }
         }
 
         if (SDL_RenderCopy(data->renderer, data->texture, NULL, NULL) < 0) {
@@ -2329,13 +2335,34 @@ int
 SDL_UpdateWindowSurfaceRects(SDL_Window * window, const SDL_Rect * rects,
                              int numrects)
 {
+    SDL_Rect stack_rects[16];
+    SDL_Rect *merged = stack_rects;
+    int retval;
+
     CHECK_WINDOW_MAGIC(window, -1);
 
     if (!window->surface_valid) {
         return SDL_SetError("Window surface is invalid, please call SDL_GetWindowSurface() to get a new surface");
     }
 
-    return _this->UpdateWindowFramebuffer(_this, window, rects, numrects);
+    /* Clip and merge the rects so no pixel is sent more than it needs to be */
+    if (!rects) {
+        numrects = 0;
+    }
+    if (numrects > (int) SDL_arraysize(stack_rects)) {
+        merged = (SDL_Rect *) SDL_malloc(numrects * sizeof(*merged));
+        if (!merged) {
+            return SDL_OutOfMemory();
+        }
+    }
+    numrects = SDL_CoalesceRects(window->w, window->h, numrects, rects, merged);
+
+    retval = _this->UpdateWindowFramebuffer(_this, window, merged, numrects);
+
+    if (merged != stack_rects) {
+        SDL_free(merged);
+    }
+    return retval;
 }
 
 int
@@ -24,6 +24,7 @@
 #include "SDL_video.h"
 #include "SDL_pixels_c.h"
 #include "SDL_yuv_c.h"
+#include "../SDL_framearena.h"
 
 #include "yuv2rgb/yuv_rgb.h"
 
@@ -425,7 +426,7 @@ SDL_ConvertPixels_YUV_to_RGB(int width, int height,
         void *tmp;
         int tmp_pitch = (width * sizeof(Uint32));
 
-        tmp = SDL_malloc(tmp_pitch * height);
+        tmp = SDL_AllocFrameMemory(tmp_pitch * height);
         if (tmp == NULL) {
             return SDL_OutOfMemory();
         }
@@ -433,13 +434,13 @@ SDL_ConvertPixels_YUV_to_RGB(int width, int height,
         /* convert src/src_format to tmp/ARGB8888 */
         ret = SDL_ConvertPixels_YUV_to_RGB(width, height, src_format, src, src_pitch, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch);
         if (ret < 0) {
-            SDL_free(tmp);
+            SDL_FreeFrameMemory(tmp);
             return ret;
         }
 
         /* convert tmp/ARGB8888 to dst/RGB */
         ret = SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch, dst_format, dst, dst_pitch);
-        SDL_free(tmp);
+        SDL_FreeFrameMemory(tmp);
         return ret;
     }
 
@@ -819,7 +820,7 @@ SDL_ConvertPixels_RGB_to_YUV(int width, int height,
         void *tmp;
         int tmp_pitch = (width * sizeof(Uint32));
 
-        tmp = SDL_malloc(tmp_pitch * height);
+        tmp = SDL_AllocFrameMemory(tmp_pitch * height);
         if (tmp == NULL) {
             return SDL_OutOfMemory();
         }
@@ -827,13 +828,13 @@ SDL_ConvertPixels_RGB_to_YUV(int width, int height,
         /* convert src/src_format to tmp/ARGB8888 */
         ret = SDL_ConvertPixels(width, height, src_format, src, src_pitch, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch);
         if (ret == -1) {
-            SDL_free(tmp);
+            SDL_FreeFrameMemory(tmp);
             return ret;
         }
 
         /* convert tmp/ARGB8888 to dst/FOURCC */
         ret = SDL_ConvertPixels_ARGB8888_to_YUV(width, height, tmp, tmp_pitch, dst_format, dst, dst_pitch);
-        SDL_free(tmp);
+        SDL_FreeFrameMemory(tmp);
         return ret;
     }
 }
@@ -910,7 +911,7 @@ SDL_ConvertPixels_SwapUVPlanes(int width, int height, const void *src, int src_p
         Uint8 *row2 = (Uint8 *)dst + UVheight * UVpitch;
 
         /* Allocate a temporary row for the swap */
-        tmp = (Uint8 *)SDL_malloc(UVwidth);
+        tmp = (Uint8 *)SDL_AllocFrameMemory(UVwidth);
         if (!tmp) {
             return SDL_OutOfMemory();
         }
@@ -921,7 +922,7 @@ SDL_ConvertPixels_SwapUVPlanes(int width, int height, const void *src, int src_p
             row1 += UVpitch;
             row2 += UVpitch;
         }
-        SDL_free(tmp);
+        SDL_FreeFrameMemory(tmp);
     } else {
         const Uint8 *srcUV;
         Uint8 *dstUV;
@@ -971,7 +972,7 @@ SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const void *src, int
 
     if (src == dst) {
         /* Need to make a copy of the buffer so we don't clobber it while converting */
-        tmp = (Uint8 *)SDL_malloc(2*UVheight*srcUVPitch);
+        tmp = (Uint8 *)SDL_AllocFrameMemory(2*UVheight*srcUVPitch);
         if (!tmp) {
             return SDL_OutOfMemory();
         }
@@ -1017,7 +1018,7 @@ SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const void *src, int
     }
 
     if (tmp) {
-        SDL_free(tmp);
+        SDL_FreeFrameMemory(tmp);
     }
     return 0;
 }
@@ -1045,7 +1046,7 @@ SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const void *src, in
 
     if (src == dst) {
         /* Need to make a copy of the buffer so we don't clobber it while converting */
-        tmp = (Uint8 *)SDL_malloc(UVheight*srcUVPitch);
+        tmp = (Uint8 *)SDL_AllocFrameMemory(UVheight*srcUVPitch);
         if (!tmp) {
             return SDL_OutOfMemory();
         }
@@ -1096,7 +1097,7 @@ SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const void *src, in
     }
 
     if (tmp) {
-        SDL_free(tmp);
+        SDL_FreeFrameMemory(tmp);
     }
     return 0;
 }
@@ -22,11 +22,348 @@
 
 #if SDL_VIDEO_DRIVER_DUMMY
 
+#include "SDL_log.h"
+#include "SDL_thread.h"
 #include "../SDL_sysvideo.h"
+#include "../../thread/SDL_systhread.h"
 #include "SDL_nullframebuffer_c.h"
 
 
 #define DUMMY_SURFACE   "_SDL_DummySurface"
+#define DUMMY_CAPTURE   "_SDL_DummyCapture"
+
+/* Frame capture, enabled with the SDL_VIDEO_DUMMY_SAVE_FRAMES environment
+   variable.
+
+   Presented frames are copied into a ring of buffers and written out by a
+   background thread, so slow storage doesn't stall rendering.  If the
+   writer falls behind and the ring is full, frames are dropped, which is
+   logged and shows up as gaps in the frame numbers.
+
+   SDL_VIDEO_DUMMY_SAVE_FORMAT picks what is written:
+     "bmp"    - SDL_window<id>-<frame>.bmp for each frame (the default)
+     "raw"    - SDL_window<id>-<frame>.raw for each frame
+     "stream" - every frame appended to SDL_window<id>-<w>x<h>.raw
+   Raw frames are tightly packed SDL_PIXELFORMAT_RGB888 pixels, top to bottom.
+
+   SDL_VIDEO_DUMMY_SAVE_BUFFERS sets the number of buffers in the ring.
+*/
+#define DUMMY_CAPTURE_BUFFERS   4
+
+typedef enum
+{
+    DUMMY_CAPTURE_BMP,
+    DUMMY_CAPTURE_RAW,
+    DUMMY_CAPTURE_STREAM
+} SDL_DummyCaptureFormat;
+
+typedef struct
+{
+    Uint8 *pixels;
+    int frame_number;
+    SDL_Rect stale;     /* The area that changed since this buffer was filled */
+} SDL_DummyFrame;
+
+typedef struct
+{
+    SDL_DummyCaptureFormat format;
+    Uint32 windowID;
+    int w, h, pitch;
+    SDL_RWops *stream;
+
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    SDL_bool quit;
+
+    /* Frames are filled at head and written from tail */
+    SDL_DummyFrame *frames;
+    int nframes;
+    int head;
+    int tail;
+    int count;
+
+    int captured;
+    int dropped;
+    SDL_bool dropping;
+} SDL_DummyCapture;
+
+static int frame_number;
+
+static void
+SDL_DUMMY_WriteFrame(SDL_DummyCapture *capture, SDL_DummyFrame *frame)
+{
+    const size_t size = (size_t) capture->h * capture->pitch;
+    char file[128];
+
+    switch (capture->format) {
+    case DUMMY_CAPTURE_BMP: {
+        SDL_Surface *surface;
+
+        surface = SDL_CreateRGBSurfaceWithFormatFrom(frame->pixels,
+                                                     capture->w, capture->h,
+                                                     32, capture->pitch,
+                                                     SDL_PIXELFORMAT_RGB888);
+        if (surface) {
+            SDL_snprintf(file, sizeof(file), "SDL_window%d-%8.8d.bmp",
+                         capture->windowID, frame->frame_number);
+            SDL_SaveBMP(surface, file);
+            SDL_FreeSurface(surface);
+        }
+        break;
+    }
+    case DUMMY_CAPTURE_RAW: {
+        SDL_RWops *rw;
+
+        SDL_snprintf(file, sizeof(file), "SDL_window%d-%8.8d.raw",
+                     capture->windowID, frame->frame_number);
+        rw = SDL_RWFromFile(file, "wb");
+        if (rw) {
+            SDL_RWwrite(rw, frame->pixels, 1, size);
+            SDL_RWclose(rw);
+        }
+        break;
+    }
+    case DUMMY_CAPTURE_STREAM:
+        if (!capture->stream) {
+            SDL_snprintf(file, sizeof(file), "SDL_window%d-%dx%d.raw",
+                         capture->windowID, capture->w, capture->h);
+            capture->stream = SDL_RWFromFile(file, "ab");
+        }
+        if (capture->stream) {
+            SDL_RWwrite(capture->stream, frame->pixels, 1, size);
+        }
+        break;
+    }
+}
+
+static int SDLCALL
+SDL_DUMMY_CaptureThread(void *data)
+{
+    SDL_DummyCapture *capture = (SDL_DummyCapture *) data;
+    SDL_DummyFrame *frame;
+
+    SDL_LockMutex(capture->lock);
+    for ( ; ; ) {
+        while (!capture->count && !capture->quit) {
+            SDL_CondWait(capture->cond, capture->lock);
+        }
+        if (!capture->count) {
+            break;
+        }
+        frame = &capture->frames[capture->tail];
+        SDL_UnlockMutex(capture->lock);
+
+        SDL_DUMMY_WriteFrame(capture, frame);
+
+        SDL_LockMutex(capture->lock);
+        capture->tail = (capture->tail + 1) % capture->nframes;
+        --capture->count;
+    }
+    SDL_UnlockMutex(capture->lock);
+    return 0;
+}
+
+static void
+SDL_DUMMY_DestroyCapture(SDL_DummyCapture *capture)
+{
+    int i;
+
+    if (!capture) {
+        return;
+    }
+
+    /* Let the writer finish the frames it has and wait for it */
+    if (capture->thread) {
+        SDL_LockMutex(capture->lock);
+        capture->quit = SDL_TRUE;
+        SDL_CondSignal(capture->cond);
+        SDL_UnlockMutex(capture->lock);
+        SDL_WaitThread(capture->thread, NULL);
+    }
+    if (capture->dropped) {
+        SDL_Log("Dummy video: window %d dropped %d of %d frames",
+                capture->windowID, capture->dropped,
+                capture->captured + capture->dropped);
+    }
+
+    if (capture->stream) {
+        SDL_RWclose(capture->stream);
+    }
+    if (capture->frames) {
+        for (i = 0; i < capture->nframes; ++i) {
+            SDL_free(capture->frames[i].pixels);
+        }
+        SDL_free(capture->frames);
+    }
+    if (capture->cond) {
+        SDL_DestroyCond(capture->cond);
+    }
+    if (capture->lock) {
+        SDL_DestroyMutex(capture->lock);
+    }
+    SDL_free(capture);
+}
+
+static SDL_DummyCapture *
+SDL_DUMMY_CreateCapture(SDL_Window * window, SDL_Surface * surface)
+{
+    SDL_DummyCapture *capture;
+    const char *hint;
+    int i;
+
+    capture = (SDL_DummyCapture *) SDL_calloc(1, sizeof(*capture));
+    if (!capture) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    hint = SDL_getenv("SDL_VIDEO_DUMMY_SAVE_FORMAT");
+    if (hint && SDL_strcasecmp(hint, "raw") == 0) {
+        capture->format = DUMMY_CAPTURE_RAW;
+    } else if (hint && SDL_strcasecmp(hint, "stream") == 0) {
+        capture->format = DUMMY_CAPTURE_STREAM;
+    } else {
+        capture->format = DUMMY_CAPTURE_BMP;
+    }
+    hint = SDL_getenv("SDL_VIDEO_DUMMY_SAVE_BUFFERS");
+    capture->nframes = hint ? SDL_atoi(hint) : 0;
+    if (capture->nframes <= 0) {
+        capture->nframes = DUMMY_CAPTURE_BUFFERS;
+    }
+
+    capture->windowID = SDL_GetWindowID(window);
+    capture->w = surface->w;
+    capture->h = surface->h;
+    capture->pitch = surface->pitch;
+
+    capture->frames = (SDL_DummyFrame *) SDL_calloc(capture->nframes, sizeof(*capture->frames));
+    if (!capture->frames) {
+        SDL_DUMMY_DestroyCapture(capture);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    for (i = 0; i < capture->nframes; ++i) {
+        SDL_DummyFrame *frame = &capture->frames[i];
+
+        frame->pixels = (Uint8 *) SDL_malloc((size_t) capture->h * capture->pitch);
+        if (!frame->pixels && capture->h) {
+            SDL_DUMMY_DestroyCapture(capture);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        frame->stale.w = capture->w;
+        frame->stale.h = capture->h;
+    }
+
+    capture->lock = SDL_CreateMutex();
+    capture->cond = SDL_CreateCond();
+    if (!capture->lock || !capture->cond) {
+        SDL_DUMMY_DestroyCapture(capture);
+        return NULL;
+    }
+
+    /* Without a thread the frames are written as they're presented */
+    capture->thread = SDL_CreateThreadInternal(SDL_DUMMY_CaptureThread, "SDLDummyCapture", 0, capture);
+
+    return capture;
+}
+
+static void
+SDL_DUMMY_CopyRect(SDL_DummyCapture *capture, SDL_Surface * surface,
+                   SDL_DummyFrame *frame, const SDL_Rect * rect)
+{
+    SDL_Rect bounds, area;
+    const Uint8 *src;
+    Uint8 *dst;
+    int length;
+    int y;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = capture->w;
+    bounds.h = capture->h;
+    if (!SDL_IntersectRect(rect, &bounds, &area)) {
+        return;
+    }
+    src = (const Uint8 *) surface->pixels + area.y * surface->pitch + area.x * 4;
+    dst = frame->pixels + area.y * capture->pitch + area.x * 4;
+    length = area.w * 4;
+    if (area.x == 0 && area.w == capture->w) {
+        SDL_memcpy(dst, src, (size_t) area.h * capture->pitch);
+        return;
+    }
+    for (y = area.h; y--; ) {
+        SDL_memcpy(dst, src, length);
+        src += surface->pitch;
+        dst += capture->pitch;
+    }
+}
+
+static void
+SDL_DUMMY_CaptureFrame(SDL_DummyCapture *capture, SDL_Surface * surface,
+                       const SDL_Rect * rects, int numrects)
+{
+    SDL_DummyFrame *frame = NULL;
+    SDL_Rect dirty;
+    int i;
+
+    /* Work out the area that changed in this frame */
+    SDL_zero(dirty);
+    for (i = 0; i < numrects; ++i) {
+        SDL_UnionRect(&dirty, &rects[i], &dirty);
+    }
+
+    ++frame_number;
+
+    SDL_LockMutex(capture->lock);
+    if (capture->count < capture->nframes) {
+        frame = &capture->frames[capture->head];
+    }
+    SDL_UnlockMutex(capture->lock);
+
+    if (frame) {
+        /* Bring the buffer up to date, it's not touched by the writer until
+           it's queued, and only the frames still in the ring need it. */
+        SDL_DUMMY_CopyRect(capture, surface, frame, &frame->stale);
+        for (i = 0; i < numrects; ++i) {
+            SDL_DUMMY_CopyRect(capture, surface, frame, &rects[i]);
+        }
+        SDL_zero(frame->stale);
+        frame->frame_number = frame_number;
+        ++capture->captured;
+        capture->dropping = SDL_FALSE;
+    } else {
+        ++capture->dropped;
+        if (!capture->dropping) {
+            SDL_Log("Dummy video: window %d is dropping frames, %d so far",
+                    capture->windowID, capture->dropped);
+            capture->dropping = SDL_TRUE;
+        }
+    }
+
+    /* The other buffers need this area when they're next filled */
+    if (!SDL_RectEmpty(&dirty)) {
+        for (i = 0; i < capture->nframes; ++i) {
+            if (&capture->frames[i] != frame) {
+                SDL_UnionRect(&capture->frames[i].stale, &dirty, &capture->frames[i].stale);
+            }
+        }
+    }
+
+    if (!frame) {
+        return;
+    }
+    if (!capture->thread) {
+        SDL_DUMMY_WriteFrame(capture, frame);
+        return;
+    }
+    SDL_LockMutex(capture->lock);
+    capture->head = (capture->head + 1) % capture->nframes;
+    ++capture->count;
+    SDL_CondSignal(capture->cond);
+    SDL_UnlockMutex(capture->lock);
+}
 
 int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch)
 {
@@ -36,7 +373,8 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
     int bpp;
     Uint32 Rmask, Gmask, Bmask, Amask;
 
-    /* Free the old framebuffer surface */
+    /* Free the old framebuffer surface, after the frames captured from it */
+    SDL_DUMMY_DestroyCapture((SDL_DummyCapture *) SDL_SetWindowData(window, DUMMY_CAPTURE, NULL));
     surface = (SDL_Surface *) SDL_GetWindowData(window, DUMMY_SURFACE);
     SDL_FreeSurface(surface);
 
@@ -48,6 +386,16 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
         return -1;
     }
 
+    /* Set up frame capture, if it was asked for */
+    if (SDL_getenv("SDL_VIDEO_DUMMY_SAVE_FRAMES")) {
+        SDL_DummyCapture *capture = SDL_DUMMY_CreateCapture(window, surface);
+        if (!capture) {
+            SDL_FreeSurface(surface);
+            return -1;
+        }
+        SDL_SetWindowData(window, DUMMY_CAPTURE, capture);
+    }
+
     /* Save the info and return! */
     SDL_SetWindowData(window, DUMMY_SURFACE, surface);
     *format = surface_format;
@@ -58,8 +406,8 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
 
 int SDL_DUMMY_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects)
 {
-    static int frame_number;
     SDL_Surface *surface;
+    SDL_DummyCapture *capture;
 
     surface = (SDL_Surface *) SDL_GetWindowData(window, DUMMY_SURFACE);
     if (!surface) {
@@ -67,11 +415,9 @@ int SDL_DUMMY_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect
     }
 
     /* Send the data to the display */
-    if (SDL_getenv("SDL_VIDEO_DUMMY_SAVE_FRAMES")) {
-        char file[128];
-        SDL_snprintf(file, sizeof(file), "SDL_window%d-%8.8d.bmp",
-                     SDL_GetWindowID(window), ++frame_number);
-        SDL_SaveBMP(surface, file);
+    capture = (SDL_DummyCapture *) SDL_GetWindowData(window, DUMMY_CAPTURE);
+    if (capture) {
+        SDL_DUMMY_CaptureFrame(capture, surface, rects, numrects);
     }
     return 0;
 }
@@ -80,6 +426,7 @@ void SDL_DUMMY_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
 {
     SDL_Surface *surface;
 
+    SDL_DUMMY_DestroyCapture((SDL_DummyCapture *) SDL_SetWindowData(window, DUMMY_CAPTURE, NULL));
     surface = (SDL_Surface *) SDL_SetWindowData(window, DUMMY_SURFACE, NULL);
     SDL_FreeSurface(surface);
 }
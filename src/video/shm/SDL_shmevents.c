@@ -0,0 +1,111 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_DRIVER_SHM
+
+#include "../../events/SDL_events_c.h"
+#include "../../events/SDL_keyboard_c.h"
+#include "../../events/SDL_mouse_c.h"
+#include "../../events/SDL_windowevents_c.h"
+
+#include "SDL_shmvideo_c.h"
+#include "SDL_shmevents_c.h"
+
+static void
+SHM_DispatchEvent(SDL_Window * window, SDL_ShmVideoEvent *event)
+{
+    const Uint8 state = event->pressed ? SDL_PRESSED : SDL_RELEASED;
+
+    switch (event->type) {
+    case SDL_SHMVIDEO_EVENT_KEY:
+    case SDL_SHMVIDEO_EVENT_TEXT:
+        if (SDL_GetKeyboardFocus() != window) {
+            SDL_SetKeyboardFocus(window);
+        }
+        if (event->type == SDL_SHMVIDEO_EVENT_TEXT) {
+            event->text[sizeof(event->text) - 1] = '\0';
+            SDL_SendKeyboardText(event->text);
+        } else if (event->code < SDL_NUM_SCANCODES) {
+            SDL_SendKeyboardKey(state, (SDL_Scancode) event->code);
+        }
+        break;
+
+    case SDL_SHMVIDEO_EVENT_MOUSEMOTION:
+    case SDL_SHMVIDEO_EVENT_MOUSEBUTTON:
+    case SDL_SHMVIDEO_EVENT_MOUSEWHEEL:
+        if (SDL_GetMouseFocus() != window) {
+            SDL_SetMouseFocus(window);
+        }
+        if (event->type == SDL_SHMVIDEO_EVENT_MOUSEMOTION) {
+            SDL_SendMouseMotion(window, 0, 0, event->x, event->y);
+        } else if (event->type == SDL_SHMVIDEO_EVENT_MOUSEBUTTON) {
+            SDL_SendMouseButton(window, 0, state, (Uint8) event->code);
+        } else {
+            SDL_SendMouseWheel(window, 0, (float) event->x, (float) event->y, SDL_MOUSEWHEEL_NORMAL);
+        }
+        break;
+
+    case SDL_SHMVIDEO_EVENT_CLOSE:
+        SDL_SendWindowEvent(window, SDL_WINDOWEVENT_CLOSE, 0, 0);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void
+SHM_PumpEvents(_THIS)
+{
+    SDL_Window *window;
+
+    for (window = _this->windows; window; window = window->next) {
+        SHM_Framebuffer *framebuffer = (SHM_Framebuffer *) SDL_GetWindowData(window, SHM_FRAMEBUFFER);
+        SDL_ShmVideoHeader *header;
+        SDL_ShmVideoEvent *ring;
+        Uint32 head, tail;
+
+        if (!framebuffer) {
+            continue;
+        }
+        header = framebuffer->header;
+        ring = (SDL_ShmVideoEvent *) ((Uint8 *) header + header->event_offset);
+
+        /* Entries up to head have been written by the other process */
+        head = (Uint32) SDL_AtomicGet(&header->event_head);
+        tail = (Uint32) SDL_AtomicGet(&header->event_tail);
+        if ((head - tail) > header->num_events) {
+            /* Whatever happened, those entries can't be trusted */
+            tail = head;
+        }
+        while (tail != head) {
+            SDL_ShmVideoEvent event = ring[tail % header->num_events];
+            ++tail;
+            SHM_DispatchEvent(window, &event);
+        }
+        SDL_AtomicSet(&header->event_tail, (int) tail);
+    }
+}
+
+#endif /* SDL_VIDEO_DRIVER_SHM */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,286 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_DRIVER_SHM
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "../SDL_sysvideo.h"
+#include "SDL_shmvideo_c.h"
+#include "SDL_shmframebuffer_c.h"
+
+#define SHM_BUFFERS         3
+#define SHM_MAX_BUFFERS     16
+#define SHM_EVENTS          256
+
+#define SHM_ALIGN(x, a)     (((x) + ((a) - 1)) & ~((size_t) (a) - 1))
+
+static void
+SHM_Wake(SDL_ShmVideoHeader *header)
+{
+    SDL_AtomicAdd(&header->sequence, 1);
+#ifdef __linux__
+    syscall(SYS_futex, &header->sequence.value, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+int
+SHM_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch)
+{
+    const Uint32 surface_format = SDL_PIXELFORMAT_RGB888;
+    SHM_Framebuffer *framebuffer;
+    SDL_ShmVideoHeader *header;
+    SDL_Surface *surface;
+    size_t event_offset, buffer_offset, buffer_size;
+    const char *hint;
+    int num_buffers;
+    int w, h;
+    int i, fd;
+    void *map;
+
+    /* Free the old framebuffer */
+    SHM_DestroyWindowFramebuffer(_this, window);
+
+    framebuffer = (SHM_Framebuffer *) SDL_calloc(1, sizeof(*framebuffer));
+    if (!framebuffer) {
+        return SDL_OutOfMemory();
+    }
+
+    /* Create the surface the application draws into */
+    SDL_GetWindowSize(window, &w, &h);
+    surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, surface_format);
+    if (!surface) {
+        SDL_free(framebuffer);
+        return -1;
+    }
+    framebuffer->surface = surface;
+
+    /* Work out the layout of the shared memory */
+    hint = SDL_getenv("SDL_VIDEO_SHM_BUFFERS");
+    num_buffers = hint ? SDL_atoi(hint) : 0;
+    if (num_buffers <= 0) {
+        num_buffers = SHM_BUFFERS;
+    }
+    num_buffers = SDL_max(num_buffers, 2);
+    num_buffers = SDL_min(num_buffers, SHM_MAX_BUFFERS);
+
+    event_offset = SHM_ALIGN(sizeof(*header), 64);
+    buffer_offset = SHM_ALIGN(event_offset + SHM_EVENTS * sizeof(SDL_ShmVideoEvent), 4096);
+    buffer_size = SHM_ALIGN((size_t) surface->h * surface->pitch, 4096);
+    framebuffer->size = buffer_offset + num_buffers * buffer_size;
+
+    framebuffer->stale = (SDL_Rect *) SDL_calloc(num_buffers, sizeof(SDL_Rect));
+    if (!framebuffer->stale) {
+        SDL_FreeSurface(surface);
+        SDL_free(framebuffer);
+        return SDL_OutOfMemory();
+    }
+    for (i = 0; i < num_buffers; ++i) {
+        framebuffer->stale[i].w = surface->w;
+        framebuffer->stale[i].h = surface->h;
+    }
+
+    /* Create the shared memory object */
+    hint = SDL_getenv("SDL_VIDEO_SHM_NAME");
+    if (hint && *hint == '/') {
+        ++hint;
+    }
+    if (hint && SDL_strchr(hint, '/')) {
+        SDL_free(framebuffer->stale);
+        SDL_FreeSurface(surface);
+        SDL_free(framebuffer);
+        return SDL_SetError("SDL_VIDEO_SHM_NAME can only have a '/' at the start");
+    }
+    if (hint) {
+        SDL_snprintf(framebuffer->name, sizeof(framebuffer->name), "/%s-%u",
+                     hint, SDL_GetWindowID(window));
+    } else {
+        SDL_snprintf(framebuffer->name, sizeof(framebuffer->name), "/SDL_shm-%d-%u",
+                     (int) getpid(), SDL_GetWindowID(window));
+    }
+    fd = shm_open(framebuffer->name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        SDL_SetError("Couldn't create shared memory %s", framebuffer->name);
+        map = MAP_FAILED;
+    } else if (ftruncate(fd, (off_t) framebuffer->size) < 0) {
+        SDL_SetError("Couldn't resize shared memory %s", framebuffer->name);
+        map = MAP_FAILED;
+    } else {
+        map = mmap(NULL, framebuffer->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            SDL_SetError("Couldn't map shared memory %s", framebuffer->name);
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (map == MAP_FAILED) {
+        if (fd >= 0) {
+            shm_unlink(framebuffer->name);
+        }
+        SDL_free(framebuffer->stale);
+        SDL_FreeSurface(surface);
+        SDL_free(framebuffer);
+        return -1;
+    }
+
+    /* Fill in the header, the magic number last so it's complete when seen */
+    header = (SDL_ShmVideoHeader *) map;
+    header->version = SDL_SHMVIDEO_VERSION;
+    header->format = surface_format;
+    header->w = surface->w;
+    header->h = surface->h;
+    header->pitch = surface->pitch;
+    header->num_buffers = num_buffers;
+    header->buffer_offset = (Uint32) buffer_offset;
+    header->buffer_size = (Uint32) buffer_size;
+    header->event_offset = (Uint32) event_offset;
+    header->num_events = SHM_EVENTS;
+    SDL_AtomicSet(&header->front, SDL_SHMVIDEO_NONE);
+    SDL_AtomicSet(&header->reading, SDL_SHMVIDEO_NONE);
+    SDL_MemoryBarrierRelease();
+    header->magic = SDL_SHMVIDEO_MAGIC;
+    framebuffer->header = header;
+
+    /* Save the info and return! */
+    SDL_SetWindowData(window, SHM_FRAMEBUFFER, framebuffer);
+    *format = surface_format;
+    *pixels = surface->pixels;
+    *pitch = surface->pitch;
+    return 0;
+}
+
+static void
+SHM_CopyRect(SHM_Framebuffer *framebuffer, Uint8 *buffer, const SDL_Rect * rect)
+{
+    const SDL_Surface *surface = framebuffer->surface;
+    SDL_Rect area;
+    const Uint8 *src;
+    Uint8 *dst;
+    int y;
+
+    if (!SDL_IntersectRect(rect, &surface->clip_rect, &area)) {
+        return;
+    }
+    src = (const Uint8 *) surface->pixels + area.y * surface->pitch + area.x * 4;
+    dst = buffer + area.y * surface->pitch + area.x * 4;
+    if (area.x == 0 && area.w == surface->w) {
+        SDL_memcpy(dst, src, (size_t) area.h * surface->pitch);
+        return;
+    }
+    for (y = area.h; y--; ) {
+        SDL_memcpy(dst, src, area.w * 4);
+        src += surface->pitch;
+        dst += surface->pitch;
+    }
+}
+
+int
+SHM_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects)
+{
+    SHM_Framebuffer *framebuffer;
+    SDL_ShmVideoHeader *header;
+    SDL_Rect dirty;
+    int front, reading, back;
+    int i;
+
+    framebuffer = (SHM_Framebuffer *) SDL_GetWindowData(window, SHM_FRAMEBUFFER);
+    if (!framebuffer) {
+        return SDL_SetError("Couldn't find shared memory framebuffer for window");
+    }
+    header = framebuffer->header;
+
+    SDL_zero(dirty);
+    for (i = 0; i < numrects; ++i) {
+        SDL_UnionRect(&dirty, &rects[i], &dirty);
+    }
+
+    /* Pick a buffer that isn't being shown or read, with two buffers the
+       consumer may be holding the only spare one and the frame is skipped */
+    front = SDL_AtomicGet(&header->front);
+    reading = SDL_AtomicGet(&header->reading);
+    back = SDL_SHMVIDEO_NONE;
+    for (i = 1; i <= (int) header->num_buffers; ++i) {
+        const int buffer = (front + i) % (int) header->num_buffers;
+        if (buffer != front && buffer != reading) {
+            back = buffer;
+            break;
+        }
+    }
+
+    /* Bring it up to date, the other buffers still need this frame's area */
+    if (back != SDL_SHMVIDEO_NONE) {
+        Uint8 *pixels = (Uint8 *) header + header->buffer_offset + back * header->buffer_size;
+
+        SHM_CopyRect(framebuffer, pixels, &framebuffer->stale[back]);
+        for (i = 0; i < numrects; ++i) {
+            SHM_CopyRect(framebuffer, pixels, &rects[i]);
+        }
+        SDL_zero(framebuffer->stale[back]);
+    }
+    if (!SDL_RectEmpty(&dirty)) {
+        for (i = 0; i < (int) header->num_buffers; ++i) {
+            if (i != back) {
+                SDL_UnionRect(&framebuffer->stale[i], &dirty, &framebuffer->stale[i]);
+            }
+        }
+    }
+
+    if (back != SDL_SHMVIDEO_NONE) {
+        SDL_AtomicSet(&header->front, back);
+        SHM_Wake(header);
+    }
+    return 0;
+}
+
+void
+SHM_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
+{
+    SHM_Framebuffer *framebuffer;
+
+    framebuffer = (SHM_Framebuffer *) SDL_SetWindowData(window, SHM_FRAMEBUFFER, NULL);
+    if (!framebuffer) {
+        return;
+    }
+
+    /* Tell the consumer to let go of it */
+    SDL_AtomicSet(&framebuffer->header->closed, 1);
+    SHM_Wake(framebuffer->header);
+    munmap(framebuffer->header, framebuffer->size);
+    shm_unlink(framebuffer->name);
+
+    SDL_free(framebuffer->stale);
+    SDL_FreeSurface(framebuffer->surface);
+    SDL_free(framebuffer);
+}
+
+#endif /* SDL_VIDEO_DRIVER_SHM */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,135 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_DRIVER_SHM
+
+/* Headless SDL video driver that publishes window framebuffers in shared
+ *  memory, so another local process can show, encode or test them without
+ *  any copies, and feed input back the same way.
+ *
+ * The shared memory layout is described in SDL_shmvideo.h.
+ */
+
+#include "SDL_video.h"
+#include "../SDL_sysvideo.h"
+#include "../../events/SDL_events_c.h"
+
+#include "SDL_shmvideo_c.h"
+#include "SDL_shmevents_c.h"
+#include "SDL_shmframebuffer_c.h"
+
+#define SHMVID_DRIVER_NAME "shm"
+
+/* Initialization/Query functions */
+static int SHM_VideoInit(_THIS);
+static int SHM_SetDisplayMode(_THIS, SDL_VideoDisplay * display, SDL_DisplayMode * mode);
+static void SHM_VideoQuit(_THIS);
+
+/* SHM driver bootstrap functions */
+
+static int
+SHM_Available(void)
+{
+    const char *envr = SDL_getenv("SDL_VIDEODRIVER");
+    if ((envr) && (SDL_strcmp(envr, SHMVID_DRIVER_NAME) == 0)) {
+        return (1);
+    }
+
+    return (0);
+}
+
+static void
+SHM_DeleteDevice(SDL_VideoDevice * device)
+{
+    SDL_free(device);
+}
+
+static SDL_VideoDevice *
+SHM_CreateDevice(int devindex)
+{
+    SDL_VideoDevice *device;
+
+    /* Initialize all variables that we clean on shutdown */
+    device = (SDL_VideoDevice *) SDL_calloc(1, sizeof(SDL_VideoDevice));
+    if (!device) {
+        SDL_OutOfMemory();
+        return (0);
+    }
+    /* There's no GPU, windows only have a software framebuffer */
+    device->is_dummy = SDL_TRUE;
+
+    /* Set the function pointers */
+    device->VideoInit = SHM_VideoInit;
+    device->VideoQuit = SHM_VideoQuit;
+    device->SetDisplayMode = SHM_SetDisplayMode;
+    device->PumpEvents = SHM_PumpEvents;
+    device->CreateWindowFramebuffer = SHM_CreateWindowFramebuffer;
+    device->UpdateWindowFramebuffer = SHM_UpdateWindowFramebuffer;
+    device->DestroyWindowFramebuffer = SHM_DestroyWindowFramebuffer;
+
+    device->free = SHM_DeleteDevice;
+
+    return device;
+}
+
+VideoBootStrap SHM_bootstrap = {
+    SHMVID_DRIVER_NAME, "SDL shared memory video driver",
+    SHM_Available, SHM_CreateDevice
+};
+
+
+int
+SHM_VideoInit(_THIS)
+{
+    SDL_DisplayMode mode;
+
+    /* Use a fake 32-bpp desktop mode */
+    mode.format = SDL_PIXELFORMAT_RGB888;
+    mode.w = 1024;
+    mode.h = 768;
+    mode.refresh_rate = 0;
+    mode.driverdata = NULL;
+    if (SDL_AddBasicVideoDisplay(&mode) < 0) {
+        return -1;
+    }
+
+    SDL_zero(mode);
+    SDL_AddDisplayMode(&_this->displays[0], &mode);
+
+    /* We're done! */
+    return 0;
+}
+
+static int
+SHM_SetDisplayMode(_THIS, SDL_VideoDisplay * display, SDL_DisplayMode * mode)
+{
+    return 0;
+}
+
+void
+SHM_VideoQuit(_THIS)
+{
+}
+
+#endif /* SDL_VIDEO_DRIVER_SHM */
+
+/* vi: set ts=4 sw=4 expandtab: */
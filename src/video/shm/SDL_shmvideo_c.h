@@ -0,0 +1,43 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifndef SDL_shmvideo_c_h_
+#define SDL_shmvideo_c_h_
+
+#include "SDL_shmvideo.h"
+#include "../SDL_sysvideo.h"
+
+#define SHM_FRAMEBUFFER "_SDL_ShmFramebuffer"
+
+/* A window framebuffer, published in a shared memory object */
+typedef struct
+{
+    char name[128];
+    SDL_ShmVideoHeader *header;
+    size_t size;
+    SDL_Surface *surface;   /* What the application draws into */
+    SDL_Rect *stale;        /* Per buffer, what changed since it was filled */
+} SHM_Framebuffer;
+
+#endif /* SDL_shmvideo_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
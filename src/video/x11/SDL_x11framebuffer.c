@@ -50,8 +50,169 @@ static SDL_bool have_mitshm(void)
     return SDL_FALSE;
 }
 
+static SDL_bool
+X11_CreateShmBuffer(Display *display, SDL_WindowData *data,
+                    const XVisualInfo *vinfo, int w, int h, int pitch,
+                    X11_ShmBuffer *buffer)
+{
+    XShmSegmentInfo *shminfo = &buffer->shminfo;
+
+    shminfo->shmid = shmget(IPC_PRIVATE, h*pitch, IPC_CREAT | 0777);
+    if ( shminfo->shmid >= 0 ) {
+        shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
+        shminfo->readOnly = False;
+        if ( shminfo->shmaddr != (char *)-1 ) {
+            shm_error = False;
+            X_handler = X11_XSetErrorHandler(shm_errhandler);
+            X11_XShmAttach(display, shminfo);
+            X11_XSync(display, False);
+            X11_XSetErrorHandler(X_handler);
+            if ( shm_error )
+                shmdt(shminfo->shmaddr);
+        } else {
+            shm_error = True;
+        }
+        shmctl(shminfo->shmid, IPC_RMID, NULL);
+    } else {
+        shm_error = True;
+    }
+    if (shm_error) {
+        return SDL_FALSE;
+    }
+
+    buffer->ximage = X11_XShmCreateImage(display, data->visual,
+                       vinfo->depth, ZPixmap,
+                       shminfo->shmaddr, shminfo, w, h);
+    if (!buffer->ximage) {
+        X11_XShmDetach(display, shminfo);
+        X11_XSync(display, False);
+        shmdt(shminfo->shmaddr);
+        return SDL_FALSE;
+    }
+
+    /* Nothing has been copied into it yet */
+    buffer->busy = SDL_FALSE;
+    buffer->stale.x = 0;
+    buffer->stale.y = 0;
+    buffer->stale.w = w;
+    buffer->stale.h = h;
+    return SDL_TRUE;
+}
+
+static Bool
+X11_IsShmCompletion(Display *display, XEvent *event, XPointer arg)
+{
+    SDL_WindowData *data = (SDL_WindowData *) arg;
+
+    return (event->type == data->videodata->shm_completion &&
+            event->xany.window == data->xwindow);
+}
+
+void
+X11_HandleShmCompletion(SDL_WindowData *data, const XEvent *event)
+{
+    const XShmCompletionEvent *completion = (const XShmCompletionEvent *) event;
+    int i;
+
+    for (i = 0; i < data->num_shmbuffers; ++i) {
+        if (data->shmbuffers[i].shminfo.shmseg == completion->shmseg) {
+            data->shmbuffers[i].busy = SDL_FALSE;
+            break;
+        }
+    }
+}
+
+/* Handle the completion events the server has sent so far, without waiting */
+static void
+X11_CheckShmCompletions(Display *display, SDL_WindowData *data)
+{
+    XEvent event;
+
+    while (X11_XCheckIfEvent(display, &event, X11_IsShmCompletion, (XPointer) data)) {
+        X11_HandleShmCompletion(data, &event);
+    }
+}
+
+static X11_ShmBuffer *
+X11_GetFreeShmBuffer(Display *display, SDL_WindowData *data)
+{
+    int i;
+
+    X11_CheckShmCompletions(display, data);
+    for (i = 0; i < data->num_shmbuffers; ++i) {
+        if (!data->shmbuffers[i].busy) {
+            return &data->shmbuffers[i];
+        }
+    }
+
+    /* The server is still reading every segment, once it has handled all
+       our requests they are free again and their completions are queued. */
+    X11_XSync(display, False);
+    X11_CheckShmCompletions(display, data);
+    for (i = 0; i < data->num_shmbuffers; ++i) {
+        data->shmbuffers[i].busy = SDL_FALSE;
+    }
+    return &data->shmbuffers[0];
+}
+
+static void
+X11_CopyToShmBuffer(const SDL_WindowData *data, X11_ShmBuffer *buffer,
+                    const SDL_Rect *rect)
+{
+    const int bpp = buffer->ximage->bits_per_pixel / 8;
+    const int pitch = data->shmpitch;
+    const size_t length = (size_t) rect->w * bpp;
+    const Uint8 *src = data->shmpixels + rect->y * pitch + rect->x * bpp;
+    Uint8 *dst = (Uint8 *) buffer->ximage->data + rect->y * pitch + rect->x * bpp;
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        src += pitch;
+        dst += pitch;
+    }
+}
+
+static void
+X11_DestroyShmBuffers(Display *display, SDL_WindowData *data)
+{
+    XEvent event;
+    int i;
+
+    for (i = 0; i < data->num_shmbuffers; ++i) {
+        X11_XShmDetach(display, &data->shmbuffers[i].shminfo);
+    }
+    X11_XSync(display, False);
+
+    /* Drop the completions of our last presents, the segment IDs may be
+       reused by the next framebuffer */
+    while (X11_XCheckIfEvent(display, &event, X11_IsShmCompletion, (XPointer) data)) {
+        continue;
+    }
+
+    for (i = 0; i < data->num_shmbuffers; ++i) {
+        XDestroyImage(data->shmbuffers[i].ximage);
+        shmdt(data->shmbuffers[i].shminfo.shmaddr);
+        data->shmbuffers[i].ximage = NULL;
+    }
+    data->num_shmbuffers = 0;
+}
+
 #endif /* !NO_SHARED_MEMORY */
 
+/* Clip an update rectangle to the window, returning SDL_FALSE if it's empty */
+static SDL_bool
+X11_ClipUpdateRect(SDL_Window * window, const SDL_Rect * rect, SDL_Rect * result)
+{
+    SDL_Rect bounds;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+    return SDL_IntersectRect(rect, &bounds, result);
+}
+
 int
 X11_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format,
                             void ** pixels, int *pitch)
@@ -87,42 +248,29 @@ X11_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format,
     /* Create the actual image */
 #ifndef NO_SHARED_MEMORY
     if (have_mitshm()) {
-        XShmSegmentInfo *shminfo = &data->shminfo;
-
-        shminfo->shmid = shmget(IPC_PRIVATE, window->h*(*pitch), IPC_CREAT | 0777);
-        if ( shminfo->shmid >= 0 ) {
-            shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
-            shminfo->readOnly = False;
-            if ( shminfo->shmaddr != (char *)-1 ) {
-                shm_error = False;
-                X_handler = X11_XSetErrorHandler(shm_errhandler);
-                X11_XShmAttach(display, shminfo);
-                X11_XSync(display, False);
-                X11_XSetErrorHandler(X_handler);
-                if ( shm_error )
-                    shmdt(shminfo->shmaddr);
-            } else {
-                shm_error = True;
+        /* The application draws into a private buffer, and each update is
+           copied into a segment the server isn't reading from.  The server
+           tells us with a completion event when it's done with a segment,
+           so presenting doesn't have to wait for it.
+         */
+        data->shmpixels = (Uint8 *) SDL_malloc(window->h*(*pitch));
+        if (data->shmpixels) {
+            while (data->num_shmbuffers < X11_SHM_BUFFERS &&
+                   X11_CreateShmBuffer(display, data, &vinfo,
+                                       window->w, window->h, *pitch,
+                                       &data->shmbuffers[data->num_shmbuffers])) {
+                ++data->num_shmbuffers;
             }
-            shmctl(shminfo->shmid, IPC_RMID, NULL);
-        } else {
-            shm_error = True;
-        }
-        if (!shm_error) {
-            data->ximage = X11_XShmCreateImage(display, data->visual,
-                             vinfo.depth, ZPixmap,
-                             shminfo->shmaddr, shminfo,
-                             window->w, window->h);
-            if (!data->ximage) {
-                X11_XShmDetach(display, shminfo);
-                X11_XSync(display, False);
-                shmdt(shminfo->shmaddr);
-            } else {
+            if (data->num_shmbuffers > 0) {
                 /* Done! */
+                data->videodata->shm_completion = X11_XShmGetEventBase(display) + ShmCompletion;
                 data->use_mitshm = SDL_TRUE;
-                *pixels = shminfo->shmaddr;
+                data->shmpitch = *pitch;
+                *pixels = data->shmpixels;
                 return 0;
             }
+            SDL_free(data->shmpixels);
+            data->shmpixels = NULL;
         }
     }
 #endif /* not NO_SHARED_MEMORY */
@@ -148,70 +296,61 @@ X11_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects,
 {
     SDL_WindowData *data = (SDL_WindowData *) window->driverdata;
     Display *display = data->videodata->display;
+    SDL_Rect rect;
     int i;
-    int x, y, w ,h;
 #ifndef NO_SHARED_MEMORY
     if (data->use_mitshm) {
-        for (i = 0; i < numrects; ++i) {
-            x = rects[i].x;
-            y = rects[i].y;
-            w = rects[i].w;
-            h = rects[i].h;
+        X11_ShmBuffer *buffer = X11_GetFreeShmBuffer(display, data);
+        SDL_Rect last;
+        SDL_bool have_last = SDL_FALSE;
+        int j;
+
+        /* Bring the segment up to date with what was presented from the others */
+        if (!SDL_RectEmpty(&buffer->stale)) {
+            X11_CopyToShmBuffer(data, buffer, &buffer->stale);
+            SDL_zero(buffer->stale);
+        }
 
-            if (w <= 0 || h <= 0 || (x + w) <= 0 || (y + h) <= 0) {
-                /* Clipped? */
+        for (i = 0; i < numrects; ++i) {
+            if (!X11_ClipUpdateRect(window, &rects[i], &rect)) {
                 continue;
             }
-            if (x < 0)
-            {
-                x += w;
-                w += rects[i].x;
-            }
-            if (y < 0)
-            {
-                y += h;
-                h += rects[i].y;
+
+            X11_CopyToShmBuffer(data, buffer, &rect);
+            for (j = 0; j < data->num_shmbuffers; ++j) {
+                X11_ShmBuffer *other = &data->shmbuffers[j];
+                if (other != buffer) {
+                    SDL_UnionRect(&other->stale, &rect, &other->stale);
+                }
             }
-            if (x + w > window->w)
-                w = window->w - x;
-            if (y + h > window->h)
-                h = window->h - y;
 
-            X11_XShmPutImage(display, data->xwindow, data->gc, data->ximage,
-                x, y, x, y, w, h, False);
+            /* Only the last image of the update asks for a completion event,
+               the server handles them in order. */
+            if (have_last) {
+                X11_XShmPutImage(display, data->xwindow, data->gc, buffer->ximage,
+                    last.x, last.y, last.x, last.y, last.w, last.h, False);
+            }
+            last = rect;
+            have_last = SDL_TRUE;
         }
+        if (have_last) {
+            X11_XShmPutImage(display, data->xwindow, data->gc, buffer->ximage,
+                last.x, last.y, last.x, last.y, last.w, last.h, True);
+            buffer->busy = SDL_TRUE;
+        }
+
+        X11_XFlush(display);
+        return 0;
     }
-    else
 #endif /* !NO_SHARED_MEMORY */
-    {
-        for (i = 0; i < numrects; ++i) {
-            x = rects[i].x;
-            y = rects[i].y;
-            w = rects[i].w;
-            h = rects[i].h;
-
-            if (w <= 0 || h <= 0 || (x + w) <= 0 || (y + h) <= 0) {
-                /* Clipped? */
-                continue;
-            }
-            if (x < 0)
-            {
-                x += w;
-                w += rects[i].x;
-            }
-            if (y < 0)
-            {
-                y += h;
-                h += rects[i].y;
-            }
-            if (x + w > window->w)
-                w = window->w - x;
-            if (y + h > window->h)
-                h = window->h - y;
 
-            X11_XPutImage(display, data->xwindow, data->gc, data->ximage,
-                x, y, x, y, w, h);
+    for (i = 0; i < numrects; ++i) {
+        if (!X11_ClipUpdateRect(window, &rects[i], &rect)) {
+            continue;
         }
+
+        X11_XPutImage(display, data->xwindow, data->gc, data->ximage,
+            rect.x, rect.y, rect.x, rect.y, rect.w, rect.h);
     }
 
     X11_XSync(display, False);
@@ -232,18 +371,17 @@ X11_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
 
     display = data->videodata->display;
 
-    if (data->ximage) {
-        XDestroyImage(data->ximage);
-
 #ifndef NO_SHARED_MEMORY
-        if (data->use_mitshm) {
-            X11_XShmDetach(display, &data->shminfo);
-            X11_XSync(display, False);
-            shmdt(data->shminfo.shmaddr);
-            data->use_mitshm = SDL_FALSE;
-        }
+    if (data->use_mitshm) {
+        X11_DestroyShmBuffers(display, data);
+        SDL_free(data->shmpixels);
+        data->shmpixels = NULL;
+        data->use_mitshm = SDL_FALSE;
+    }
 #endif /* !NO_SHARED_MEMORY */
 
+    if (data->ximage) {
+        XDestroyImage(data->ximage);
         data->ximage = NULL;
     }
     if (data->gc) {
@@ -31,6 +31,10 @@ extern int X11_CreateWindowFramebuffer(_THIS, SDL_Window * window,
 extern int X11_UpdateWindowFramebuffer(_THIS, SDL_Window * window,
                                        const SDL_Rect * rects, int numrects);
 extern void X11_DestroyWindowFramebuffer(_THIS, SDL_Window * window);
+#ifndef NO_SHARED_MEMORY
+extern void X11_HandleShmCompletion(SDL_WindowData * data,
+                                    const XEvent * event);
+#endif
 
 #endif /* SDL_x11framebuffer_h_ */
 
@@ -40,6 +40,19 @@ typedef enum
     PENDING_FOCUS_OUT
 } PendingFocusEnum;
 
+#ifndef NO_SHARED_MEMORY
+/* The number of shared memory segments the framebuffer is presented from */
+#define X11_SHM_BUFFERS 2
+
+typedef struct
+{
+    XShmSegmentInfo shminfo;
+    XImage *ximage;
+    SDL_bool busy;      /* The server hasn't finished reading it yet */
+    SDL_Rect stale;     /* The area that changed since it was last presented */
+} X11_ShmBuffer;
+#endif
+
 typedef struct
 {
     SDL_Window *window;
@@ -50,7 +63,10 @@ typedef struct
 #ifndef NO_SHARED_MEMORY
     /* MIT shared memory extension information */
     SDL_bool use_mitshm;
-    XShmSegmentInfo shminfo;
+    X11_ShmBuffer shmbuffers[X11_SHM_BUFFERS];
+    int num_shmbuffers;
+    Uint8 *shmpixels;   /* The framebuffer the application draws into */
+    int shmpitch;
 #endif
     XImage *ximage;
     GC gc;
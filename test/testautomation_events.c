@@ -174,6 +174,275 @@ events_addDelEventWatchWithUserdata(void *arg)
    return TEST_COMPLETED;
 }
 
+/* The event timestamp clock, see SDL_PeepEventsTimestamped() */
+static Uint64
+_events_getTimeNS(void)
+{
+   const Uint64 counter = SDL_GetPerformanceCounter();
+   const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+   return (counter / frequency) * 1000000000 + ((counter % frequency) * 1000000000) / frequency;
+}
+
+/**
+ * @brief Checks the timestamps of queued events and their latency.
+ *
+ * @sa SDL_PeepEventsTimestamped
+ * @sa SDL_GetEventLatency
+ */
+int
+events_timestamps(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[2];
+   SDL_EventLatency latency;
+   Uint64 timestamps[2];
+   Uint64 before, after, hardware;
+   int result;
+
+   SDL_FlushEvents(SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertPass("Call to SDL_FlushEvents()");
+
+   /* An event without a hardware time is stamped when it's queued */
+   SDL_zero(event);
+   event.type = SDL_USEREVENT;
+   event.user.code = 1;
+   before = _events_getTimeNS();
+   result = SDL_PushEvent(&event);
+   after = _events_getTimeNS();
+   SDLTest_AssertCheck(result == 1, "Check result from SDL_PushEvent, expected: 1, got: %d", result);
+
+   /* A hardware time is kept, and counted in the latency */
+   event.user.code = 2;
+   hardware = before - 1000000;
+   result = SDL_PeepEventsTimestamped(&event, &hardware, 1, SDL_ADDEVENT, 0, 0);
+   SDLTest_AssertCheck(result == 1, "Check result from SDL_PeepEventsTimestamped(SDL_ADDEVENT), expected: 1, got: %d", result);
+
+   result = SDL_PeepEventsTimestamped(events, timestamps, 2, SDL_GETEVENT, SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertCheck(result == 2, "Check result from SDL_PeepEventsTimestamped(SDL_GETEVENT), expected: 2, got: %d", result);
+   SDLTest_AssertCheck(events[0].user.code == 1 && events[1].user.code == 2, "Check the order of the events");
+   SDLTest_AssertCheck(timestamps[0] >= before && timestamps[0] <= after, "Check the queue time is between %" SDL_PRIu64 " and %" SDL_PRIu64 ", got: %" SDL_PRIu64, before, after, timestamps[0]);
+   SDLTest_AssertCheck(timestamps[1] == hardware, "Check the hardware time, expected: %" SDL_PRIu64 ", got: %" SDL_PRIu64, hardware, timestamps[1]);
+
+   result = SDL_GetEventLatency(SDL_USEREVENT, &latency);
+   SDLTest_AssertCheck(result == 0, "Check result from SDL_GetEventLatency, expected: 0, got: %d", result);
+   SDLTest_AssertCheck(latency.count >= 1, "Check latency count, expected: >= 1, got: %u", latency.count);
+   SDLTest_AssertCheck(latency.last >= 1000000, "Check latest latency, expected: >= 1000000, got: %" SDL_PRIu64, latency.last);
+   SDLTest_AssertCheck(latency.max >= latency.last, "Check max latency is at least the latest");
+
+   result = SDL_GetEventLatency(SDL_LASTEVENT + 1, &latency);
+   SDLTest_AssertCheck(result == -1, "Check result from SDL_GetEventLatency with an invalid type, expected: -1, got: %d", result);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests merging motion events in the queue
+ *
+ * @sa SDL_HINT_EVENT_COALESCE_MOTION
+ */
+int
+events_coalesceMotion(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[4];
+   Uint64 timestamps[4];
+   Uint64 hardware;
+   int result;
+
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertPass("Call to SDL_FlushEvents()");
+
+   SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, "1");
+   SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, \"1\")");
+
+   /* Consecutive motion in the same window is merged */
+   SDL_zero(event);
+   event.type = SDL_MOUSEMOTION;
+   event.motion.windowID = 1;
+   event.motion.x = 10;
+   event.motion.y = 20;
+   event.motion.xrel = 1;
+   event.motion.yrel = 2;
+   SDL_PushEvent(&event);
+   event.motion.x = 13;
+   event.motion.y = 24;
+   event.motion.xrel = 3;
+   event.motion.yrel = 4;
+   hardware = 12345;
+   SDL_PeepEventsTimestamped(&event, &hardware, 1, SDL_ADDEVENT, 0, 0);
+
+   /* Motion in another window isn't */
+   event.motion.windowID = 2;
+   SDL_PushEvent(&event);
+
+   /* Neither is motion after another event */
+   event.type = SDL_MOUSEBUTTONDOWN;
+   SDL_PushEvent(&event);
+   event.type = SDL_MOUSEMOTION;
+   SDL_PushEvent(&event);
+
+   result = SDL_PeepEventsTimestamped(events, timestamps, SDL_arraysize(events), SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(result == 4, "Check result from SDL_PeepEventsTimestamped(SDL_GETEVENT), expected: 4, got: %d", result);
+   if (result == 4) {
+      SDLTest_AssertCheck(events[0].motion.x == 13 && events[0].motion.y == 24, "Check the merged position, expected: 13,24, got: %d,%d", events[0].motion.x, events[0].motion.y);
+      SDLTest_AssertCheck(events[0].motion.xrel == 4 && events[0].motion.yrel == 6, "Check the merged relative motion, expected: 4,6, got: %d,%d", events[0].motion.xrel, events[0].motion.yrel);
+      SDLTest_AssertCheck(timestamps[0] == hardware, "Check the merged timestamp, expected: %" SDL_PRIu64 ", got: %" SDL_PRIu64, hardware, timestamps[0]);
+      SDLTest_AssertCheck(events[1].motion.windowID == 2, "Check motion in another window, expected: 2, got: %u", events[1].motion.windowID);
+      SDLTest_AssertCheck(events[2].type == SDL_MOUSEBUTTONDOWN && events[3].type == SDL_MOUSEMOTION, "Check motion after another event is kept");
+   }
+
+   /* Nothing is merged once the hint is cleared */
+   SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, "0");
+   SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, \"0\")");
+   SDL_PushEvent(&event);
+   SDL_PushEvent(&event);
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+   SDLTest_AssertCheck(result == 2, "Check result from SDL_PeepEvents(SDL_GETEVENT), expected: 2, got: %d", result);
+
+   return TEST_COMPLETED;
+}
+
+/* Event watcher that counts the events it sees, and removes itself at a limit */
+int SDLCALL _events_countingEventWatch(void *userdata, SDL_Event *event)
+{
+   int *count = (int *)userdata;
+
+   if (++*count == 2) {
+      SDL_DelEventWatch(_events_countingEventWatch, userdata);
+   }
+   return 0;
+}
+
+/**
+ * @brief Tests event watchers for a range of event types
+ *
+ * @sa SDL_AddEventWatchRange
+ * @sa SDL_DelEventWatch
+ */
+int
+events_addEventWatchRange(void *arg)
+{
+   SDL_Event event;
+   int count = 0;
+
+   SDL_zero(event);
+
+   SDL_AddEventWatchRange(_events_countingEventWatch, &count, SDL_USEREVENT + 1, SDL_USEREVENT + 2);
+   SDLTest_AssertPass("Call to SDL_AddEventWatchRange()");
+
+   /* Events outside the range aren't seen */
+   event.type = SDL_USEREVENT;
+   SDL_PushEvent(&event);
+   event.type = SDL_USEREVENT + 3;
+   SDL_PushEvent(&event);
+   event.type = SDL_KEYDOWN;
+   SDL_PushEvent(&event);
+   SDLTest_AssertCheck(count == 0, "Check the watch wasn't called, expected: 0, got: %d", count);
+
+   event.type = SDL_USEREVENT + 1;
+   SDL_PushEvent(&event);
+   SDLTest_AssertCheck(count == 1, "Check the watch was called, expected: 1, got: %d", count);
+
+   /* It removes itself on the second event */
+   event.type = SDL_USEREVENT + 2;
+   SDL_PushEvent(&event);
+   SDL_PushEvent(&event);
+   SDLTest_AssertCheck(count == 2, "Check the watch was removed, expected: 2, got: %d", count);
+
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   return TEST_COMPLETED;
+}
+
+/* Event filter that turns user events into key presses */
+int SDLCALL _events_retypeUserEvents(void *userdata, SDL_Event *event)
+{
+   if (event->type == SDL_USEREVENT) {
+      event->type = SDL_KEYDOWN;
+   }
+   return 1;
+}
+
+/**
+ * @brief Tests getting events by type and in bulk
+ *
+ * @sa SDL_PeepEvents
+ * @sa SDL_FlushEvents
+ * @sa SDL_FilterEvents
+ * @sa SDL_PollEvents
+ */
+int
+events_pollEvents(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[8];
+   const Uint32 types[] = { SDL_KEYDOWN, SDL_USEREVENT, SDL_MOUSEBUTTONDOWN, SDL_KEYUP, SDL_USEREVENT + 1, SDL_MOUSEBUTTONUP };
+   int i, result;
+
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertPass("Call to SDL_FlushEvents()");
+
+   SDL_zero(event);
+   for (i = 0; i < SDL_arraysize(types); ++i) {
+      event.type = types[i];
+      SDL_PushEvent(&event);
+   }
+
+   /* Events of one kind are found in order */
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_PEEKEVENT, SDL_KEYDOWN, SDL_KEYUP);
+   SDLTest_AssertCheck(result == 2, "Check result from SDL_PeepEvents(SDL_PEEKEVENT), expected: 2, got: %d", result);
+   SDLTest_AssertCheck(result == 2 && events[0].type == SDL_KEYDOWN && events[1].type == SDL_KEYUP, "Check the order of the keyboard events");
+
+   /* So are events of several kinds */
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT, SDL_MOUSEBUTTONDOWN, SDL_LASTEVENT);
+   SDLTest_AssertCheck(result == 4, "Check result from SDL_PeepEvents(SDL_GETEVENT), expected: 4, got: %d", result);
+   SDLTest_AssertCheck(result == 4 &&
+                       events[0].type == SDL_USEREVENT && events[1].type == SDL_MOUSEBUTTONDOWN &&
+                       events[2].type == SDL_USEREVENT + 1 && events[3].type == SDL_MOUSEBUTTONUP,
+                       "Check the order of the mouse and user events");
+
+   SDLTest_AssertCheck(SDL_HasEvents(SDL_KEYDOWN, SDL_KEYUP), "Check the keyboard events are still queued");
+   SDLTest_AssertCheck(!SDL_HasEvents(SDL_MOUSEMOTION, SDL_LASTEVENT), "Check there are no mouse or user events left");
+
+   SDL_FlushEvent(SDL_KEYDOWN);
+   SDLTest_AssertPass("Call to SDL_FlushEvent(SDL_KEYDOWN)");
+   SDLTest_AssertCheck(!SDL_HasEvent(SDL_KEYDOWN) && SDL_HasEvent(SDL_KEYUP), "Check only SDL_KEYDOWN was flushed");
+
+   /* Everything that's left comes back at once */
+   for (i = 0; i < SDL_arraysize(types); ++i) {
+      event.type = types[i];
+      SDL_PushEvent(&event);
+   }
+   result = SDL_PollEvents(events, SDL_arraysize(events));
+   SDLTest_AssertCheck(result == 7, "Check result from SDL_PollEvents, expected: 7, got: %d", result);
+   if (result == 7) {
+      SDLTest_AssertCheck(events[0].type == SDL_KEYUP, "Check the first event, expected: %u, got: %u", SDL_KEYUP, events[0].type);
+      for (i = 0; i < SDL_arraysize(types); ++i) {
+         SDLTest_AssertCheck(events[i + 1].type == types[i], "Check event %d, expected: %u, got: %u", i + 1, types[i], events[i + 1].type);
+      }
+   }
+
+   result = SDL_PollEvents(events, SDL_arraysize(events));
+   SDLTest_AssertCheck(result == 0, "Check result from SDL_PollEvents on an empty queue, expected: 0, got: %d", result);
+
+   /* Events retyped by a filter are found by their new type */
+   for (i = 0; i < SDL_arraysize(types); ++i) {
+      event.type = types[i];
+      SDL_PushEvent(&event);
+   }
+   SDL_FilterEvents(_events_retypeUserEvents, NULL);
+   SDLTest_AssertPass("Call to SDL_FilterEvents()");
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT, SDL_KEYDOWN, SDL_KEYDOWN);
+   SDLTest_AssertCheck(result == 2, "Check result from SDL_PeepEvents(SDL_GETEVENT) after filtering, expected: 2, got: %d", result);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(!SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT), "Check the queue is empty after SDL_FlushEvents()");
+
+   result = SDL_PollEvents(NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Check result from SDL_PollEvents with NULL events, expected: -1, got: %d", result);
+
+   return TEST_COMPLETED;
+}
 
 /* ================= Test References ================== */
 
@@ -187,9 +456,21 @@ static const SDLTest_TestCaseReference eventsTest2 =
 static const SDLTest_TestCaseReference eventsTest3 =
         { (SDLTest_TestCaseFp)events_addDelEventWatchWithUserdata, "events_addDelEventWatchWithUserdata", "Adds and deletes an event watch function with userdata", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference eventsTest4 =
+        { (SDLTest_TestCaseFp)events_timestamps, "events_timestamps", "Checks event timestamps and latency", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest5 =
+        { (SDLTest_TestCaseFp)events_coalesceMotion, "events_coalesceMotion", "Checks merging motion events in the queue", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest6 =
+        { (SDLTest_TestCaseFp)events_pollEvents, "events_pollEvents", "Gets events by type and in bulk", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest7 =
+        { (SDLTest_TestCaseFp)events_addEventWatchRange, "events_addEventWatchRange", "Adds and deletes an event watch function for a range of types", TEST_ENABLED };
+
 /* Sequence of Events test cases */
 static const SDLTest_TestCaseReference *eventsTests[] =  {
-    &eventsTest1, &eventsTest2, &eventsTest3, NULL
+    &eventsTest1, &eventsTest2, &eventsTest3, &eventsTest4, &eventsTest5, &eventsTest6, &eventsTest7, NULL
 };
 
 /* Events test suite (global) */
@@ -334,6 +334,258 @@ rwops_testFileRead(void)
    return TEST_COMPLETED;
 }
 
+/**
+ * @brief Tests reading from a memory-mapped file.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromFileMapped
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWGetPointer
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWClose
+ */
+int
+rwops_testFileMapped(void)
+{
+   SDL_RWops *rw;
+   const void *ptr;
+   size_t available;
+   char *data;
+   size_t datasize;
+   int result;
+
+   /* Negative test */
+   rw = SDL_RWFromFileMapped(NULL);
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromFileMapped(NULL) returns NULL");
+
+   /* Read test. */
+   rw = SDL_RWFromFileMapped(RWopsReadTestFilename);
+   SDLTest_AssertPass("Call to SDL_RWFromFileMapped() succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFileMapped does not return NULL");
+
+   /* Bail out if NULL */
+   if (rw == NULL) return TEST_ABORTED;
+
+   /* Check type */
+#if defined(__ANDROID__)
+   SDLTest_AssertCheck(
+      rw->type == SDL_RWOPS_MAPPED || rw->type == SDL_RWOPS_JNIFILE,
+      "Verify RWops type is SDL_RWOPS_MAPPED or SDL_RWOPS_JNIFILE; expected: %d|%d, got: %d", SDL_RWOPS_MAPPED, SDL_RWOPS_JNIFILE, rw->type);
+#else
+   SDLTest_AssertCheck(
+      rw->type == SDL_RWOPS_MAPPED,
+      "Verify RWops type is SDL_RWOPS_MAPPED; expected: %d, got: %d", SDL_RWOPS_MAPPED, rw->type);
+#endif
+
+   if (rw->type == SDL_RWOPS_MAPPED) {
+      /* The mapped data can be accessed directly */
+      ptr = SDL_RWGetPointer(rw, &available);
+      SDLTest_AssertPass("Call to SDL_RWGetPointer() succeeded");
+      SDLTest_AssertCheck(ptr != NULL, "Verify SDL_RWGetPointer does not return NULL");
+      SDLTest_AssertCheck(available == SDL_strlen(RWopsHelloWorldTestString), "Verify available bytes, expected %i, got %i", (int) SDL_strlen(RWopsHelloWorldTestString), (int) available);
+      if (ptr != NULL) {
+         SDLTest_AssertCheck(SDL_memcmp(ptr, RWopsHelloWorldCompString, available) == 0, "Verify mapped data matches the file");
+      }
+      SDL_RWseek(rw, 6, RW_SEEK_SET);
+      ptr = SDL_RWGetPointer(rw, &available);
+      SDLTest_AssertCheck(available == SDL_strlen(RWopsHelloWorldTestString) - 6, "Verify available bytes after seek, expected %i, got %i", (int) SDL_strlen(RWopsHelloWorldTestString) - 6, (int) available);
+      if (ptr != NULL) {
+         SDLTest_AssertCheck(SDL_memcmp(ptr, RWopsHelloWorldCompString + 6, available) == 0, "Verify mapped data after seek matches the file");
+      }
+   }
+
+   /* Run generic tests */
+   _testGenericRWopsValidations( rw, 0 );
+
+   /* Load the whole file from the mapping */
+   SDL_RWseek(rw, 0, RW_SEEK_SET);
+   data = (char *) SDL_LoadFile_RW(rw, &datasize, 0);
+   SDLTest_AssertPass("Call to SDL_LoadFile_RW() succeeded");
+   SDLTest_AssertCheck(data != NULL, "Verify SDL_LoadFile_RW does not return NULL");
+   if (data != NULL) {
+      SDLTest_AssertCheck(datasize == SDL_strlen(RWopsHelloWorldTestString), "Verify loaded size, expected %i, got %i", (int) SDL_strlen(RWopsHelloWorldTestString), (int) datasize);
+      SDLTest_AssertCheck(SDL_strcmp(data, RWopsHelloWorldCompString) == 0, "Verify loaded data matches the file");
+      SDL_free(data);
+   }
+
+   /* Close handle */
+   result = SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+   /* File streams can't be accessed directly */
+   rw = SDL_RWFromFile(RWopsReadTestFilename, "r");
+   if (rw != NULL) {
+      ptr = SDL_RWGetPointer(rw, &available);
+      SDLTest_AssertCheck(ptr == NULL, "Verify SDL_RWGetPointer returns NULL for a file stream");
+      SDLTest_AssertCheck(available == 0, "Verify available bytes is 0 for a file stream, got %i", (int) available);
+      SDL_RWclose(rw);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests reading and writing through a buffered stream.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromBuffered
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWClose
+ */
+int
+rwops_testBuffered(void)
+{
+   SDL_RWops *rw;
+   SDL_RWops *buffered;
+   char buf[2];
+   Sint64 position;
+   int result;
+
+   /* Negative test */
+   buffered = SDL_RWFromBuffered(NULL, 0, 0);
+   SDLTest_AssertCheck(buffered == NULL, "Verify SDL_RWFromBuffered(NULL, ...) returns NULL");
+
+   /* Write test, with a buffer smaller than the test data */
+   rw = SDL_RWFromFile(RWopsWriteTestFilename, "w+");
+   SDLTest_AssertPass("Call to SDL_RWFromFile(..,\"w+\") succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFile in write mode does not return NULL");
+
+   /* Bail out if NULL */
+   if (rw == NULL) return TEST_ABORTED;
+
+   buffered = SDL_RWFromBuffered(rw, 5, 1);
+   SDLTest_AssertPass("Call to SDL_RWFromBuffered(.., 5, 1) succeeded");
+   SDLTest_AssertCheck(buffered != NULL, "Verify SDL_RWFromBuffered does not return NULL");
+   if (buffered == NULL) {
+      SDL_RWclose(rw);
+      return TEST_ABORTED;
+   }
+
+   /* Check type */
+   SDLTest_AssertCheck(
+      buffered->type == SDL_RWOPS_BUFFERED,
+      "Verify RWops type is SDL_RWOPS_BUFFERED; expected: %d, got: %d", SDL_RWOPS_BUFFERED, buffered->type);
+
+   /* Run generic tests */
+   _testGenericRWopsValidations( buffered, 1 );
+
+   /* Close handle, this closes the file too */
+   result = SDL_RWclose(buffered);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+   /* Read test, the data read ahead is given back on close */
+   rw = SDL_RWFromFile(RWopsReadTestFilename, "r");
+   SDLTest_AssertPass("Call to SDL_RWFromFile(..,\"r\") succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFile in read mode does not return NULL");
+
+   /* Bail out if NULL */
+   if (rw == NULL) return TEST_ABORTED;
+
+   buffered = SDL_RWFromBuffered(rw, 0, 0);
+   SDLTest_AssertPass("Call to SDL_RWFromBuffered(.., 0, 0) succeeded");
+   SDLTest_AssertCheck(buffered != NULL, "Verify SDL_RWFromBuffered does not return NULL");
+   if (buffered != NULL) {
+      result = (int) SDL_RWread(buffered, buf, 1, 1);
+      SDLTest_AssertCheck(result == 1, "Verify result from SDL_RWread, expected 1, got %i", result);
+      SDLTest_AssertCheck(buf[0] == RWopsHelloWorldCompString[0], "Verify read data matches the file");
+      result = SDL_RWclose(buffered);
+      SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+      SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+      position = SDL_RWtell(rw);
+      SDLTest_AssertCheck(position == 1, "Verify position of the original stream, expected 1, got %i", (int) position);
+      result = (int) SDL_RWread(rw, buf, 1, 1);
+      SDLTest_AssertCheck(result == 1, "Verify result from SDL_RWread, expected 1, got %i", result);
+      SDLTest_AssertCheck(buf[0] == RWopsHelloWorldCompString[1], "Verify original stream continues where the buffered stream stopped");
+   }
+
+   /* Close handle */
+   result = SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests asynchronous reads and writes on a file.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_AsyncIOFromFile
+ * http://wiki.libsdl.org/moin.cgi/SDL_WriteAsyncIO
+ * http://wiki.libsdl.org/moin.cgi/SDL_ReadAsyncIO
+ * http://wiki.libsdl.org/moin.cgi/SDL_CloseAsyncIO
+ */
+int
+rwops_testAsyncIO(void)
+{
+   SDL_AsyncIO *asyncio;
+   SDL_AsyncIOQueue *queue;
+   SDL_AsyncIOOutcome outcome;
+   char buf[sizeof(RWopsHelloWorldTestString)];
+   const size_t len = SDL_strlen(RWopsHelloWorldTestString);
+   int result;
+   int i;
+
+   /* Negative tests */
+   asyncio = SDL_AsyncIOFromFile(NULL, "rb");
+   SDLTest_AssertCheck(asyncio == NULL, "Verify SDL_AsyncIOFromFile(NULL, \"rb\") returns NULL");
+   result = SDL_ReadAsyncIO(NULL, buf, 0, 1, NULL, NULL);
+   SDLTest_AssertCheck(result == -1, "Verify SDL_ReadAsyncIO(NULL, ...) returns -1, got %i", result);
+
+   queue = SDL_CreateAsyncIOQueue();
+   SDLTest_AssertPass("Call to SDL_CreateAsyncIOQueue() succeeded");
+   SDLTest_AssertCheck(queue != NULL, "Verify SDL_CreateAsyncIOQueue does not return NULL");
+   if (queue == NULL) return TEST_ABORTED;
+
+   /* Nothing is pending, so this doesn't wait */
+   SDLTest_AssertCheck(SDL_WaitAsyncIOResult(queue, &outcome, -1) == SDL_FALSE, "Verify SDL_WaitAsyncIOResult on an idle queue returns SDL_FALSE");
+
+   asyncio = SDL_AsyncIOFromFile(RWopsWriteTestFilename, "w+b");
+   SDLTest_AssertPass("Call to SDL_AsyncIOFromFile(..,\"w+b\") succeeded");
+   SDLTest_AssertCheck(asyncio != NULL, "Verify opening file with SDL_AsyncIOFromFile in write mode does not return NULL");
+   if (asyncio == NULL) {
+      SDL_DestroyAsyncIOQueue(queue);
+      return TEST_ABORTED;
+   }
+
+   /* Write the string one character at a time, in reverse order */
+   for (i = (int) len - 1; i >= 0; --i) {
+      result = SDL_WriteAsyncIO(asyncio, &RWopsHelloWorldTestString[i], i, 1, queue, (void *) &RWopsHelloWorldTestString[i]);
+      SDLTest_AssertCheck(result == 0, "Verify result from SDL_WriteAsyncIO, expected 0, got %i", result);
+   }
+   for (i = 0; i < (int) len; ++i) {
+      SDLTest_AssertCheck(SDL_WaitAsyncIOResult(queue, &outcome, -1) == SDL_TRUE, "Verify SDL_WaitAsyncIOResult returns SDL_TRUE");
+      SDLTest_AssertCheck(outcome.type == SDL_ASYNCIO_TASK_WRITE, "Verify task type, expected %i, got %i", SDL_ASYNCIO_TASK_WRITE, outcome.type);
+      SDLTest_AssertCheck(outcome.result == SDL_ASYNCIO_COMPLETE, "Verify task result, expected %i, got %i", SDL_ASYNCIO_COMPLETE, outcome.result);
+      SDLTest_AssertCheck(outcome.bytes_transferred == 1, "Verify bytes written, expected 1, got %i", (int) outcome.bytes_transferred);
+      SDLTest_AssertCheck(outcome.userdata == outcome.buffer, "Verify userdata was passed back");
+   }
+   SDLTest_AssertCheck(SDL_AsyncIOSize(asyncio) == (Sint64) len, "Verify SDL_AsyncIOSize, expected %i, got %i", (int) len, (int) SDL_AsyncIOSize(asyncio));
+
+   /* Read it back, asking for more than there is */
+   SDL_zero(buf);
+   result = SDL_ReadAsyncIO(asyncio, buf, 0, sizeof(buf), queue, NULL);
+   SDLTest_AssertCheck(result == 0, "Verify result from SDL_ReadAsyncIO, expected 0, got %i", result);
+   SDLTest_AssertCheck(SDL_WaitAsyncIOResult(queue, &outcome, -1) == SDL_TRUE, "Verify SDL_WaitAsyncIOResult returns SDL_TRUE");
+   SDLTest_AssertCheck(outcome.type == SDL_ASYNCIO_TASK_READ, "Verify task type, expected %i, got %i", SDL_ASYNCIO_TASK_READ, outcome.type);
+   SDLTest_AssertCheck(outcome.result == SDL_ASYNCIO_COMPLETE, "Verify task result, expected %i, got %i", SDL_ASYNCIO_COMPLETE, outcome.result);
+   SDLTest_AssertCheck(outcome.bytes_transferred == len, "Verify bytes read, expected %i, got %i", (int) len, (int) outcome.bytes_transferred);
+   SDLTest_AssertCheck(SDL_strcmp(buf, RWopsHelloWorldCompString) == 0, "Verify read data matches what was written, got '%s'", buf);
+
+   /* Close it */
+   result = SDL_CloseAsyncIO(asyncio, queue, NULL);
+   SDLTest_AssertCheck(result == 0, "Verify result from SDL_CloseAsyncIO, expected 0, got %i", result);
+   SDLTest_AssertCheck(SDL_WaitAsyncIOResult(queue, &outcome, -1) == SDL_TRUE, "Verify SDL_WaitAsyncIOResult returns SDL_TRUE");
+   SDLTest_AssertCheck(outcome.type == SDL_ASYNCIO_TASK_CLOSE, "Verify task type, expected %i, got %i", SDL_ASYNCIO_TASK_CLOSE, outcome.type);
+   SDLTest_AssertCheck(outcome.result == SDL_ASYNCIO_COMPLETE, "Verify task result, expected %i, got %i", SDL_ASYNCIO_COMPLETE, outcome.result);
+   SDLTest_AssertCheck(SDL_GetAsyncIOResult(queue, &outcome) == SDL_FALSE, "Verify the queue is empty");
+
+   SDL_DestroyAsyncIOQueue(queue);
+   SDLTest_AssertPass("Call to SDL_DestroyAsyncIOQueue() succeeded");
+
+   return TEST_COMPLETED;
+}
+
 /**
  * @brief Tests writing from file.
  *
@@ -733,10 +985,19 @@ static const SDLTest_TestCaseReference rwopsTest9 =
 static const SDLTest_TestCaseReference rwopsTest10 =
         { (SDLTest_TestCaseFp)rwops_testCompareRWFromMemWithRWFromFile, "rwops_testCompareRWFromMemWithRWFromFile", "Compare RWFromMem and RWFromFile RWops for read and seek", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference rwopsTest11 =
+        { (SDLTest_TestCaseFp)rwops_testFileMapped, "rwops_testFileMapped", "Tests reading from a memory-mapped file", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest12 =
+        { (SDLTest_TestCaseFp)rwops_testBuffered, "rwops_testBuffered", "Tests reading and writing through a buffered stream", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest13 =
+        { (SDLTest_TestCaseFp)rwops_testAsyncIO, "rwops_testAsyncIO", "Tests asynchronous reads and writes on a file", TEST_ENABLED };
+
 /* Sequence of RWops test cases */
 static const SDLTest_TestCaseReference *rwopsTests[] =  {
     &rwopsTest1, &rwopsTest2, &rwopsTest3, &rwopsTest4, &rwopsTest5, &rwopsTest6,
-    &rwopsTest7, &rwopsTest8, &rwopsTest9, &rwopsTest10, NULL
+    &rwopsTest7, &rwopsTest8, &rwopsTest9, &rwopsTest10, &rwopsTest11, &rwopsTest12, &rwopsTest13, NULL
 };
 
 /* RWops test suite (global) */
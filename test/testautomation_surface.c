@@ -259,6 +259,151 @@ surface_testSaveLoadBitmap(void *arg)
     return TEST_COMPLETED;
 }
 
+/**
+ * @brief Tests saving surfaces of various formats to BMP and loading them back.
+ */
+int
+surface_testSaveLoadBitmapFormats(void *arg)
+{
+    const Uint32 formats[] = {
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_PIXELFORMAT_RGB888,
+        SDL_PIXELFORMAT_BGR888,
+        SDL_PIXELFORMAT_RGB24,
+        SDL_PIXELFORMAT_BGR24
+    };
+    SDL_Surface *face;
+    Uint8 *buffer;
+    size_t bufferSize;
+    int i, ret;
+
+    /* Create sample surface */
+    face = SDLTest_ImageFace();
+    SDLTest_AssertCheck(face != NULL, "Verify face surface is not NULL");
+    if (face == NULL) return TEST_ABORTED;
+
+    bufferSize = 1024 + face->w * face->h * 4;
+    buffer = (Uint8 *) SDL_malloc(bufferSize);
+    SDLTest_AssertCheck(buffer != NULL, "Verify buffer is not NULL");
+    if (buffer == NULL) {
+        SDL_FreeSurface(face);
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        SDL_Surface *surface, *rface, *expected, *loaded;
+        SDL_RWops *rw;
+
+        surface = SDL_ConvertSurfaceFormat(face, formats[i], 0);
+        SDLTest_AssertCheck(surface != NULL, "Verify conversion to %s", SDL_GetPixelFormatName(formats[i]));
+        if (surface == NULL) {
+            continue;
+        }
+
+        /* Save the surface */
+        rw = SDL_RWFromMem(buffer, (int) bufferSize);
+        ret = SDL_SaveBMP_RW(surface, rw, 1);
+        SDLTest_AssertPass("Call to SDL_SaveBMP_RW()");
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SaveBMP_RW, expected: 0, got: %i", ret);
+
+        /* Load it back and compare the pixels */
+        rface = SDL_LoadBMP_RW(SDL_RWFromConstMem(buffer, (int) bufferSize), 1);
+        SDLTest_AssertPass("Call to SDL_LoadBMP_RW()");
+        SDLTest_AssertCheck(rface != NULL, "Verify result from SDL_LoadBMP_RW is not NULL");
+        if (rface != NULL) {
+            expected = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+            loaded = SDL_ConvertSurfaceFormat(rface, SDL_PIXELFORMAT_ARGB8888, 0);
+            if (expected != NULL && loaded != NULL) {
+                ret = SDLTest_CompareSurfaces(loaded, expected, 0);
+                SDLTest_AssertCheck(ret == 0, "Validate %s round trip, expected: 0, got: %i", SDL_GetPixelFormatName(formats[i]), ret);
+            }
+            SDL_FreeSurface(expected);
+            SDL_FreeSurface(loaded);
+            SDL_FreeSurface(rface);
+        }
+        SDL_FreeSurface(surface);
+    }
+
+    /* Clean up */
+    SDL_free(buffer);
+    SDL_FreeSurface(face);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests reading the pixels of an RLE accelerated surface with SDL_LockSurfaceReadOnly().
+ */
+int
+surface_testLockReadOnlyRLE(void *arg)
+{
+    SDL_Surface *image, *face, *reference, *expected;
+    Uint32 key;
+    int y, ret;
+
+    /* Create a colorkeyed face in the format of the test surface */
+    image = SDLTest_ImageFace();
+    SDLTest_AssertCheck(image != NULL, "Verify face surface is not NULL");
+    if (image == NULL) return TEST_ABORTED;
+    face = SDL_ConvertSurface(image, testSurface->format, 0);
+    SDL_FreeSurface(image);
+    SDLTest_AssertCheck(face != NULL, "Verify converted face surface is not NULL");
+    if (face == NULL) return TEST_ABORTED;
+    reference = SDL_ConvertSurface(face, face->format, 0);
+    SDLTest_AssertCheck(reference != NULL, "Verify reference surface is not NULL");
+    if (reference == NULL) {
+        SDL_FreeSurface(face);
+        return TEST_ABORTED;
+    }
+    key = *(Uint32 *) face->pixels;
+    ret = SDL_SetSurfaceBlendMode(face, SDL_BLENDMODE_NONE);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SetSurfaceBlendMode, expected: 0, got: %i", ret);
+    ret = SDL_SetColorKey(face, SDL_TRUE | SDL_RLEACCEL, key);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SetColorKey, expected: 0, got: %i", ret);
+
+    /* Blit it once, so that it gets encoded */
+    _clearTestSurface();
+    ret = SDL_BlitSurface(face, NULL, testSurface, NULL);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+    expected = SDL_ConvertSurface(testSurface, testSurface->format, 0);
+    SDLTest_AssertCheck(expected != NULL, "Verify expected surface is not NULL");
+
+    /* Read the pixels back */
+    ret = SDL_LockSurfaceReadOnly(face);
+    SDLTest_AssertPass("Call to SDL_LockSurfaceReadOnly()");
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_LockSurfaceReadOnly, expected: 0, got: %i", ret);
+    if (ret == 0) {
+        SDLTest_AssertCheck(face->pixels != NULL, "Verify pixels are not NULL");
+        for (y = 0; face->pixels != NULL && y < face->h; ++y) {
+            const Uint8 *row = (const Uint8 *) face->pixels + y * face->pitch;
+            const Uint8 *rrow = (const Uint8 *) reference->pixels + y * reference->pitch;
+            if (SDL_memcmp(row, rrow, face->w * face->format->BytesPerPixel) != 0) {
+                break;
+            }
+        }
+        SDLTest_AssertCheck(y == face->h, "Verify decoded pixels, expected rows: %i, got: %i", face->h, y);
+        SDL_UnlockSurface(face);
+    }
+    SDLTest_AssertCheck((face->flags & SDL_RLEACCEL) != 0, "Verify surface is still RLE accelerated");
+
+    /* Blitting gives the same result as before */
+    _clearTestSurface();
+    ret = SDL_BlitSurface(face, NULL, testSurface, NULL);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+    if (expected != NULL) {
+        ret = SDLTest_CompareSurfaces(testSurface, expected, 0);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces, expected: 0, got: %i", ret);
+    }
+
+    /* Clean up */
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(reference);
+    SDL_FreeSurface(face);
+
+    return TEST_COMPLETED;
+}
+
 /* !
  *  Tests surface conversion.
  */
@@ -630,11 +775,17 @@ static const SDLTest_TestCaseReference surfaceTest11 =
 static const SDLTest_TestCaseReference surfaceTest12 =
         { (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest13 =
+        { (SDLTest_TestCaseFp)surface_testSaveLoadBitmapFormats, "surface_testSaveLoadBitmapFormats", "Tests saving and loading bitmaps of various formats.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+        { (SDLTest_TestCaseFp)surface_testLockReadOnlyRLE, "surface_testLockReadOnlyRLE", "Tests reading the pixels of an RLE accelerated surface.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14, NULL
 };
 
 /* Surface test suite (global) */
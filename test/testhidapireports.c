@@ -0,0 +1,300 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Replays recorded controller reports through the HIDAPI report queue, the
+   way the reader thread and the joystick update see them, and checks that
+   only axis motion is skipped when reports pile up. */
+
+#include <stdlib.h>
+
+#include "SDL_test.h"
+
+#ifndef SDL_JOYSTICK_HIDAPI
+
+int
+main(int argc, char *argv[])
+{
+    SDL_Log("No HIDAPI support on this system\n");
+    return 0;
+}
+
+#else
+
+#include "../src/joystick/hidapi/SDL_hidapi_reports.h"
+
+#define MAX_STREAM_REPORTS  16
+
+typedef struct
+{
+    int size;
+    Uint8 data[32];
+} RecordedReport;
+
+typedef struct
+{
+    const char *name;
+    HIDAPI_IsReportSupersededFunc is_superseded;
+    int num_reports;
+    RecordedReport reports[MAX_STREAM_REPORTS];
+    /* The last report before each button change, and the last one */
+    int num_expected;
+    int expected[MAX_STREAM_REPORTS];
+} RecordedStream;
+
+static const RecordedStream streams[] = {
+#ifdef SDL_JOYSTICK_HIDAPI_PS4
+    {
+        "PS4 over USB", HIDAPI_DriverPS4_IsReportSuperseded,
+        7, {
+            /* Report ID, sticks, buttons and hat, counter, triggers */
+            { 10, { 0x01, 0x80, 0x80, 0x80, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+            { 10, { 0x01, 0x90, 0x80, 0x80, 0x80, 0x08, 0x00, 0x04, 0x00, 0x00 } },
+            { 10, { 0x01, 0xa0, 0x7c, 0x80, 0x80, 0x08, 0x00, 0x08, 0x00, 0x00 } },
+            { 10, { 0x01, 0xa0, 0x7c, 0x80, 0x80, 0x28, 0x00, 0x0c, 0x00, 0x00 } },  /* Cross down */
+            { 10, { 0x01, 0xb0, 0x70, 0x80, 0x80, 0x28, 0x00, 0x10, 0x40, 0x00 } },
+            { 10, { 0x01, 0xb0, 0x70, 0x80, 0x80, 0x08, 0x00, 0x15, 0x40, 0x00 } },  /* Cross up, PS down */
+            { 10, { 0x01, 0xc0, 0x60, 0x80, 0x80, 0x08, 0x00, 0x18, 0x00, 0x00 } },  /* PS up */
+        },
+        4, { 2, 4, 5, 6 }
+    },
+    {
+        "PS4 over Bluetooth", HIDAPI_DriverPS4_IsReportSuperseded,
+        5, {
+            /* Report ID, two header bytes, then the same layout as USB */
+            { 12, { 0x11, 0xc0, 0x00, 0x80, 0x80, 0x80, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+            { 12, { 0x11, 0xc0, 0x00, 0x70, 0x80, 0x80, 0x80, 0x08, 0x00, 0x04, 0x00, 0x00 } },
+            { 12, { 0x11, 0xc0, 0x00, 0x70, 0x80, 0x80, 0x80, 0x06, 0x00, 0x08, 0x00, 0x00 } },  /* Hat left */
+            { 12, { 0x11, 0xc0, 0x00, 0x60, 0x80, 0x80, 0x80, 0x06, 0x00, 0x0c, 0x00, 0x00 } },
+            { 12, { 0x11, 0xc0, 0x00, 0x50, 0x80, 0x80, 0x80, 0x06, 0x00, 0x10, 0x00, 0x00 } },
+        },
+        2, { 1, 4 }
+    },
+#endif
+#ifdef SDL_JOYSTICK_HIDAPI_SWITCH
+    {
+        "Switch simple state", HIDAPI_DriverSwitch_IsReportSuperseded,
+        6, {
+            /* Report ID, buttons, hat, sticks */
+            { 12, { 0x3f, 0x00, 0x00, 0x08, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },
+            { 12, { 0x3f, 0x00, 0x00, 0x08, 0x00, 0x90, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },
+            { 12, { 0x3f, 0x02, 0x00, 0x08, 0x00, 0xa0, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },  /* A down */
+            { 12, { 0x3f, 0x02, 0x00, 0x08, 0x00, 0xb0, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },
+            { 12, { 0x3f, 0x02, 0x00, 0x02, 0x00, 0xb0, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },  /* Hat right */
+            { 12, { 0x3f, 0x02, 0x00, 0x02, 0x00, 0xc0, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80 } },
+        },
+        3, { 1, 3, 5 }
+    },
+    {
+        "Switch full state", HIDAPI_DriverSwitch_IsReportSuperseded,
+        6, {
+            /* Report ID, counter, battery, buttons, sticks */
+            { 12, { 0x30, 0x01, 0x90, 0x00, 0x00, 0x00, 0x00, 0x08, 0x80, 0x00, 0x08, 0x80 } },
+            { 12, { 0x30, 0x02, 0x90, 0x00, 0x00, 0x00, 0x10, 0x08, 0x80, 0x00, 0x08, 0x80 } },
+            { 12, { 0x30, 0x03, 0x90, 0x00, 0x00, 0x00, 0x20, 0x08, 0x80, 0x00, 0x08, 0x80 } },
+            { 12, { 0x30, 0x04, 0x90, 0x00, 0x10, 0x00, 0x20, 0x08, 0x80, 0x00, 0x08, 0x80 } },  /* Home down */
+            { 12, { 0x30, 0x05, 0x90, 0x00, 0x00, 0x00, 0x20, 0x08, 0x80, 0x00, 0x08, 0x80 } },  /* Home up */
+            { 12, { 0x30, 0x06, 0x90, 0x00, 0x00, 0x00, 0x30, 0x08, 0x80, 0x00, 0x08, 0x80 } },
+        },
+        3, { 2, 3, 5 }
+    },
+#endif
+#if defined(SDL_JOYSTICK_HIDAPI_XBOX360) && !defined(__WIN32__)
+    {
+        "Xbox 360", HIDAPI_DriverXbox360_IsReportSuperseded,
+        5, {
+            /* Report ID, size, buttons, triggers, sticks */
+            { 20, { 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 } },
+            { 20, { 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20 } },
+            { 20, { 0x00, 0x14, 0x00, 0x10, 0x00, 0x00, 0x00, 0x20 } },  /* A down */
+            { 20, { 0x00, 0x14, 0x00, 0x10, 0x80, 0x00, 0x00, 0x20 } },
+            { 20, { 0x00, 0x14, 0x00, 0x10, 0xff, 0x00, 0x00, 0x20 } },
+        },
+        2, { 1, 4 }
+    },
+#endif
+#ifdef SDL_JOYSTICK_HIDAPI_XBOXONE
+    {
+        "Xbox One", HIDAPI_DriverXboxOne_IsReportSuperseded,
+        6, {
+            /* Report ID, sequence, length, buttons, triggers, sticks */
+            { 18, { 0x20, 0x00, 0x01, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+            { 18, { 0x20, 0x00, 0x02, 0x0e, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00 } },
+            { 6, { 0x07, 0x20, 0x03, 0x02, 0x01, 0x5b } },                           /* Guide down */
+            { 18, { 0x20, 0x00, 0x04, 0x0e, 0x10, 0x00, 0x00, 0x02, 0x00, 0x00 } },  /* A down */
+            { 18, { 0x20, 0x00, 0x05, 0x0e, 0x10, 0x00, 0x00, 0x03, 0x00, 0x00 } },
+            { 18, { 0x20, 0x00, 0x06, 0x0e, 0x10, 0x00, 0x00, 0x04, 0x00, 0x00 } },
+        },
+        3, { 1, 2, 5 }
+    },
+#endif
+};
+
+static void
+check_stream(const RecordedStream *stream)
+{
+    HIDAPI_ReportQueue queue;
+    Uint8 data[HIDAPI_REPORT_MAX_SIZE];
+    Uint64 timestamp;
+    int i, size, taken = 0;
+
+    SDL_Log("test: replaying %s", stream->name);
+
+    if (HIDAPI_InitReportQueue(&queue) < 0) {
+        SDL_Log("couldn't create the report queue: %s", SDL_GetError());
+        exit(2);
+    }
+
+    /* The joystick wasn't updated while these came in */
+    for (i = 0; i < stream->num_reports; ++i) {
+        HIDAPI_Report *report = HIDAPI_GetFreeReport(&queue);
+        report->size = stream->reports[i].size;
+        report->timestamp = i;
+        SDL_memcpy(report->data, stream->reports[i].data, report->size);
+        HIDAPI_QueueReport(&queue);
+    }
+
+    while ((size = HIDAPI_TakeReport(&queue, stream->is_superseded, data, sizeof(data), &timestamp)) > 0) {
+        if (taken == stream->num_expected || timestamp != (Uint64)stream->expected[taken]) {
+            SDL_Log("%s: got report %d, expected report %d", stream->name, (int)timestamp,
+                    taken < stream->num_expected ? stream->expected[taken] : -1);
+            exit(2);
+        }
+        if (size != stream->reports[timestamp].size ||
+            SDL_memcmp(data, stream->reports[timestamp].data, size) != 0) {
+            SDL_Log("%s: report %d was changed in the queue", stream->name, (int)timestamp);
+            exit(2);
+        }
+        ++taken;
+    }
+    if (taken != stream->num_expected) {
+        SDL_Log("%s: got %d reports, expected %d", stream->name, taken, stream->num_expected);
+        exit(2);
+    }
+
+    /* Without a driver check, every report is kept */
+    for (i = 0; i < stream->num_reports; ++i) {
+        HIDAPI_Report *report = HIDAPI_GetFreeReport(&queue);
+        report->size = stream->reports[i].size;
+        report->timestamp = i;
+        SDL_memcpy(report->data, stream->reports[i].data, report->size);
+        HIDAPI_QueueReport(&queue);
+    }
+    for (i = 0; i < stream->num_reports; ++i) {
+        if (HIDAPI_TakeReport(&queue, NULL, data, sizeof(data), &timestamp) == 0 || timestamp != (Uint64)i) {
+            SDL_Log("%s: report %d was skipped without a driver check", stream->name, i);
+            exit(2);
+        }
+    }
+
+    HIDAPI_QuitReportQueue(&queue);
+}
+
+#define NUM_THREADED_REPORTS    (HIDAPI_REPORT_QUEUE_SIZE * 64)
+
+static int SDLCALL
+reader_thread(void *data)
+{
+    HIDAPI_ReportQueue *queue = (HIDAPI_ReportQueue *)data;
+    int i;
+
+    for (i = 0; i < NUM_THREADED_REPORTS; ) {
+        HIDAPI_Report *report = HIDAPI_GetFreeReport(queue);
+        if (!report) {
+            HIDAPI_WaitForFreeReport(queue);
+            continue;
+        }
+        report->size = 1;
+        report->data[0] = (Uint8)i;
+        report->timestamp = i;
+        HIDAPI_QueueReport(queue);
+        ++i;
+    }
+    return 0;
+}
+
+static void
+check_full_queue(void)
+{
+    HIDAPI_ReportQueue queue;
+    SDL_Thread *thread;
+    Uint8 data[HIDAPI_REPORT_MAX_SIZE];
+    Uint64 timestamp;
+    int i;
+
+    SDL_Log("test: full queue");
+
+    if (HIDAPI_InitReportQueue(&queue) < 0) {
+        SDL_Log("couldn't create the report queue: %s", SDL_GetError());
+        exit(2);
+    }
+
+    for (i = 0; i < HIDAPI_REPORT_QUEUE_SIZE; ++i) {
+        HIDAPI_Report *report = HIDAPI_GetFreeReport(&queue);
+        if (!report) {
+            SDL_Log("queue was full after %d reports", i);
+            exit(2);
+        }
+        report->size = 1;
+        HIDAPI_QueueReport(&queue);
+    }
+    if (HIDAPI_GetFreeReport(&queue)) {
+        SDL_Log("queue wasn't full after %d reports", i);
+        exit(2);
+    }
+    HIDAPI_TakeReport(&queue, NULL, data, sizeof(data), NULL);
+    if (!HIDAPI_GetFreeReport(&queue)) {
+        SDL_Log("queue was still full after taking a report");
+        exit(2);
+    }
+    while (HIDAPI_TakeReport(&queue, NULL, data, sizeof(data), NULL) > 0) {
+        continue;
+    }
+
+    /* The reader sleeps while the queue is full and nothing is lost */
+    thread = SDL_CreateThread(reader_thread, "HIDAPIReader", &queue);
+    if (!thread) {
+        SDL_Log("couldn't create the reader thread: %s", SDL_GetError());
+        exit(2);
+    }
+    for (i = 0; i < NUM_THREADED_REPORTS; ) {
+        if (HIDAPI_TakeReport(&queue, NULL, data, sizeof(data), &timestamp) == 0) {
+            SDL_Delay(1);
+            continue;
+        }
+        if (timestamp != (Uint64)i || data[0] != (Uint8)i) {
+            SDL_Log("got report %d, expected report %d", (int)timestamp, i);
+            exit(2);
+        }
+        ++i;
+    }
+    SDL_WaitThread(thread, NULL);
+
+    HIDAPI_QuitReportQueue(&queue);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i;
+
+    for (i = 0; i < SDL_arraysize(streams); ++i) {
+        check_stream(&streams[i]);
+    }
+    check_full_queue();
+
+    SDL_Log("all tests passed");
+    return 0;
+}
+
+#endif /* SDL_JOYSTICK_HIDAPI */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -25,6 +25,27 @@ widelen(char *data)
     return len;
 }
 
+/* Convert into a buffer, returning the number of bytes written or -1 */
+static int
+convert(const char *tocode, const char *fromcode, const char *inbuf, size_t inbytesleft, char *outbuf, size_t outsize)
+{
+    SDL_iconv_t cd;
+    size_t outbytesleft = outsize;
+    size_t result;
+
+    cd = SDL_iconv_open(tocode, fromcode);
+    if (cd == (SDL_iconv_t) - 1) {
+        return -1;
+    }
+    result = SDL_iconv(cd, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+    SDL_iconv_close(cd);
+    if (result == SDL_ICONV_ERROR || result == SDL_ICONV_E2BIG ||
+        result == SDL_ICONV_EILSEQ || result == SDL_ICONV_EINVAL) {
+        return -1;
+    }
+    return (int)(outsize - outbytesleft);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -43,7 +64,10 @@ main(int argc, char *argv[])
         "UCS-4",
     };
     char buffer[BUFSIZ];
+    char converted[BUFSIZ * 4];
+    int converted_len;
     char *ucs4;
+    char *utf8;
     char *test[2];
     int i;
     FILE *file;
@@ -78,10 +102,23 @@ main(int argc, char *argv[])
             SDL_free(test[0]);
             SDL_free(test[1]);
         }
-        test[0] = SDL_iconv_string("UTF-8", "UCS-4", ucs4, len);
+        utf8 = SDL_iconv_string("UTF-8", "UCS-4", ucs4, len);
         SDL_free(ucs4);
-        fputs(test[0], stdout);
-        SDL_free(test[0]);
+        /* Round trip the UTF-8 text directly, without going through UCS-4 */
+        for (i = 0; i < SDL_arraysize(formats); ++i) {
+            converted_len = convert(formats[i], "UTF-8", utf8, SDL_strlen(utf8) + 1, converted, sizeof(converted));
+            test[1] = NULL;
+            if (converted_len >= 0) {
+                test[1] = SDL_iconv_string("UTF-8", formats[i], converted, converted_len);
+            }
+            if (!test[1] || SDL_strcmp(test[1], utf8) != 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FAIL: UTF-8 <-> %s\n", formats[i]);
+                ++errors;
+            }
+            SDL_free(test[1]);
+        }
+        fputs(utf8, stdout);
+        SDL_free(utf8);
     }
     fclose(file);
     return (errors ? errors + 1 : 0);
@@ -10,6 +10,8 @@
   freely.
 */
 
+#include <stdlib.h>
+
 #include "SDL_test.h"
 
 static int
@@ -20,27 +22,85 @@ num_compare(const void *_a, const void *_b)
     return (a < b) ? -1 : ((a > b) ? 1 : 0);
 }
 
+static int
+num_compare_r(void *userdata, const void *_a, const void *_b)
+{
+    ++*((int *) userdata);
+    return num_compare(_a, _b);
+}
+
 static void
-test_sort(const char *desc, int *nums, const int arraylen)
+check_sorted(const int *nums, const int arraylen)
 {
     int i;
     int prev;
 
-    SDL_Log("test: %s arraylen=%d", desc, arraylen);
-
-    SDL_qsort(nums, arraylen, sizeof (nums[0]), num_compare);
-
     prev = nums[0];
     for (i = 1; i < arraylen; i++) {
         const int val = nums[i];
         if (val < prev) {
             SDL_Log("sort is broken!");
-            return;
+            exit(2);
         }
         prev = val;
     }
 }
 
+static void
+test_sort(const char *desc, int *nums, const int arraylen)
+{
+    static int copy[1024 * 100];
+    int comparisons = 0;
+
+    SDL_Log("test: %s arraylen=%d", desc, arraylen);
+
+    SDL_memcpy(copy, nums, arraylen * sizeof (nums[0]));
+
+    SDL_qsort(nums, arraylen, sizeof (nums[0]), num_compare);
+    check_sorted(nums, arraylen);
+
+    SDL_qsort_r(copy, arraylen, sizeof (copy[0]), num_compare_r, &comparisons);
+    check_sorted(copy, arraylen);
+    if (comparisons == 0 && arraylen > 1) {
+        SDL_Log("sort didn't pass userdata!");
+        exit(2);
+    }
+}
+
+static void
+test_throughput(int *nums, const int arraylen, SDLTest_RandomContext *rndctx)
+{
+    const int iterations = 20;
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    Uint64 qsort_ticks = 0, qsort_r_ticks = 0;
+    int comparisons = 0;
+    int i, j;
+
+    for (j = 0; j < iterations; j++) {
+        Uint64 start;
+
+        for (i = 0; i < arraylen; i++) {
+            nums[i] = SDLTest_RandomInt(rndctx);
+        }
+        start = SDL_GetPerformanceCounter();
+        SDL_qsort(nums, arraylen, sizeof (nums[0]), num_compare);
+        qsort_ticks += SDL_GetPerformanceCounter() - start;
+
+        for (i = 0; i < arraylen; i++) {
+            nums[i] = SDLTest_RandomInt(rndctx);
+        }
+        start = SDL_GetPerformanceCounter();
+        SDL_qsort_r(nums, arraylen, sizeof (nums[0]), num_compare_r, &comparisons);
+        qsort_r_ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    SDL_Log("throughput: arraylen=%d, SDL_qsort %.2f Melem/s, SDL_qsort_r %.2f Melem/s, %.1f comparisons/elem",
+            arraylen,
+            (arraylen * (double) iterations) / (qsort_ticks / freq) / 1000000.0,
+            (arraylen * (double) iterations) / (qsort_r_ticks / freq) / 1000000.0,
+            comparisons / ((double) arraylen * iterations));
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -48,6 +108,13 @@ main(int argc, char *argv[])
     static const int itervals[] = { SDL_arraysize(nums), 12 };
     int iteration;
     SDLTest_RandomContext rndctx;
+    SDL_bool throughput = SDL_FALSE;
+
+    if (argc > 1 && SDL_strcmp(argv[1], "--throughput") == 0) {
+        throughput = SDL_TRUE;
+        --argc;
+        ++argv;
+    }
 
     if (argc > 1)
     {
@@ -75,6 +142,12 @@ main(int argc, char *argv[])
     }
     SDL_Log("Using random seed 0x%08x%08x\n", rndctx.x, rndctx.c);
 
+    if (throughput) {
+        test_throughput(nums, SDL_arraysize(nums), &rndctx);
+        test_throughput(nums, 1000, &rndctx);
+        return 0;
+    }
+
     for (iteration = 0; iteration < SDL_arraysize(itervals); iteration++) {
         const int arraylen = itervals[iteration];
         int i;